@@ -40,13 +40,38 @@
 //
 // 20221123 Created
 // 20221223 Added support for ATC1441 format
+// 20261017 Replaced linear address matching by hash index
+// 20261017 Table driven, allocation free decoder (MiThDecoder)
+// 20261017 Added continuous (streaming) scan mode
+// 20261017 Added seqlock protected snapshot of readings for other tasks
+// 20261017 Sensors and readings are kept in a fixed capacity SensorTable
+// 20261017 Decode frame counter
 //
 // ToDo: 
 // -
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+// NimBLE is not available in the native test environment, which builds only the other sources of this library
+#if defined(ARDUINO)
+
 #include <ATC_MiThermometer.h>
+#include "MiThDecoder.h"
+
+// Compile time check of the decoder against captured advertisements (service data only)
+static constexpr uint8_t FrameCustom[] = {0x30, 0x35, 0x17, 0x38, 0xc1, 0xa4, 0xbc, 0x07, 0xa8, 0x16, 0x71, 0x0b, 0x50, 0x2e, 0x04};
+static constexpr uint8_t FrameATC1441[] = {0xa4, 0xc1, 0x38, 0x17, 0x35, 0x30, 0x00, 0xc6, 0x3a, 0x50, 0x0b, 0x71, 0x2e};
+static_assert(miThTemperature(*miThFindLayout(sizeof(FrameCustom)), FrameCustom) == 1980, "custom: temperature");
+static_assert(miThHumidity(*miThFindLayout(sizeof(FrameCustom)), FrameCustom) == 5800, "custom: humidity");
+static_assert(miThBattVoltage(*miThFindLayout(sizeof(FrameCustom)), FrameCustom) == 2929, "custom: battery voltage");
+static_assert(miThBattLevel(*miThFindLayout(sizeof(FrameCustom)), FrameCustom) == 80, "custom: battery level");
+static_assert(miThCounter(*miThFindLayout(sizeof(FrameCustom)), FrameCustom) == 0x2e, "custom: counter");
+static_assert(miThTemperature(*miThFindLayout(sizeof(FrameATC1441)), FrameATC1441) == 1980, "ATC1441: temperature");
+static_assert(miThHumidity(*miThFindLayout(sizeof(FrameATC1441)), FrameATC1441) == 5800, "ATC1441: humidity");
+static_assert(miThBattVoltage(*miThFindLayout(sizeof(FrameATC1441)), FrameATC1441) == 2929, "ATC1441: battery voltage");
+static_assert(miThBattLevel(*miThFindLayout(sizeof(FrameATC1441)), FrameATC1441) == 80, "ATC1441: battery level");
+static_assert(miThCounter(*miThFindLayout(sizeof(FrameATC1441)), FrameATC1441) == 0x2e, "ATC1441: counter");
+static_assert(miThFindLayout(14) == nullptr, "unknown format");
 
 
 /*!
@@ -55,8 +80,16 @@
  * \brief Callback for advertised device found during scan
  */
 class MyAdvertisedDeviceCallbacks: public BLEAdvertisedDeviceCallbacks {
+public:
+  MyAdvertisedDeviceCallbacks(ATC_MiThermometer *owner) : _owner(owner) {}
+
   void onResult(BLEAdvertisedDevice* advertisedDevice) {
     log_d("Advertised Device: %s", advertisedDevice->toString().c_str());
+    if (_owner->_streaming) {
+      // Decode right here (NimBLE host task) and hand the reading over to the consumer
+      _owner->onAdvertisement(advertisedDevice);
+      return;
+    }
     /*
      * Here we add the device scanned to the whitelist based on service data but any
      * advertised data can be used for your preffered data.
@@ -69,6 +102,9 @@ class MyAdvertisedDeviceCallbacks: public BLEAdvertisedDeviceCallbacks {
       }
     }
   }
+
+private:
+  ATC_MiThermometer *_owner;
 };
 
 
@@ -77,7 +113,7 @@ void ATC_MiThermometer::begin(void)
 {
     NimBLEDevice::init("");
     _pBLEScan = BLEDevice::getScan(); //create new scan
-    _pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks());
+    _pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks(this));
     _pBLEScan->setActiveScan(false); //active scan uses more power, but get results faster
     _pBLEScan->setInterval(100);
     _pBLEScan->setFilterPolicy(BLE_HCI_SCAN_FILT_NO_WL);
@@ -95,79 +131,106 @@ unsigned ATC_MiThermometer::getData(uint32_t duration) {
     }
   
     log_d("Assigning scan results...");
-    for (unsigned i=0; i<foundDevices.getCount(); i++) {
-        
-        // Match all devices found against list of known sensors
-        for (unsigned n = 0; n < _known_sensors.size(); n++) {
-            log_d("Found: %s  comparing to: %s", 
-                  foundDevices.getDevice(i).getAddress().toString().c_str(), 
-                  BLEAddress(_known_sensors[n]).toString().c_str());
-            if (foundDevices.getDevice(i).getAddress() == BLEAddress(_known_sensors[n])) {
-                log_d(" -> Match! Index: %d", n);
-                data[n].valid = true;
-                
-                int len = foundDevices.getDevice(i).getServiceData().length();
-                log_d("Length of ServiceData: %d", len);
-                
-                if (len == 15) {
-                    log_d("Custom format");
-                    // Temperature
-                    int temp_msb = foundDevices.getDevice(i).getServiceData().c_str()[7];
-                    int temp_lsb = foundDevices.getDevice(i).getServiceData().c_str()[6];
-                    data[n].temperature = (temp_msb << 8) | temp_lsb;
-
-                    // Humidity
-                    int hum_msb = foundDevices.getDevice(i).getServiceData().c_str()[9];
-                    int hum_lsb = foundDevices.getDevice(i).getServiceData().c_str()[8];
-                    data[n].humidity = (hum_msb << 8) | hum_lsb;
-
-                    // Battery voltage
-                    int volt_msb = foundDevices.getDevice(i).getServiceData().c_str()[11];
-                    int volt_lsb = foundDevices.getDevice(i).getServiceData().c_str()[10];
-                    data[n].batt_voltage = (volt_msb << 8) | volt_lsb;
-
-                    // Battery state [%]
-                    data[n].batt_level = foundDevices.getDevice(i).getServiceData().c_str()[12];         
-                }
-                else if (len == 13) {
-                    log_d("ATC1441 format");
-                    
-                    // Temperature
-                    int temp_lsb = foundDevices.getDevice(i).getServiceData().c_str()[7];
-                    int temp_msb = foundDevices.getDevice(i).getServiceData().c_str()[6];
-                    data[n].temperature  = (temp_msb << 8) | temp_lsb;
-                    data[n].temperature *= 10;
-
-                    // Humidity
-                    data[n].humidity  = foundDevices.getDevice(i).getServiceData().c_str()[8];
-                    data[n].humidity *= 100;
-
-                    // Battery voltage
-                    int volt_lsb = foundDevices.getDevice(i).getServiceData().c_str()[11];
-                    int volt_msb = foundDevices.getDevice(i).getServiceData().c_str()[10];
-                    data[n].batt_voltage = (volt_msb << 8) | volt_lsb;
-
-                    // Battery state [%]
-                    data[n].batt_level = foundDevices.getDevice(i).getServiceData().c_str()[9];
-                } else {
-                    log_d("Unknown ServiceData format");
-                }
-                
-                // Received Signal Strength Indicator [dBm]
-                data[n].rssi = foundDevices.getDevice(i).getRSSI();
-            } else {
-                log_d();
-            }
+    for (auto it = foundDevices.begin(); it != foundDevices.end(); ++it) {
+        NimBLEAdvertisedDevice *device = *it;
+
+        // Look up device in the index of known sensors
+        int n = _sensors.find(uint64_t(device->getAddress()));
+        if (n < 0) {
+            continue;
+        }
+        log_d("Found: %s -> Match! Index: %d", device->getAddress().toString().c_str(), n);
+
+        MiThData_t &data = _sensors.data(n);
+        if (decodeAdvertisement(device, data)) {
+            data.valid = true;
+            data.timestamp = time(nullptr);
+            _sensors.publish(n);
         }
     }
     return foundDevices.getCount();
 }
 
-        
+
+// Start continuous scan, readings are delivered through the queue
+void ATC_MiThermometer::startStreaming(void)
+{
+    _streaming = true;
+    // Report every advertisement, not only the first one per device
+    _pBLEScan->setDuplicateFilter(false);
+    // Do not keep scan results, the callback consumes each advertisement
+    _pBLEScan->setMaxResults(0);
+    _pBLEScan->start(0 /* forever */, nullptr, false /* is_continue */);
+}
+
+
+// Move readings received by the scan callback into data
+unsigned ATC_MiThermometer::update(void)
+{
+    // Restart scan if it was stopped, e.g. by a BLE host reset
+    if (_streaming && !_pBLEScan->isScanning()) {
+        log_w("BLE scan stopped, restarting");
+        _pBLEScan->start(0, nullptr, false);
+    }
+
+    unsigned count = 0;
+    MiThReading_t reading;
+    while (_queue.pop(reading)) {
+        MiThData_t &data = _sensors.data(reading.index);
+        data = reading.data;
+        data.valid = true;
+        data.timestamp = time(nullptr);
+        _sensors.publish(reading.index);
+        count++;
+    }
+    return count;
+}
+
+
+// Called from the NimBLE host task for each advertisement while streaming
+void ATC_MiThermometer::onAdvertisement(NimBLEAdvertisedDevice *device)
+{
+    int n = _sensors.find(uint64_t(device->getAddress()));
+    if (n < 0) {
+        return;
+    }
+    MiThReading_t reading = {};
+    reading.index = n;
+    if (!decodeAdvertisement(device, reading.data)) {
+        return;
+    }
+    if (!_queue.push(reading)) {
+        _dropped++;
+    }
+}
+
+
+// Decode service data in place, without copying the advertisement
+bool ATC_MiThermometer::decodeAdvertisement(NimBLEAdvertisedDevice *device, MiThData_t &reading)
+{
+    const uint8_t *sd;
+    size_t len;
+    if (!miThFindServiceData(device->getPayload(), device->getPayloadLength(), &sd, &len)) {
+        log_d("No ServiceData");
+        return false;
+    }
+    log_d("Length of ServiceData: %d", len);
+    if (!miThDecode(sd, len, reading)) {
+        log_d("Unknown ServiceData format");
+        return false;
+    }
+    // Received Signal Strength Indicator [dBm]
+    reading.rssi = device->getRSSI();
+    return true;
+}
+
+
 // Set all array members invalid
 void ATC_MiThermometer::resetData(void)
 {
-    for (int i=0; i < _known_sensors.size(); i++) {
-        data[i].valid = false;
+    for (size_t i=0; i < _sensors.size(); i++) {
+        _sensors.data(i).valid = false;
     }
-}
\ No newline at end of file
+}
+
+#endif
@@ -50,20 +50,22 @@
 
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include "MiThData.h"
+#include "SensorTable.h"
+#include "SpscQueue.h"
 
-// MiThermometer data struct / type
-struct MiThData_S
+#define ATC_MITHERMOMETER_QUEUE_SIZE 32 //!< Readings buffered between scan callback and update()
+
+// Decoded advertisement of sensor at index
+struct MiThReading_S
 {
-    bool valid;            //!< data valid
-    int16_t temperature;   //!< temperature x 100°C
-    uint16_t humidity;     //!< humidity x 100%
-    uint16_t batt_voltage; //!< battery voltage [mv]
-    uint8_t batt_level;    //!< battery level   [%]
-    int16_t rssi;          //!< RSSI [dBm]
-    uint64_t timestamp;
+    uint16_t index;        //!< sensor index
+    MiThData_t data;       //!< sensor data
 };
 
-typedef struct MiThData_S MiThData_t; //!< Shortcut for struct MiThData_S
+typedef struct MiThReading_S MiThReading_t; //!< Shortcut for struct MiThReading_S
+
+class MyAdvertisedDeviceCallbacks;
 
 /*!
   \class ATC_MiThermometer
@@ -72,16 +74,16 @@ typedef struct MiThData_S MiThData_t; //!< Shortcut for struct MiThData_S
 */
 class ATC_MiThermometer
 {
+    friend class MyAdvertisedDeviceCallbacks;
+
 public:
     /*!
     \brief Constructor.
 
-    \param known_sensors    Vector of BLE MAC addresses of known sensors, e.g. {"11:22:33:44:55:66", "AA:BB:CC:DD:EE:FF"}
+    \param sensors  Table of known sensors, receives the readings
     */
-    ATC_MiThermometer(std::vector<std::string> known_sensors)
+    ATC_MiThermometer(SensorTableBase &sensors) : _sensors(sensors)
     {
-        _known_sensors = known_sensors;
-        data.resize(known_sensors.size());
     };
 
     /*!
@@ -105,17 +107,41 @@ public:
     unsigned getData(uint32_t duration);
 
     /*!
-    \brief Set sensor data invalid.
+    \brief Start continuous BLE scan.
+
+    Advertisements are decoded as they arrive and queued until the next update().
+    getData() must not be used in this mode.
     */
-    void resetData(void);
+    void startStreaming(void);
+
+    /*!
+    \brief Apply readings received since the last call to the sensor table (streaming mode).
+
+    \return number of readings applied
+    */
+    unsigned update(void);
 
     /*!
-    \brief Sensor data.
+    \brief Number of readings lost because the queue was full (streaming mode).
     */
-    std::vector<MiThData_t> data;
+    uint32_t getDropped(void) const
+    {
+        return _dropped;
+    };
+
+    /*!
+    \brief Set sensor data invalid.
+    */
+    void resetData(void);
 
 protected:
-    std::vector<std::string> _known_sensors;
+    void onAdvertisement(NimBLEAdvertisedDevice *device);
+    bool decodeAdvertisement(NimBLEAdvertisedDevice *device, MiThData_t &reading);
+
+    SensorTableBase &_sensors;
     NimBLEScan *_pBLEScan;
+    bool _streaming = false;
+    SpscQueue<MiThReading_t, ATC_MITHERMOMETER_QUEUE_SIZE> _queue;
+    volatile uint32_t _dropped = 0;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ChangeFilter.cpp
+//
+// Suppress readings that do not carry new information before they are uploaded.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ChangeFilter.h"
+
+static bool outside(int32_t value, int32_t last, int32_t deadband)
+{
+    return value - last > deadband || last - value > deadband;
+}
+
+
+bool ChangeFilterBase::shouldSend(size_t index, const MiThData_t &data)
+{
+    const MiThData_t &last = _last[index];
+    bool changed = !last.valid;
+
+    if (!changed && _config.max_silence && data.timestamp - last.timestamp >= _config.max_silence) {
+        changed = true;
+    }
+    // Same counter: the sensor repeats the advertisement of a measurement already seen
+    if (!changed && data.counter != last.counter) {
+        changed = outside(data.temperature, last.temperature, _config.temperature)
+            || outside(data.humidity, last.humidity, _config.humidity)
+            || outside(data.batt_voltage, last.batt_voltage, _config.batt_voltage)
+            || outside(data.batt_level, last.batt_level, _config.batt_level);
+    }
+
+    if (!changed) {
+        _suppressed++;
+    }
+    return changed;
+}
+
+
+void ChangeFilterBase::commit(size_t index, const MiThData_t &data)
+{
+    MiThData_t &last = _last[index];
+    last = data;
+    last.valid = true;
+    _passed++;
+}
+
+
+void ChangeFilterBase::reset(void)
+{
+    for (size_t i = 0; i < _capacity; i++) {
+        _last[i].valid = false;
+    }
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ChangeFilter.h
+//
+// Suppress readings that do not carry new information before they are uploaded.
+//
+// A reading passes if
+// - it is the first one of the sensor, or
+// - the frame counter has changed (new measurement) and at least one field has moved out of
+//   its deadband around the last committed reading, or
+// - the last committed reading is older than the maximum silence (heartbeat).
+//
+// RSSI is not compared, it changes with nearly every advertisement.
+// The 8-bit frame counter wraps, so the maximum silence should be shorter than 256 measurement
+// intervals of the sensor (about 40 minutes with the default 10 s interval).
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ChangeFilter_h
+#define ChangeFilter_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MiThData.h"
+
+/*!
+  \class ChangeFilterBase
+
+  \brief Capacity independent part of ChangeFilter
+*/
+class ChangeFilterBase
+{
+public:
+    //! Deadbands and heartbeat; a field passes if it changes by more than its deadband
+    struct Config
+    {
+        uint16_t temperature;   //!< x 100°C
+        uint16_t humidity;      //!< x 100%
+        uint16_t batt_voltage;  //!< [mV]
+        uint8_t batt_level;     //!< [%]
+        uint32_t max_silence;   //!< [s] pass a reading at least this often, 0 = never
+    };
+
+    /*!
+    \brief Set deadbands and heartbeat.
+    */
+    void setConfig(const Config &config)
+    {
+        _config = config;
+    };
+
+    /*!
+    \brief Check reading against the last committed one.
+
+    A reading that should be uploaded is remembered only by commit(), so a reading that could
+    not be queued does not move the baseline.
+
+    \param index    sensor index
+    \param data     valid reading with timestamp
+
+    \return true if the reading should be uploaded
+    */
+    bool shouldSend(size_t index, const MiThData_t &data);
+
+    /*!
+    \brief Remember reading as uploaded, call after it has been queued.
+
+    \param index    sensor index
+    \param data     reading checked by shouldSend()
+    */
+    void commit(size_t index, const MiThData_t &data);
+
+    /*!
+    \brief Forget last committed reading of all sensors, so the next ones pass.
+    */
+    void reset(void);
+
+    /*!
+    \brief Number of readings committed so far.
+    */
+    uint32_t getPassed(void) const
+    {
+        return _passed;
+    };
+
+    /*!
+    \brief Number of readings suppressed so far.
+    */
+    uint32_t getSuppressed(void) const
+    {
+        return _suppressed;
+    };
+
+protected:
+    ChangeFilterBase(MiThData_t *last, size_t capacity, const Config &config)
+        : _last(last), _capacity(capacity), _config(config)
+    {
+    };
+
+    MiThData_t *_last;          //!< last committed reading per sensor, valid = seen
+    size_t _capacity;
+    Config _config;
+    uint32_t _passed = 0;
+    uint32_t _suppressed = 0;
+};
+
+/*!
+  \class ChangeFilter
+
+  \brief Change filter for up to N sensors
+
+  \tparam N   maximum number of sensors (SensorTable capacity)
+*/
+template <size_t N>
+class ChangeFilter : public ChangeFilterBase
+{
+public:
+    ChangeFilter(const Config &config) : ChangeFilterBase(_lastStorage, N, config)
+    {
+    };
+
+private:
+    MiThData_t _lastStorage[N] = {};
+};
+#endif
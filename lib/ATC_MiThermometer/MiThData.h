@@ -0,0 +1,30 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MiThData.h
+//
+// Sensor reading of a BLE ATC_MiThermometer thermometer/hygrometer.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MiThData_h
+#define MiThData_h
+
+#include <stdint.h>
+
+// MiThermometer data struct / type
+struct MiThData_S
+{
+    bool valid;            //!< data valid
+    int16_t temperature;   //!< temperature x 100°C
+    uint16_t humidity;     //!< humidity x 100%
+    uint16_t batt_voltage; //!< battery voltage [mv]
+    uint8_t batt_level;    //!< battery level   [%]
+    int16_t rssi;          //!< RSSI [dBm]
+    uint8_t counter;       //!< frame counter, changes with each new measurement
+    uint64_t timestamp;
+};
+
+typedef struct MiThData_S MiThData_t; //!< Shortcut for struct MiThData_S
+
+#endif
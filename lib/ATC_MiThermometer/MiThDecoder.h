@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MiThDecoder.h
+//
+// Allocation free decoder for ATC_MiThermometer BLE advertisements.
+//
+// Supported service data (UUID 0x181A) formats:
+// - pvvx custom format, 15 bytes (see https://github.com/pvvx/ATC_MiThermometer#custom-format-all-data-little-endian)
+// - ATC1441 format,     13 bytes (see https://github.com/atc1441/ATC_MiThermometer#advertising-format-of-the-custom-firmware)
+//
+// The formats are described by a layout table, so decoding is a single pass over a byte span.
+// All field accessors are constexpr and can be checked at compile time with static_assert.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MiThDecoder_h
+#define MiThDecoder_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "MiThData.h"
+
+/*!
+  \brief Byte layout of a service data format
+*/
+struct MiThLayout
+{
+    uint8_t length;        //!< service data length
+    uint8_t temp_offset;   //!< int16 temperature
+    bool temp_big_endian;
+    uint8_t temp_scale;    //!< factor to 0.01°C
+    uint8_t hum_offset;    //!< humidity, 1 or 2 bytes little endian
+    uint8_t hum_size;
+    uint8_t hum_scale;     //!< factor to 0.01%
+    uint8_t volt_offset;   //!< uint16 battery voltage [mV]
+    bool volt_big_endian;
+    uint8_t batt_offset;   //!< uint8 battery level [%]
+    uint8_t count_offset;  //!< uint8 frame counter, changes with each new measurement
+};
+
+static constexpr MiThLayout MiThLayouts[] = {
+    // len, temp,     scale, hum,    scale, volt,      batt, count
+    {15,    6, false, 1,     8, 2,   1,     10, false, 12,   13},  // pvvx custom
+    {13,    6, true,  10,    8, 1,   100,   10, true,  9,    12},  // ATC1441
+};
+
+static constexpr size_t MiThLayoutCount = sizeof(MiThLayouts) / sizeof(MiThLayouts[0]);
+
+/*!
+\brief Find layout by service data length.
+
+\return pointer to layout or nullptr if the format is unknown
+*/
+constexpr const MiThLayout *miThFindLayout(size_t len, size_t i = 0)
+{
+    return (i == MiThLayoutCount) ? nullptr
+         : (MiThLayouts[i].length == len) ? &MiThLayouts[i]
+         : miThFindLayout(len, i + 1);
+}
+
+constexpr uint16_t miThReadU16(const uint8_t *p, bool big_endian)
+{
+    return big_endian ? (uint16_t)((p[0] << 8) | p[1]) : (uint16_t)((p[1] << 8) | p[0]);
+}
+
+//! Temperature x 100°C
+constexpr int16_t miThTemperature(const MiThLayout &l, const uint8_t *sd)
+{
+    return (int16_t)((int16_t)miThReadU16(sd + l.temp_offset, l.temp_big_endian) * l.temp_scale);
+}
+
+//! Humidity x 100%
+constexpr uint16_t miThHumidity(const MiThLayout &l, const uint8_t *sd)
+{
+    return (uint16_t)(((l.hum_size == 2) ? miThReadU16(sd + l.hum_offset, false) : sd[l.hum_offset]) * l.hum_scale);
+}
+
+//! Battery voltage [mV]
+constexpr uint16_t miThBattVoltage(const MiThLayout &l, const uint8_t *sd)
+{
+    return miThReadU16(sd + l.volt_offset, l.volt_big_endian);
+}
+
+//! Battery level [%]
+constexpr uint8_t miThBattLevel(const MiThLayout &l, const uint8_t *sd)
+{
+    return sd[l.batt_offset];
+}
+
+//! Frame counter
+constexpr uint8_t miThCounter(const MiThLayout &l, const uint8_t *sd)
+{
+    return sd[l.count_offset];
+}
+
+/*!
+\brief Decode service data into sensor reading.
+
+Only the measurement fields of \p data are modified; rssi and timestamp are left untouched.
+
+\param sd       service data (without UUID)
+\param len      service data length
+
+\return true if the format is known and \p data has been updated
+*/
+inline bool miThDecode(const uint8_t *sd, size_t len, MiThData_t &data)
+{
+    const MiThLayout *l = miThFindLayout(len);
+    if (!l)
+        return false;
+    data.temperature = miThTemperature(*l, sd);
+    data.humidity = miThHumidity(*l, sd);
+    data.batt_voltage = miThBattVoltage(*l, sd);
+    data.batt_level = miThBattLevel(*l, sd);
+    data.counter = miThCounter(*l, sd);
+    return true;
+}
+
+/*!
+\brief Locate environmental sensing (UUID 0x181A) service data in a raw advertisement payload.
+
+\param payload  advertisement payload (AD structures)
+\param len      payload length
+\param sd       [out] start of service data, pointing into \p payload
+\param sd_len   [out] service data length
+
+\return true if found
+*/
+inline bool miThFindServiceData(const uint8_t *payload, size_t len, const uint8_t **sd, size_t *sd_len)
+{
+    size_t i = 0;
+    while (i + 1 < len) {
+        size_t ad_len = payload[i];
+        if (ad_len == 0 || i + 1 + ad_len > len)
+            break;
+        // AD type 0x16: service data - 16 bit UUID, UUID is little endian
+        if (payload[i + 1] == 0x16 && ad_len >= 3 && payload[i + 2] == 0x1A && payload[i + 3] == 0x18) {
+            *sd = payload + i + 4;
+            *sd_len = ad_len - 3;
+            return true;
+        }
+        i += 1 + ad_len;
+    }
+    return false;
+}
+#endif
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorHistory.cpp
+//
+// Per-sensor circular history of temperature and humidity in a fixed arena.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SensorHistory.h"
+
+// Scale x 100 value to x 10, rounding half away from zero
+static int32_t toTenths(int32_t value)
+{
+    return (value >= 0 ? value + 5 : value - 5) / 10;
+}
+
+static int32_t clamp(int32_t value, int32_t min, int32_t max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+
+void SensorHistoryBase::append(size_t index, uint32_t timestamp, int16_t temperature, uint16_t humidity)
+{
+    Encoded *samples = _samples + index * _depth;
+    Last &last = _last[index];
+    Head head;
+    _heads[index].read(head);
+
+    int32_t t = toTenths(temperature);
+    int32_t h = toTenths(humidity);
+    if (head.next == head.first) {
+        // First sample becomes the base, it is stored with zero deltas
+        head.timestamp = last.timestamp = timestamp;
+        head.temperature = last.temperature = t;
+        head.humidity = last.humidity = h;
+    }
+
+    // Encode relative to the reconstructed previous value, so clamping errors are carried over
+    Encoded e;
+    e.dt = (uint16_t)clamp(timestamp >= last.timestamp ? timestamp - last.timestamp : 0, 0, UINT16_MAX);
+    e.temperature = (int8_t)clamp(t - last.temperature, INT8_MIN, INT8_MAX);
+    e.humidity = (int8_t)clamp(h - last.humidity, INT8_MIN, INT8_MAX);
+    last.timestamp += e.dt;
+    last.temperature += e.temperature;
+    last.humidity += e.humidity;
+
+    if (head.next - head.first == _depth) {
+        // Ring is full: fold the oldest sample into the base and publish that
+        // before its slot is overwritten
+        const Encoded &oldest = samples[head.first % _depth];
+        head.timestamp += oldest.dt;
+        head.temperature += oldest.temperature;
+        head.humidity += oldest.humidity;
+        head.first++;
+        _heads[index].write(head);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Write the sample before it becomes visible through head.next
+    samples[head.next % _depth] = e;
+    head.next++;
+    _heads[index].write(head);
+}
+
+
+void SensorHistoryBase::begin(size_t index, Cursor &cursor) const
+{
+    Head head;
+    _heads[index].read(head);
+    cursor.seq = head.first;
+    cursor.end = head.next;
+    cursor.timestamp = head.timestamp;
+    cursor.temperature = head.temperature;
+    cursor.humidity = head.humidity;
+}
+
+
+bool SensorHistoryBase::next(size_t index, Cursor &cursor, Sample &sample) const
+{
+    if (cursor.seq == cursor.end) {
+        return false;
+    }
+    Encoded e = _samples[index * _depth + cursor.seq % _depth];
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // Give up if the sample has been overwritten while we were reading
+    Head head;
+    _heads[index].read(head);
+    if ((int32_t)(cursor.seq - head.first) < 0) {
+        return false;
+    }
+
+    cursor.seq++;
+    cursor.timestamp += e.dt;
+    cursor.temperature += e.temperature;
+    cursor.humidity += e.humidity;
+    sample.timestamp = cursor.timestamp;
+    sample.temperature = (int16_t)(cursor.temperature * 10);
+    sample.humidity = (uint16_t)(cursor.humidity * 10);
+    return true;
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorHistory.h
+//
+// Per-sensor circular history of temperature and humidity in a fixed arena.
+//
+// Each sample takes 4 bytes: time since the previous sample [s] and the temperature and
+// humidity change [0.1°C, 0.1%] since the previous sample. Changes beyond the int8 range are
+// clamped and the remainder is carried over to the next sample, so the reconstructed series
+// catches up instead of drifting. Values of the sample preceding the oldest one are kept as
+// base; when the oldest sample is overwritten, its deltas are folded into the base.
+//
+// One task appends, any task may read. Readers walk the history with a cursor and detect
+// samples overwritten in the meantime.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SensorHistory_h
+#define SensorHistory_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "SeqLock.h"
+
+/*!
+  \class SensorHistoryBase
+
+  \brief Capacity independent part of SensorHistory
+*/
+class SensorHistoryBase
+{
+public:
+    //! Decoded sample
+    struct Sample
+    {
+        uint32_t timestamp;    //!< [s] since epoch
+        int16_t temperature;   //!< temperature x 100°C
+        uint16_t humidity;     //!< humidity x 100%
+    };
+
+    //! Read position, see begin() and next()
+    struct Cursor
+    {
+        uint32_t seq;          //!< sequence number of next sample
+        uint32_t end;          //!< sequence number after the newest sample at begin()
+        uint32_t timestamp;    //!< reconstructed values of the previous sample
+        int32_t temperature;
+        int32_t humidity;
+    };
+
+    /*!
+    \brief Append sample (writer only).
+
+    \param index        sensor index
+    \param timestamp    [s] since epoch
+    \param temperature  temperature x 100°C
+    \param humidity     humidity x 100%
+    */
+    void append(size_t index, uint32_t timestamp, int16_t temperature, uint16_t humidity);
+
+    /*!
+    \brief Time of the newest sample, 0 if there is none (writer only).
+    */
+    uint32_t lastTime(size_t index) const
+    {
+        return _last[index].timestamp;
+    };
+
+    /*!
+    \brief Position cursor at the oldest sample of sensor at index.
+    */
+    void begin(size_t index, Cursor &cursor) const;
+
+    /*!
+    \brief Read sample at cursor and advance.
+
+    \return false at the end of the history, or if the writer has overwritten the sample
+    */
+    bool next(size_t index, Cursor &cursor, Sample &sample) const;
+
+    /*!
+    \brief Maximum number of samples per sensor.
+    */
+    size_t depth(void) const
+    {
+        return _depth;
+    };
+
+protected:
+    //! Encoded sample, 4 bytes
+    struct Encoded
+    {
+        uint16_t dt;           //!< [s] since previous sample, saturated
+        int8_t temperature;    //!< change [0.1°C]
+        int8_t humidity;       //!< change [0.1%]
+    };
+
+    //! Published state of one sensor's ring
+    struct Head
+    {
+        uint32_t first;        //!< sequence number of the oldest sample
+        uint32_t next;         //!< sequence number of the next sample to write
+        uint32_t timestamp;    //!< base: values before the oldest sample
+        int32_t temperature;
+        int32_t humidity;
+    };
+
+    //! Writer state: reconstructed values of the newest sample
+    struct Last
+    {
+        uint32_t timestamp;
+        int32_t temperature;
+        int32_t humidity;
+    };
+
+    SensorHistoryBase(Encoded *samples, SeqLock<Head> *heads, Last *last, size_t depth)
+        : _samples(samples), _heads(heads), _last(last), _depth(depth)
+    {
+    };
+
+    Encoded *_samples;
+    SeqLock<Head> *_heads;
+    Last *_last;
+    size_t _depth;
+};
+
+/*!
+  \class SensorHistory
+
+  \brief History storage for N sensors with DEPTH samples each
+
+  \tparam N       maximum number of sensors (SensorTable capacity)
+  \tparam DEPTH   samples per sensor
+*/
+template <size_t N, size_t DEPTH>
+class SensorHistory : public SensorHistoryBase
+{
+    static_assert(DEPTH > 1, "SensorHistory depth too small");
+
+public:
+    SensorHistory() : SensorHistoryBase(&_sampleStorage[0][0], _headStorage, _lastStorage, DEPTH)
+    {
+    };
+
+private:
+    Encoded _sampleStorage[N][DEPTH];
+    SeqLock<Head> _headStorage[N];
+    Last _lastStorage[N] = {};
+};
+#endif
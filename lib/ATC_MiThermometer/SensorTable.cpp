@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorTable.cpp
+//
+// Fixed capacity table of known sensors and their readings.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Arduino.h>
+#include "SensorTable.h"
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+
+uint64_t SensorTableBase::parseMac(const char *mac)
+{
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++) {
+        int hi = hexValue(mac[0]);
+        int lo = (hi < 0) ? -1 : hexValue(mac[1]);
+        if (lo < 0)
+            return 0;
+        key = (key << 8) | (uint64_t)((hi << 4) | lo);
+        mac += 2;
+        if (i < 5) {
+            if (*mac != ':')
+                return 0;
+            mac++;
+        }
+    }
+    return (*mac == '\0') ? key : 0;
+}
+
+
+char *SensorTableBase::formatMac(uint64_t key, char *buf)
+{
+    static const char hex[] = "0123456789abcdef";
+    char *p = buf;
+    for (int shift = 40; shift >= 0; shift -= 8) {
+        uint8_t b = (uint8_t)(key >> shift);
+        *p++ = hex[b >> 4];
+        *p++ = hex[b & 0x0f];
+        *p++ = shift ? ':' : '\0';
+    }
+    return buf;
+}
+
+
+int SensorTableBase::add(const char *mac)
+{
+    uint64_t key = parseMac(mac);
+    if (key == 0) {
+        log_e("Invalid sensor address: %s", mac);
+        return -1;
+    }
+    if (find(key) >= 0) {
+        log_w("Duplicate sensor address: %s", mac);
+        return -1;
+    }
+    if (_count == _capacity) {
+        log_e("Sensor table full, cannot add %s", mac);
+        return -1;
+    }
+    int n = _count++;
+    _macs[n] = key;
+    uint32_t i = hash(key) & _slotMask;
+    while (_slots[i] >= 0)
+        i = (i + 1) & _slotMask;
+    _slots[i] = (int16_t)n;
+    return n;
+}
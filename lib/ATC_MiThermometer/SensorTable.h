@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorTable.h
+//
+// Fixed capacity table of known sensors and their readings.
+//
+// The table lives in static storage and is shared by the BLE scanner, the web server and the
+// InfluxDB writer. Data is kept as a struct of arrays:
+// - packed 48-bit MAC addresses, indexed by an open-addressed hash table for O(1) lookup
+// - working copy of the readings, owned by the BLE side
+// - seqlock protected published copy of the readings, for all other tasks
+//
+// Nothing is allocated on the heap, so the table does not fragment memory over long uptimes.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SensorTable_h
+#define SensorTable_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <initializer_list>
+#include "MiThData.h"
+#include "SeqLock.h"
+
+/*!
+  \class SensorTableBase
+
+  \brief Capacity independent part of SensorTable, used by ATC_MiThermometer and consumers
+*/
+class SensorTableBase
+{
+public:
+    /*!
+    \brief Add sensor.
+
+    \param mac  BLE MAC address, e.g. "a4:c1:38:17:35:30"
+
+    \return sensor index or -1 if the address is invalid, already known or the table is full
+    */
+    int add(const char *mac);
+
+    /*!
+    \brief Find sensor index by packed MAC address.
+
+    \param key      MAC address as 48-bit integer, most significant byte first
+                    (same as NimBLEAddress::operator uint64_t())
+
+    \return sensor index or -1 if unknown
+    */
+    int find(uint64_t key) const
+    {
+        for (uint32_t i = hash(key) & _slotMask;; i = (i + 1) & _slotMask) {
+            int16_t slot = _slots[i];
+            if (slot < 0)
+                return -1;
+            if (_macs[slot] == key)
+                return slot;
+        }
+    };
+
+    /*!
+    \brief Number of sensors.
+    */
+    size_t size(void) const
+    {
+        return _count;
+    };
+
+    /*!
+    \brief Packed MAC address of sensor at index.
+    */
+    uint64_t mac(size_t index) const
+    {
+        return _macs[index];
+    };
+
+    /*!
+    \brief MAC address of sensor at index as string.
+
+    \param buf  buffer of at least 18 chars
+
+    \return buf
+    */
+    char *macString(size_t index, char *buf) const
+    {
+        return formatMac(_macs[index], buf);
+    };
+
+    /*!
+    \brief Working copy of the reading, owned by the BLE side (see ATC_MiThermometer).
+    */
+    MiThData_t &data(size_t index)
+    {
+        return _data[index];
+    };
+
+    /*!
+    \brief Make working copy of the reading visible to getSnapshot().
+    */
+    void publish(size_t index)
+    {
+        _published[index].write(_data[index]);
+        _version.fetch_add(1, std::memory_order_release);
+    };
+
+    /*!
+    \brief Get consistent copy of the latest published reading.
+
+    Safe to call from any task (e.g. the web server) while the BLE side is updating.
+
+    \param index    sensor index
+    \param reading  [out] sensor data
+    */
+    void getSnapshot(size_t index, MiThData_t &reading) const
+    {
+        _published[index].read(reading);
+    };
+
+    /*!
+    \brief Version of the published readings, changes whenever a reading is published.
+    */
+    uint32_t getVersion(void) const
+    {
+        return _version.load(std::memory_order_acquire);
+    };
+
+    /*!
+    \brief Parse MAC address string "aa:bb:cc:dd:ee:ff" (case insensitive) to a packed key.
+
+    \return packed key or 0 if the string is not a valid MAC address
+    */
+    static uint64_t parseMac(const char *mac);
+
+    /*!
+    \brief Format packed key as lower case MAC address string.
+
+    \param buf  buffer of at least 18 chars
+
+    \return buf
+    */
+    static char *formatMac(uint64_t key, char *buf);
+
+protected:
+    SensorTableBase(uint64_t *macs, MiThData_t *data, SeqLock<MiThData_t> *published, size_t capacity,
+                    int16_t *slots, size_t slotCount)
+        : _macs(macs), _data(data), _published(published), _capacity(capacity), _slots(slots),
+          _slotMask(slotCount - 1)
+    {
+        for (size_t i = 0; i < slotCount; i++)
+            _slots[i] = -1;
+    };
+
+    static uint32_t hash(uint64_t key)
+    {
+        // Fibonacci hashing, upper bits have the best distribution
+        return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 40);
+    };
+
+    uint64_t *_macs;
+    MiThData_t *_data;
+    SeqLock<MiThData_t> *_published;
+    size_t _capacity;
+    size_t _count = 0;
+    int16_t *_slots;            //!< hash table of sensor indices, -1 = empty
+    uint32_t _slotMask;
+    std::atomic<uint32_t> _version{0};
+};
+
+/*!
+  \class SensorTable
+
+  \brief Sensor table with static storage for up to N sensors
+
+  \tparam N   maximum number of sensors
+*/
+template <size_t N>
+class SensorTable : public SensorTableBase
+{
+    static_assert(N > 0 && N < 0x7fff, "SensorTable capacity out of range");
+
+public:
+    /*!
+    \brief Constructor.
+
+    \param known_sensors    BLE MAC addresses of known sensors, e.g. {"11:22:33:44:55:66", "AA:BB:CC:DD:EE:FF"}
+    */
+    SensorTable(std::initializer_list<const char *> known_sensors)
+        : SensorTableBase(_macStorage, _dataStorage, _publishedStorage, N, _slotStorage, SlotCount)
+    {
+        for (const char *mac : known_sensors)
+            add(mac);
+    };
+
+private:
+    // Keep load factor <= 0.5 so that probe sequences stay short
+    static constexpr size_t slotCount(size_t n)
+    {
+        return n >= 2 * N ? n : slotCount(2 * n);
+    };
+    static constexpr size_t SlotCount = slotCount(4);
+
+    uint64_t _macStorage[N];
+    MiThData_t _dataStorage[N] = {};
+    SeqLock<MiThData_t> _publishedStorage[N];
+    int16_t _slotStorage[SlotCount];
+};
+#endif
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SeqLock.h
+//
+// Single writer sequence lock.
+//
+// The writer never blocks. Readers copy the value and retry if a write was in progress,
+// so they always get a consistent (untorn) copy.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SeqLock_h
+#define SeqLock_h
+
+#include <Arduino.h>
+#include <atomic>
+
+/*!
+  \class SeqLock
+
+  \brief Value protected by a sequence counter, one writer task and any number of reader tasks
+
+  \tparam T   value type, must be trivially copyable
+*/
+template <typename T>
+class SeqLock
+{
+public:
+    /*!
+    \brief Publish new value (writer only).
+    */
+    void write(const T &value)
+    {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _value = value;
+        _seq.store(seq + 2, std::memory_order_release);
+    };
+
+    /*!
+    \brief Single read attempt.
+
+    \return false if a write was in progress, \p value is undefined then
+    */
+    bool tryRead(T &value) const
+    {
+        uint32_t seq = _seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            return false;
+        value = _value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _seq.load(std::memory_order_relaxed) == seq;
+    };
+
+    /*!
+    \brief Read consistent copy, retrying until no write interferes.
+    */
+    void read(T &value) const
+    {
+        for (unsigned attempt = 1; !tryRead(value); attempt++) {
+            // The writer may be preempted by a higher priority reader on the same core,
+            // give it a chance to finish.
+            if ((attempt & 7) == 0)
+                delay(1);
+        }
+    };
+
+    /*!
+    \brief Number of writes so far.
+    */
+    uint32_t version(void) const
+    {
+        return _seq.load(std::memory_order_acquire) >> 1;
+    };
+
+private:
+    std::atomic<uint32_t> _seq{0};
+    T _value{};
+};
+#endif
@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SpscQueue.h
+//
+// Bounded lock-free single producer / single consumer queue.
+//
+// Used to hand decoded advertisements from the NimBLE host task to the Arduino loop task
+// without locks and without heap allocation.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SpscQueue_h
+#define SpscQueue_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/*!
+  \class SpscQueue
+
+  \brief Fixed capacity ring buffer, one producer task and one consumer task
+
+  \tparam T   element type, must be trivially copyable
+  \tparam N   capacity, power of two
+*/
+template <typename T, size_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    /*!
+    \brief Append item (producer only).
+
+    \return false if the queue is full
+    */
+    bool push(const T &item)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == N)
+            return false;
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    };
+
+    /*!
+    \brief Remove oldest item (consumer only).
+
+    \return false if the queue is empty
+    */
+    bool pop(T &item)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        item = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    };
+
+    /*!
+    \brief Number of queued items (approximate while the other side is running).
+    */
+    size_t size(void) const
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    };
+
+private:
+    T _items[N];
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _tail{0};
+};
+#endif
@@ -0,0 +1,120 @@
+/**
+ *
+ * AdaptiveFlushPolicy.cpp: Adaptive batch size for InfluxDB Client for Arduino
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "AdaptiveFlushPolicy.h"
+
+// Moving averages use weight 1/4 of a new sample
+static uint32_t average(uint32_t avg, uint32_t sample) {
+    return avg ? avg - avg / 4 + sample / 4 : sample;
+}
+
+void AdaptiveFlushPolicy::setLimits(uint16_t maxBatchSize, uint16_t maxStaleness) {
+    if(!maxBatchSize) {
+        maxBatchSize = 1;
+    }
+    if(maxBatchSize == _maxBatchSize && maxStaleness == _maxStaleness) {
+        return;
+    }
+    _maxBatchSize = maxBatchSize;
+    _maxStaleness = maxStaleness;
+    // learned size is kept within new limits
+    if(_batchSize > _maxBatchSize) {
+        _batchSize = _maxBatchSize;
+    }
+    limit();
+}
+
+void AdaptiveFlushPolicy::onRecord(uint32_t now, uint32_t freeHeap) {
+    if(_hasRecord) {
+        _interval = average(_interval, now - _lastRecord);
+    }
+    _lastRecord = now;
+    _hasRecord = true;
+    // shrink once per write, low memory would otherwise drop batch size to 1 at once
+    if(freeHeap < _config.minFreeHeap && !_memoryShrunk) {
+        _memoryShrunk = true;
+        shrink(Decision::ShrinkMemory);
+    }
+    limit();
+}
+
+void AdaptiveFlushPolicy::onWrite(uint32_t latency, bool success, uint32_t freeHeap) {
+    _memoryShrunk = false;
+    if(!success) {
+        shrink(Decision::ShrinkFailure);
+        return;
+    }
+    _latency = average(_latency, latency);
+    if(freeHeap < _config.minFreeHeap) {
+        shrink(Decision::ShrinkMemory);
+    } else if(_latency >= _config.growLatency && _batchSize < _maxBatchSize) {
+        _batchSize++;
+        _grows++;
+        _decision = Decision::Grow;
+    } else {
+        _decision = Decision::Hold;
+    }
+    limit();
+}
+
+void AdaptiveFlushPolicy::shrink(Decision reason) {
+    if(_batchSize > 1) {
+        _batchSize /= 2;
+        _shrinks++;
+    }
+    _decision = reason;
+}
+
+void AdaptiveFlushPolicy::limit() {
+    if(!_maxStaleness || !_interval) {
+        return;
+    }
+    // points arriving within staleness bound
+    uint32_t reachable = (uint32_t)_maxStaleness * 1000 / _interval;
+    if(reachable < 1) {
+        reachable = 1;
+    }
+    if(_batchSize > reachable) {
+        _batchSize = reachable;
+        _shrinks++;
+        _decision = Decision::LimitStaleness;
+    }
+}
+
+const char *AdaptiveFlushPolicy::decisionToString(Decision decision) {
+    switch(decision) {
+        case Decision::Grow:
+            return "grow";
+        case Decision::Hold:
+            return "hold";
+        case Decision::ShrinkFailure:
+            return "shrink_failure";
+        case Decision::ShrinkMemory:
+            return "shrink_memory";
+        case Decision::LimitStaleness:
+            return "limit_staleness";
+        default:
+            return "none";
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ *
+ * AdaptiveFlushPolicy.h: Adaptive batch size for InfluxDB Client for Arduino
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _ADAPTIVE_FLUSH_POLICY_H_
+#define _ADAPTIVE_FLUSH_POLICY_H_
+
+#include <stdint.h>
+
+/**
+ * AdaptiveFlushPolicy chooses how many points are collected before a batch is written, between 1 and
+ * the batch size from write options:
+ *  - batch grows by one point after a successful write which took long, e.g. because of TLS handshake,
+ *    so the fixed cost of a request is shared by more points (additive increase)
+ *  - batch halves after a failed write or when free heap is low (multiplicative decrease)
+ *  - batch is limited to the number of points that arrive within the flush interval, so points
+ *    do not wait longer than that
+ * It only holds state; times and measurements are passed in, so it can be driven by a simulated clock.
+ */
+class AdaptiveFlushPolicy {
+  public:
+    struct Config {
+        // Write latency [ms] above which batch grows
+        uint16_t growLatency = 250;
+        // Free heap [bytes] below which batch shrinks
+        uint32_t minFreeHeap = 24000;
+    };
+    // Last change of batch size and its reason
+    enum class Decision : uint8_t {
+        None = 0,
+        Grow,
+        Hold,
+        ShrinkFailure,
+        ShrinkMemory,
+        LimitStaleness
+    };
+    AdaptiveFlushPolicy() {}
+    void setConfig(const Config &config) { _config = config; }
+    // Sets maximum batch size and maximum time [s] a point waits for write, 0 for no limit.
+    // Batch size starts at 1; when limits change, it is kept if it is within them.
+    void setLimits(uint16_t maxBatchSize, uint16_t maxStaleness);
+    // Called when a point is added to write buffer. now - time [ms]
+    void onRecord(uint32_t now, uint32_t freeHeap);
+    // Called after a batch was sent. latency - request duration [ms]
+    void onWrite(uint32_t latency, bool success, uint32_t freeHeap);
+    // Returns number of points to collect before writing
+    uint16_t getBatchSize() const { return _batchSize; }
+    Decision getLastDecision() const { return _decision; }
+    // Returns average write latency [ms]
+    uint32_t getLatency() const { return _latency; }
+    // Returns average time between points [ms]
+    uint32_t getInterval() const { return _interval; }
+    // Returns number of batch size increases and decreases
+    uint32_t getGrows() const { return _grows; }
+    uint32_t getShrinks() const { return _shrinks; }
+    static const char *decisionToString(Decision decision);
+  private:
+    Config _config;
+    uint16_t _maxBatchSize = 1;
+    uint16_t _maxStaleness = 0;
+    uint16_t _batchSize = 1;
+    Decision _decision = Decision::None;
+    // Exponential moving averages, 0 until first sample
+    uint32_t _latency = 0;
+    uint32_t _interval = 0;
+    uint32_t _lastRecord = 0;
+    bool _hasRecord = false;
+    // Batch size was reduced because of memory since last write
+    bool _memoryShrunk = false;
+    uint32_t _grows = 0;
+    uint32_t _shrinks = 0;
+  private:
+    void shrink(Decision reason);
+    // Applies staleness limit
+    void limit();
+};
+
+#endif //_ADAPTIVE_FLUSH_POLICY_H_
@@ -0,0 +1,140 @@
+/**
+ *
+ * ArduinoHTTPTransport.cpp: HTTP transport using HTTPClient of ESP8266 and ESP32 core
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#if defined(ESP8266) || defined(ESP32)
+#include "ArduinoHTTPTransport.h"
+
+#include "util/debug.h"
+
+#if defined(ESP8266)         
+bool checkMFLN(BearSSL::WiFiClientSecure  *client, String url);
+#endif
+
+ArduinoHTTPTransport::ArduinoHTTPTransport(const String &serverUrl, const char *certInfo, bool insecure) {
+  bool https = serverUrl.startsWith("https");
+  if(https) {
+#if defined(ESP8266)         
+    BearSSL::WiFiClientSecure *wifiClientSec = new BearSSL::WiFiClientSecure;
+    if (insecure) {
+      wifiClientSec->setInsecure();
+    } else if(certInfo && strlen_P(certInfo) > 0) {
+      if(strlen_P(certInfo) > 60 ) { //differentiate fingerprint and cert
+         _cert = new BearSSL::X509List(certInfo); 
+         wifiClientSec->setTrustAnchors(_cert);
+      } else {
+         wifiClientSec->setFingerprint(certInfo);
+      }
+    }
+    checkMFLN(wifiClientSec, serverUrl);
+    // Resume TLS session on reconnect, saves the certificate verification and key exchange of full handshake
+    wifiClientSec->setSession(&_session);
+#elif defined(ESP32)
+    WiFiClientSecure *wifiClientSec = new WiFiClientSecure;  
+    if (insecure) {
+#ifndef ARDUINO_ESP32_RELEASE_1_0_4
+      // This works only in ESP32 SDK 1.0.5 and higher
+      wifiClientSec->setInsecure();
+#endif            
+    } else if(certInfo && strlen_P(certInfo) > 0) { 
+      wifiClientSec->setCACert(certInfo);
+    }
+#endif    
+    _wifiClient = wifiClientSec;
+  } else {
+    _wifiClient = new WiFiClient;
+  }
+  _httpClient = new HTTPClient;
+}
+
+ArduinoHTTPTransport::~ArduinoHTTPTransport() {
+  delete _httpClient;
+  delete _wifiClient;
+#if defined(ESP8266)     
+  if(_cert) {
+    delete _cert;
+    _cert = nullptr;
+  }
+#endif
+}
+
+void ArduinoHTTPTransport::setOptions(bool reuse, int timeout) {
+  _httpClient->setReuse(reuse);
+  _httpClient->setTimeout(timeout);
+#if defined(ESP32) 
+  _httpClient->setConnectTimeout(timeout);
+#endif
+}
+
+void ArduinoHTTPTransport::stop() {
+  _wifiClient->stop();
+  _httpClient->end();
+}
+
+// parse URL for host and port and call probeMaxFragmentLength
+#if defined(ESP8266)         
+bool checkMFLN(BearSSL::WiFiClientSecure  *client, String url) {
+    int index = url.indexOf(':');
+     if(index < 0) {
+        return false;
+    }
+    String protocol = url.substring(0, index);
+    int port = -1;
+    url.remove(0, (index + 3)); // remove http:// or https://
+
+    if (protocol == "http") {
+        // set default port for 'http'
+        port = 80;
+    } else if (protocol == "https") {
+        // set default port for 'https'
+        port = 443;
+    } else {
+        return false;
+    }
+    index = url.indexOf('/');
+    String host = url.substring(0, index);
+    url.remove(0, index); // remove host 
+    // check Authorization
+    index = host.indexOf('@');
+    if(index >= 0) {
+        host.remove(0, index + 1); // remove auth part including @
+    }
+    // get port
+    index = host.indexOf(':');
+    if(index >= 0) {
+        String portS = host;
+        host = host.substring(0, index); // hostname
+        portS.remove(0, (index + 1)); // remove hostname + :
+        port = portS.toInt(); // get port
+    }
+    INFLUXDB_CLIENT_DEBUG("[D] probeMaxFragmentLength to %s:%d\n", host.c_str(), port);
+    bool mfln = client->probeMaxFragmentLength(host, port, 1024);
+    INFLUXDB_CLIENT_DEBUG("[D]  MFLN:%s\n", mfln ? "yes" : "no");
+    if (mfln) {
+        client->setBufferSizes(1024, 1024);
+    } 
+    return mfln;
+}
+#endif //ESP8266
+
+#endif //ESP8266 || ESP32
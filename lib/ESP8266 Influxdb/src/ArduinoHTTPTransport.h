@@ -0,0 +1,81 @@
+/**
+ *
+ * ArduinoHTTPTransport.h: HTTP transport using HTTPClient of ESP8266 and ESP32 core
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _ARDUINO_HTTP_TRANSPORT_H_
+#define _ARDUINO_HTTP_TRANSPORT_H_
+
+#include "HTTPTransport.h"
+#if defined(ESP8266)
+# include <WiFiClientSecureBearSSL.h>
+# include <ESP8266HTTPClient.h>
+#elif defined(ESP32)
+# include <HTTPClient.h>
+#else
+# error "This library currently supports only ESP8266 and ESP32."
+#endif
+
+class Test;
+
+/**
+ * ArduinoHTTPTransport sends requests via HTTPClient over WiFiClient, or WiFiClientSecure for https.
+ **/
+class ArduinoHTTPTransport : public HTTPTransport {
+friend class Test;
+  private:
+    HTTPClient *_httpClient;
+    // Underlying connection object 
+    WiFiClient *_wifiClient;
+#ifdef  ESP8266
+    // Trusted cert chain
+    BearSSL::X509List *_cert = nullptr;   
+    // TLS session parameters, reused to resume session when connecting again
+    BearSSL::Session _session;
+#endif
+  public:
+    // serverUrl - url of the server, https uses secured connection
+    // certInfo - server trusted certificate (or CA certificate) or certificate SHA1 fingerprint. Should be stored in PROGMEM.
+    // insecure - skip certificate validation
+    ArduinoHTTPTransport(const String &serverUrl, const char *certInfo, bool insecure);
+    virtual ~ArduinoHTTPTransport();
+    virtual void setOptions(bool reuse, int timeout) override;
+    virtual void setUserAgent(const String &userAgent) override { _httpClient->setUserAgent(userAgent); }
+    virtual bool begin(const String &url) override { return _httpClient->begin(*_wifiClient, url); }
+    // HTTPClient appends the header to its String of request headers, built again for every request
+    virtual void addHeader(const String &name, const String &value) override { _httpClient->addHeader(name, value); }
+    virtual void collectHeaders(const char *keys[], size_t count) override { _httpClient->collectHeaders(keys, count); }
+    using HTTPTransport::sendRequest;
+    virtual int sendRequest(const char *method, const uint8_t *data, size_t length) override { return _httpClient->sendRequest(method, (uint8_t *)data, length); }
+    virtual int sendRequest(const char *method, Stream *stream, size_t length) override { return _httpClient->sendRequest(method, stream, length); }
+    virtual bool hasHeader(const char *name) override { return _httpClient->hasHeader(name); }
+    virtual String header(const char *name) override { return _httpClient->header(name); }
+    virtual int getSize() override { return _httpClient->getSize(); }
+    virtual String getString() override { return _httpClient->getString(); }
+    virtual int writeToStream(Stream *stream) override { return _httpClient->writeToStream(stream); }
+    virtual Stream *getStreamPtr() override { return _httpClient->getStreamPtr(); }
+    virtual bool connected() override { return _httpClient->connected(); }
+    virtual void end() override { _httpClient->end(); }
+    virtual void stop() override;
+};
+
+#endif //_ARDUINO_HTTP_TRANSPORT_H_
@@ -0,0 +1,210 @@
+/**
+ *
+ * AsyncWriter.cpp: Writes records to InfluxDB from a dedicated task
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "AsyncWriter.h"
+
+#if !defined(ESP8266)
+
+#include "util/debug.h"
+
+AsyncWriter::AsyncWriter(InfluxDBClient &client, size_t queueSize, size_t eventQueueSize):
+  _client(client),_queue(queueSize),_events(eventQueueSize),_running(false),_stopping(false),_rejected(0),_eventsLost(0) {
+}
+
+AsyncWriter::~AsyncWriter() {
+  end();
+}
+
+bool AsyncWriter::begin(uint32_t stackSize, uint8_t priority, int core) {
+  if(_running) {
+    return true;
+  }
+  _stopping = false;
+  _lastStats = _client.getWriteStats();
+  // initial state, sender task is not running yet
+  if(_statusCallback) {
+    _statusCallback(_client);
+  }
+  _running = true;
+#if defined(ESP_PLATFORM)
+  if(xTaskCreateUniversal(taskFunction, "influxdb_writer", stackSize, this, priority, &_task, core < 0 ? tskNO_AFFINITY : core) != pdPASS) {
+    INFLUXDB_CLIENT_DEBUG("[E] Cannot create writer task\n");
+    _running = false;
+    return false;
+  }
+#else
+  // task parameters apply to FreeRTOS only
+  (void)stackSize;
+  (void)priority;
+  (void)core;
+  _thread = std::thread(taskFunction, this);
+#endif
+  return true;
+}
+
+void AsyncWriter::end() {
+  if(!_running) {
+    return;
+  }
+  _stopping = true;
+  notify();
+#if defined(ESP_PLATFORM)
+  while(_running) {
+    delay(10);
+  }
+  _task = nullptr;
+#else
+  _thread.join();
+#endif
+}
+
+bool AsyncWriter::write(const char *record, size_t length) {
+  if(!_running || _stopping || !_queue.push(record, length)) {
+    _rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  notify();
+  return true;
+}
+
+bool AsyncWriter::pollEvent(WriteEvent &event) {
+  size_t length;
+  const uint8_t *data = _events.front(length);
+  if(!data) {
+    return false;
+  }
+  memcpy(&event, data, sizeof(event));
+  _events.pop();
+  return true;
+}
+
+void AsyncWriter::taskFunction(void *writer) {
+  static_cast<AsyncWriter *>(writer)->run();
+#if defined(ESP_PLATFORM)
+  vTaskDelete(nullptr);
+#endif
+}
+
+void AsyncWriter::run() {
+  while(!_stopping) {
+    wait();
+    drainQueue();
+    // flushes on flush interval and retries, even when there are no new records
+    _client.checkBuffer();
+    checkStats();
+  }
+  drainQueue();
+  _client.flushBuffer();
+  checkStats();
+  _running = false;
+}
+
+void AsyncWriter::drainQueue() {
+  size_t length;
+  const uint8_t *record;
+  while((record = _queue.front(length)) != nullptr) {
+    _client.writeRecord((const char *)record, length);
+    _queue.pop();
+    checkStats();
+  }
+}
+
+void AsyncWriter::checkStats() {
+  const WriteStats &stats = _client.getWriteStats();
+  int statusCode = _client.getLastStatusCode();
+  uint32_t failures = stats.failures - _lastStats.failures;
+  uint32_t posted = stats.batchesPosted - _lastStats.batchesPosted;
+  if(posted > failures) {
+    addEvent(WriteEvent::Type::Written, posted - failures, statusCode);
+  }
+  if(failures) {
+    addEvent(WriteEvent::Type::Failed, failures, statusCode);
+  }
+  if(stats.retries != _lastStats.retries) {
+    addEvent(WriteEvent::Type::Retrying, stats.retries - _lastStats.retries, statusCode);
+  }
+  if(stats.batchesStored != _lastStats.batchesStored) {
+    addEvent(WriteEvent::Type::Stored, stats.batchesStored - _lastStats.batchesStored, statusCode);
+  }
+  if(stats.pointsDropped != _lastStats.pointsDropped) {
+    addEvent(WriteEvent::Type::Dropped, stats.pointsDropped - _lastStats.pointsDropped, statusCode);
+  }
+  _lastStats = stats;
+  if(_statusCallback) {
+    _statusCallback(_client);
+  }
+}
+
+void AsyncWriter::addEvent(WriteEvent::Type type, uint32_t count, int statusCode) {
+  WriteEvent event;
+  event.type = type;
+  event.count = count > 0xFFFF ? 0xFFFF : count;
+  event.statusCode = statusCode;
+  event.time = millis();
+  if(!_events.push(&event, sizeof(event))) {
+    _eventsLost.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+#if defined(ESP_PLATFORM)
+void AsyncWriter::notify() {
+  if(_task) {
+    xTaskNotifyGive(_task);
+  }
+}
+
+void AsyncWriter::wait() {
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WaitMs));
+}
+#else
+void AsyncWriter::notify() {
+  std::lock_guard<std::mutex> lock(_wakeMutex);
+  _woken = true;
+  _wake.notify_one();
+}
+
+void AsyncWriter::wait() {
+  std::unique_lock<std::mutex> lock(_wakeMutex);
+  _wake.wait_for(lock, std::chrono::milliseconds(WaitMs), [this] { return _woken; });
+  _woken = false;
+}
+#endif
+
+const char *AsyncWriter::eventTypeToString(WriteEvent::Type type) {
+  switch(type) {
+    case WriteEvent::Type::Written:
+      return "written";
+    case WriteEvent::Type::Failed:
+      return "failed";
+    case WriteEvent::Type::Retrying:
+      return "retrying";
+    case WriteEvent::Type::Stored:
+      return "stored";
+    case WriteEvent::Type::Dropped:
+      return "dropped";
+  }
+  return "";
+}
+
+#endif //!ESP8266
@@ -0,0 +1,141 @@
+/**
+ *
+ * AsyncWriter.h: Writes records to InfluxDB from a dedicated task
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _ASYNC_WRITER_H_
+#define _ASYNC_WRITER_H_
+
+#if !defined(ESP8266)
+
+#include "InfluxDbClient.h"
+#include "util/RecordQueue.h"
+#include <functional>
+#if defined(ESP_PLATFORM)
+# include <freertos/FreeRTOS.h>
+# include <freertos/task.h>
+#else
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+#endif
+
+// Outcome of writes done by the sender task, see AsyncWriter::pollEvent()
+struct WriteEvent {
+    enum class Type : uint8_t {
+        // Batches written
+        Written,
+        // Write requests failed
+        Failed,
+        // Batches kept in buffer for retrying
+        Retrying,
+        // Batches moved to batch store
+        Stored,
+        // Points lost
+        Dropped
+    };
+    Type type;
+    // Number of batches, points for Dropped
+    uint16_t count;
+    // HTTP status code or HTTPC_ERROR_* code of the last write request
+    int16_t statusCode;
+    // millis() of the event
+    uint32_t time;
+};
+
+/**
+ * AsyncWriter moves writing off the caller's task. Records are copied to a lock-free queue and
+ * a sender task, which owns the InfluxDBClient, adds them to the write buffer and does the HTTP requests.
+ * So a slow TLS handshake or server never blocks the producer, it only fills the queue.
+ * When the queue is full, write() returns false and the record is not taken (backpressure).
+ * Outcome of the writes comes back as events, polled by the producer.
+ * There must be a single producer task. Once begin() is called, the client must not be used by other tasks
+ * until end() returns. Its counters can be copied for other tasks by a status callback, which runs in the sender task.
+ * Uses FreeRTOS task on ESP32, std::thread elsewhere (e.g. on host).
+ */
+class AsyncWriter {
+  public:
+    // Called with the client after it has been used, in the sender task
+    typedef std::function<void(const InfluxDBClient &client)> StatusCallback;
+    // client - configured client, used only by sender task while running
+    // queueSize - record queue size in bytes
+    // eventQueueSize - event queue size in bytes, an event takes 14 bytes
+    AsyncWriter(InfluxDBClient &client, size_t queueSize = 2048, size_t eventQueueSize = 256);
+    ~AsyncWriter();
+    // Starts sender task. core -1 means any core (ESP32 only)
+    bool begin(uint32_t stackSize = 8192, uint8_t priority = 1, int core = -1);
+    // Stops sender task after it has written queued records and flushed the write buffer
+    void end();
+    // Sets callback for publishing client state, e.g. through a seqlock. Must be set before begin()
+    void setStatusCallback(StatusCallback callback) { _statusCallback = callback; }
+    // Queues line protocol record. Returns false if the queue is full or task is not running
+    bool write(const char *record, size_t length);
+    bool write(const char *record) { return write(record, strlen(record)); }
+    // Takes oldest event. Returns false if there is none
+    bool pollEvent(WriteEvent &event);
+    bool isRunning() const { return _running.load(); }
+    // Returns bytes used by queued records
+    size_t getQueued() const { return _queue.used(); }
+    // Returns records not taken because the queue was full, may be called by any task
+    uint32_t getRejected() const { return _rejected.load(std::memory_order_relaxed); }
+    // Returns events lost because event queue was full, may be called by any task
+    uint32_t getEventsLost() const { return _eventsLost.load(std::memory_order_relaxed); }
+    static const char *eventTypeToString(WriteEvent::Type type);
+  private:
+    // Maximum wait of the sender task for records, it checks the write buffer at least this often
+    static const uint32_t WaitMs = 1000;
+    InfluxDBClient &_client;
+    RecordQueue _queue;
+    RecordQueue _events;
+    std::atomic<bool> _running;
+    std::atomic<bool> _stopping;
+    // Counted by producer and sender task, read by others
+    std::atomic<uint32_t> _rejected;
+    std::atomic<uint32_t> _eventsLost;
+    // Counters at last check, to derive events
+    WriteStats _lastStats;
+    StatusCallback _statusCallback;
+#if defined(ESP_PLATFORM)
+    TaskHandle_t _task = nullptr;
+#else
+    std::thread _thread;
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    bool _woken = false;
+#endif
+  private:
+    static void taskFunction(void *writer);
+    // Sender task body
+    void run();
+    // Wakes up sender task
+    void notify();
+    // Waits for notification, at most WaitMs
+    void wait();
+    // Passes queued records to the client
+    void drainQueue();
+    // Queues events for counters changed since last check
+    void checkStats();
+    void addEvent(WriteEvent::Type type, uint32_t count, int statusCode);
+};
+
+#endif //!ESP8266
+#endif //_ASYNC_WRITER_H_
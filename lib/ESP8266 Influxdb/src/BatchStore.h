@@ -0,0 +1,53 @@
+/**
+ *
+ * BatchStore.h: Persistent storage of unwritten batches for InfluxDB Client for Arduino
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _BATCH_STORE_H_
+#define _BATCH_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * BatchStore keeps batches that could not be written before they would be overwritten in the write buffer,
+ * e.g. during a network outage. Batches are returned in the order they were stored. See InfluxDBClient::setBatchStore.
+ * Data of a batch is lines of line protocol, each terminated by new line.
+ */
+class BatchStore {
+  public:
+    virtual ~BatchStore() {}
+    // Stores batch. count - number of lines
+    // Returns false if batch cannot be stored
+    virtual bool push(const char *data, size_t length, uint16_t count) = 0;
+    // Returns true if no batch is stored
+    virtual bool isEmpty() = 0;
+    // Returns data length of the oldest batch, 0 if empty
+    virtual size_t frontLength() = 0;
+    // Reads data of the oldest batch into buffer, which must have at least frontLength() bytes
+    // Returns false in case of read error
+    virtual bool readFront(char *buffer) = 0;
+    // Removes the oldest batch
+    virtual void pop() = 0;
+};
+
+#endif //_BATCH_STORE_H_
@@ -1,5 +1,8 @@
 
 #include "HTTPService.h"
+#if defined(ESP8266) || defined(ESP32)
+# include "ArduinoHTTPTransport.h"
+#endif
 #include "Platform.h"
 #include "Version.h"
 
@@ -7,193 +10,203 @@
 
 static const char UserAgent[] PROGMEM = "influxdb-client-arduino/" INFLUXDB_CLIENT_VERSION " (" INFLUXDB_CLIENT_PLATFORM " " INFLUXDB_CLIENT_PLATFORM_VERSION ")";
 
-#if defined(ESP8266)         
-bool checkMFLN(BearSSL::WiFiClientSecure  *client, String url);
-#endif
-
 // This cannot be put to PROGMEM due to the way how it is used
 static const char *RetryAfter = "Retry-After";
 const char *TransferEncoding = "Transfer-Encoding";
 
-HTTPService::HTTPService(ConnectionInfo *pConnInfo):_pConnInfo(pConnInfo) {
-  _apiURL = pConnInfo->serverUrl;
-  _apiURL += "/api/v2/";
-  bool https = pConnInfo->serverUrl.startsWith("https");
-  if(https) {
-#if defined(ESP8266)         
-    BearSSL::WiFiClientSecure *wifiClientSec = new BearSSL::WiFiClientSecure;
-    if (pConnInfo->insecure) {
-      wifiClientSec->setInsecure();
-    } else if(pConnInfo->certInfo && strlen_P(pConnInfo->certInfo) > 0) {
-      if(strlen_P(pConnInfo->certInfo) > 60 ) { //differentiate fingerprint and cert
-         _cert = new BearSSL::X509List(pConnInfo->certInfo); 
-         wifiClientSec->setTrustAnchors(_cert);
-      } else {
-         wifiClientSec->setFingerprint(pConnInfo->certInfo);
+// Header names are created once, as HTTPClient takes them as String
+static const String AuthorizationHeader(F("Authorization"));
+static const String ContentTypeHeader(F("Content-Type"));
+static const String ContentEncodingHeader(F("Content-Encoding"));
+
+/**
+ * Keeps the beginning of response body in a fixed buffer, the rest is counted and discarded.
+ */
+class ErrorBodySink : public Stream {
+  public:
+    ErrorBodySink(char *buffer, size_t size):_buffer(buffer),_size(size),_length(0) { _buffer[0] = 0; }
+    virtual size_t write(uint8_t data) override { return write(&data, 1); }
+    virtual size_t write(const uint8_t *data, size_t length) override {
+      size_t n = _size - 1 - _length;
+      if(n > length) {
+        n = length;
       }
+      memcpy(_buffer + _length, data, n);
+      _length += n;
+      _buffer[_length] = 0;
+      return length;
     }
-    checkMFLN(wifiClientSec, pConnInfo->serverUrl);
-#elif defined(ESP32)
-    WiFiClientSecure *wifiClientSec = new WiFiClientSecure;  
-    if (pConnInfo->insecure) {
-#ifndef ARDUINO_ESP32_RELEASE_1_0_4
-      // This works only in ESP32 SDK 1.0.5 and higher
-      wifiClientSec->setInsecure();
-#endif            
-    } else if(pConnInfo->certInfo && strlen_P(pConnInfo->certInfo) > 0) { 
-      wifiClientSec->setCACert(pConnInfo->certInfo);
-    }
-#endif    
-    _wifiClient = wifiClientSec;
-  } else {
-    _wifiClient = new WiFiClient;
+    virtual int available() override { return 0; }
+    virtual int read() override { return -1; }
+    virtual int peek() override { return -1; }
+    virtual void flush() override {}
+  private:
+    char *_buffer;
+    size_t _size;
+    size_t _length;
+};
+
+HTTPService::HTTPService(ConnectionInfo *pConnInfo, HTTPTransport *transport):_pConnInfo(pConnInfo),_transport(transport) {
+  _apiURL = pConnInfo->serverUrl;
+  _apiURL += "/api/v2/";
+#if defined(ESP8266) || defined(ESP32)
+  if(!_transport) {
+    _transport = new ArduinoHTTPTransport(pConnInfo->serverUrl, pConnInfo->certInfo, pConnInfo->insecure);
+    _ownsTransport = true;
   }
-  if(!_httpClient) {
-    _httpClient = new HTTPClient;
+#endif
+  _transport->setOptions(_pConnInfo->httpOptions._connectionReuse, _pConnInfo->httpOptions._httpReadTimeout);
+  _transport->setUserAgent(FPSTR(UserAgent));
+  // collected headers are kept by the transport for all requests
+  const char * headerKeys[] = {RetryAfter, TransferEncoding} ;
+  _transport->collectHeaders(headerKeys, 2);
+  if(pConnInfo->authToken.length() > 0) {
+    _authorization.reserve(6 + pConnInfo->authToken.length());
+    _authorization = F("Token ");
+    _authorization += pConnInfo->authToken;
   }
-  _httpClient->setReuse(_pConnInfo->httpOptions._connectionReuse);
-
-  _httpClient->setUserAgent(FPSTR(UserAgent));
 };
 
 HTTPService::~HTTPService() {
-  if(_httpClient) {
-    delete _httpClient;
-    _httpClient = nullptr;
-  }
-  if(_wifiClient) {
-    delete _wifiClient;
-    _wifiClient = nullptr;
+  if(_ownsTransport) {
+    delete _transport;
   }
-#if defined(ESP8266)     
-  if(_cert) {
-    delete _cert;
-    _cert = nullptr;
-}
-#endif
+  _transport = nullptr;
 }
 
 
 void HTTPService::setHTTPOptions() {
-  if(!_httpClient) {
-    _httpClient = new HTTPClient;
-  }
-  _httpClient->setReuse(_pConnInfo->httpOptions._connectionReuse);
-  _httpClient->setTimeout(_pConnInfo->httpOptions._httpReadTimeout);
-#if defined(ESP32) 
-  _httpClient->setConnectTimeout(_pConnInfo->httpOptions._httpReadTimeout);
-#endif
+  _transport->setOptions(_pConnInfo->httpOptions._connectionReuse, _pConnInfo->httpOptions._httpReadTimeout);
 }
 
-// parse URL for host and port and call probeMaxFragmentLength
-#if defined(ESP8266)         
-bool checkMFLN(BearSSL::WiFiClientSecure  *client, String url) {
-    int index = url.indexOf(':');
-     if(index < 0) {
-        return false;
-    }
-    String protocol = url.substring(0, index);
-    int port = -1;
-    url.remove(0, (index + 3)); // remove http:// or https://
-
-    if (protocol == "http") {
-        // set default port for 'http'
-        port = 80;
-    } else if (protocol == "https") {
-        // set default port for 'https'
-        port = 443;
-    } else {
-        return false;
-    }
-    index = url.indexOf('/');
-    String host = url.substring(0, index);
-    url.remove(0, index); // remove host 
-    // check Authorization
-    index = host.indexOf('@');
-    if(index >= 0) {
-        host.remove(0, index + 1); // remove auth part including @
-    }
-    // get port
-    index = host.indexOf(':');
-    if(index >= 0) {
-        String portS = host;
-        host = host.substring(0, index); // hostname
-        portS.remove(0, (index + 1)); // remove hostname + :
-        port = portS.toInt(); // get port
-    }
-    INFLUXDB_CLIENT_DEBUG("[D] probeMaxFragmentLength to %s:%d\n", host.c_str(), port);
-    bool mfln = client->probeMaxFragmentLength(host, port, 1024);
-    INFLUXDB_CLIENT_DEBUG("[D]  MFLN:%s\n", mfln ? "yes" : "no");
-    if (mfln) {
-        client->setBufferSizes(1024, 1024);
-    } 
-    return mfln;
-}
-#endif //ESP8266
 
 bool HTTPService::beforeRequest(const char *url) {
-   if(!_httpClient->begin(*_wifiClient, url)) {
+   if(!_transport->begin(url)) {
     _pConnInfo->lastError = F("begin failed");
     return false;
   }
-  if(_pConnInfo->authToken.length() > 0) {
-    _httpClient->addHeader(F("Authorization"), "Token " + _pConnInfo->authToken);
+  if(_authorization.length() > 0) {
+    _transport->addHeader(AuthorizationHeader, _authorization);
   }
-  const char * headerKeys[] = {RetryAfter, TransferEncoding} ;
-  _httpClient->collectHeaders(headerKeys, 2);
   return true;
 }
 
+void HTTPService::addHeader(const String &name, String &cache, const char *value) {
+  if(strcmp_P(cache.c_str(), value) != 0) {
+    cache = FPSTR(value);
+  }
+  _transport->addHeader(name, cache);
+}
+
 bool HTTPService::doPOST(const char *url, const char *data, const char *contentType, int expectedCode, httpResponseCallback cb) {
-  INFLUXDB_CLIENT_DEBUG("[D] POST request - %s, data: %dbytes, type %s\n", url, strlen(data), contentType);
-  if(!beforeRequest(url)) {
+  return doPOST(url, data, strlen(data), contentType, expectedCode, cb);
+}
+
+bool HTTPService::doPOST(const char *url, const char *data, size_t length, const char *contentType, int expectedCode, httpResponseCallback cb) {
+  INFLUXDB_CLIENT_DEBUG("[D] POST request - %s, data: %dbytes, type %s\n", url, length, contentType);
+  if(!sendRequest(url, [&](HTTPTransport *client) {
+      if(contentType) {
+        addHeader(ContentTypeHeader, _contentType, contentType);
+      }
+      return client->sendRequest("POST", (const uint8_t *) data, length);
+    })) {
     return false;
   }
-  if(contentType) {
-    _httpClient->addHeader(F("Content-Type"), FPSTR(contentType));
-  }
-  _lastStatusCode = _httpClient->POST((uint8_t *) data, strlen(data));
   return afterRequest(expectedCode, cb);
 }
 
-bool HTTPService::doPOST(const char *url, Stream *stream, const char *contentType, int expectedCode, httpResponseCallback cb) {
-  INFLUXDB_CLIENT_DEBUG("[D] POST request - %s, data: %dbytes, type %s\n", url, stream->available(), contentType);
-  if(!beforeRequest(url)) {
+bool HTTPService::doPOST(const char *url, Stream *stream, const char *contentType, int expectedCode, httpResponseCallback cb, const char *contentEncoding) {
+  int length = stream->available();
+  INFLUXDB_CLIENT_DEBUG("[D] POST request - %s, data: %dbytes, type %s\n", url, length, contentType);
+  if(!sendRequest(url, [&](HTTPTransport *client) {
+      if(stream->available() != length) {
+        // stream was partly read by failed attempt and cannot be sent again
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+      }
+      if(contentType) {
+        addHeader(ContentTypeHeader, _contentType, contentType);
+      }
+      if(contentEncoding) {
+        addHeader(ContentEncodingHeader, _contentEncoding, contentEncoding);
+      }
+      return client->sendRequest("POST", stream, length);
+    })) {
     return false;
   }
-  if(contentType) {
-    _httpClient->addHeader(F("Content-Type"), FPSTR(contentType));
-  }
-  _lastStatusCode = _httpClient->sendRequest("POST", stream, stream->available());
   return afterRequest(expectedCode, cb);
 }
 
 bool HTTPService::doGET(const char *url, int expectedCode, httpResponseCallback cb) {
   INFLUXDB_CLIENT_DEBUG("[D] GET request - %s\n", url);
-  if(!beforeRequest(url)) {
+  if(!sendRequest(url, [](HTTPTransport *client) { return client->sendRequest("GET"); })) {
     return false;
   }
-  _lastStatusCode = _httpClient->GET();
   return afterRequest(expectedCode, cb, false);
 }
 
 bool HTTPService::doDELETE(const char *url, int expectedCode, httpResponseCallback cb) {
   INFLUXDB_CLIENT_DEBUG("[D] DELETE - %s\n", url);
-  if(!beforeRequest(url)) {
+  if(!sendRequest(url, [](HTTPTransport *client) { return client->sendRequest("DELETE"); })) {
     return false;
   }
-  _lastStatusCode = _httpClient->sendRequest("DELETE");
   return afterRequest(expectedCode, cb, false);
 }
 
+// Errors of sending over a connection that has been closed by server
+static bool isClosedConnectionError(int code) {
+  return code == HTTPC_ERROR_SEND_HEADER_FAILED
+      || code == HTTPC_ERROR_SEND_PAYLOAD_FAILED
+      || code == HTTPC_ERROR_NOT_CONNECTED
+      || code == HTTPC_ERROR_CONNECTION_LOST;
+}
+
+bool HTTPService::sendRequest(const char *url, httpRequestCallback request) {
+  bool reused = isConnected();
+  if(reused && _pConnInfo->httpOptions._idleTimeout > 0 && millis() - _lastActivityTime >= _pConnInfo->httpOptions._idleTimeout) {
+    INFLUXDB_CLIENT_DEBUG("[D] Closing connection idle for %ums\n", millis() - _lastActivityTime);
+    closeConnection();
+    _connStats.idleCloses++;
+    reused = false;
+  }
+  uint32_t start = millis();
+  if(!beforeRequest(url)) {
+    return false;
+  }
+  _lastStatusCode = request(_transport);
+  if(reused && isClosedConnectionError(_lastStatusCode)) {
+    INFLUXDB_CLIENT_DEBUG("[D] Kept open connection closed by server, reconnecting\n");
+    closeConnection();
+    _connStats.reconnects++;
+    reused = false;
+    start = millis();
+    if(!beforeRequest(url)) {
+      return false;
+    }
+    _lastStatusCode = request(_transport);
+  }
+  _lastActivityTime = millis();
+  if(reused) {
+    _connStats.reuses++;
+    _connStats.reuseTime += _lastActivityTime - start;
+  } else if(_lastStatusCode != HTTPC_ERROR_CONNECTION_REFUSED) {
+    _connStats.connects++;
+    _connStats.connectTime += _lastActivityTime - start;
+  }
+  return true;
+}
+
+void HTTPService::closeConnection() {
+  _transport->stop();
+}
+
 bool HTTPService::afterRequest(int expectedStatusCode, httpResponseCallback cb,  bool modifyLastConnStatus) {
     if(modifyLastConnStatus) {
         _lastRequestTime = millis();
         INFLUXDB_CLIENT_DEBUG("[D] HTTP status code - %d\n", _lastStatusCode);
         _lastRetryAfter = 0;
         if(_lastStatusCode >= 429) { //retryable server errors
-            if(_httpClient->hasHeader(RetryAfter)) {
-                _lastRetryAfter = _httpClient->header(RetryAfter).toInt();
+            if(_transport->hasHeader(RetryAfter)) {
+                _lastRetryAfter = _transport->header(RetryAfter).toInt();
                 INFLUXDB_CLIENT_DEBUG("[D] Reply after - %d\n", _lastRetryAfter);
             }
         }
@@ -203,17 +216,25 @@ bool HTTPService::afterRequest(int expectedStatusCode, httpResponseCallback cb,
     bool endConnection = true;
     if(!ret) {
         if(_lastStatusCode > 0) {
-            _pConnInfo->lastError = _httpClient->getString();
+            readErrorBody();
             INFLUXDB_CLIENT_DEBUG("[D] Response:\n%s\n", _pConnInfo->lastError.c_str());
         } else {
-            _pConnInfo->lastError = _httpClient->errorToString(_lastStatusCode);
+            _pConnInfo->lastError = HTTPTransport::errorToString(_lastStatusCode);
             INFLUXDB_CLIENT_DEBUG("[E] Error - %s\n", _pConnInfo->lastError.c_str());
         }
     } else if(cb){
-      endConnection = cb(_httpClient);
+      endConnection = cb(_transport);
     }
     if(endConnection) {
-        _httpClient->end();
+        _transport->end();
     }
     return ret;
-}
\ No newline at end of file
+}
+
+void HTTPService::readErrorBody() {
+    char buffer[MaxErrorLength + 1];
+    ErrorBodySink sink(buffer, sizeof(buffer));
+    // whole body is read, so the connection can be reused
+    _transport->writeToStream(&sink);
+    _pConnInfo->lastError = buffer;
+}
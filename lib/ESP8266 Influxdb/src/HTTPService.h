@@ -28,19 +28,15 @@
 #define _HTTP_SERVICE_H_
 
 #include <Arduino.h>
-#if defined(ESP8266)
-# include <WiFiClientSecureBearSSL.h>
-# include <ESP8266HTTPClient.h>
-#elif defined(ESP32)
-# include <HTTPClient.h>
-#else
-# error "This library currently supports only ESP8266 and ESP32."
-#endif
+#include <functional>
+#include "HTTPTransport.h"
 #include "Options.h"
 
 
 class Test;
-typedef std::function<bool(HTTPClient *client)> httpResponseCallback;
+typedef std::function<bool(HTTPTransport *client)> httpResponseCallback;
+// Adds request headers and sends request, returns HTTP status code or HTTPC_ERROR_* code
+typedef std::function<int(HTTPTransport *client)> httpRequestCallback;
 extern const char *TransferEncoding;
 
 struct ConnectionInfo {
@@ -66,12 +62,31 @@ struct ConnectionInfo {
     HTTPOptions httpOptions;
 };
 
+// Connection counters, see HTTPService::getConnectionStats()
+struct ConnectionStats {
+    // Requests that opened a new connection, i.e. did a TLS handshake for https
+    uint32_t connects = 0;
+    // Requests sent over a kept open connection
+    uint32_t reuses = 0;
+    // Kept open connections closed before a request, because they were idle longer than idleTimeout
+    uint32_t idleCloses = 0;
+    // Requests sent again over a new connection, because server had closed the kept open one
+    uint32_t reconnects = 0;
+    // Total time [ms] of requests that opened a new connection
+    uint32_t connectTime = 0;
+    // Total time [ms] of requests over a kept open connection
+    uint32_t reuseTime = 0;
+};
+
 /**
  * HTTPService provides  HTTP methods for communicating with InfluxDBServer,
  * while taking care of Authorization and error handling
  **/
 class HTTPService {
 friend class Test;  
+  public:
+    // Maximum length of error message read from response body
+    static const uint16_t MaxErrorLength = 256;
   private:
     // Connection info data
     ConnectionInfo *_pConnInfo;    
@@ -81,20 +96,33 @@ friend class Test;
     uint32_t _lastRequestTime = 0;
     // HTTP status code of last request to server
     int _lastStatusCode = 0;
-    // Underlying HTTPClient instance 
-    HTTPClient *_httpClient = nullptr;
-    // Underlying connection object 
-    WiFiClient *_wifiClient = nullptr;
-#ifdef  ESP8266
-    // Trusted cert chain
-    BearSSL::X509List *_cert = nullptr;   
-#endif
+    // Underlying HTTP client
+    HTTPTransport *_transport;
+    // Whether transport was created by the service and is deleted with it
+    bool _ownsTransport = false;
     // Store retry timeout suggested by server after last request
     int _lastRetryAfter = 0;     
+    // Authorization header value, prepared once
+    String _authorization;
+    // Last used Content-Type and Content-Encoding values, kept so they are not created for each request
+    String _contentType;
+    String _contentEncoding;
+    // Time in ms the connection was last used
+    uint32_t _lastActivityTime = 0;
+    ConnectionStats _connStats;
    
 protected:
     // Sets request params
     bool beforeRequest(const char *url);
+    // Sends request over kept open connection, if it is not idle for too long, or over a new one.
+    // Request is sent again over a new connection, if server has closed the kept open one meanwhile.
+    bool sendRequest(const char *url, httpRequestCallback request);
+    // Closes kept open connection
+    void closeConnection();
+    // Reads error response body to lastError, at most MaxErrorLength characters are kept
+    void readErrorBody();
+    // Sets header, value String is reused while the value stays the same
+    void addHeader(const String &name, String &cache, const char *value);
     // Handles response
     bool afterRequest(int expectedStatusCode, httpResponseCallback cb, bool modifyLastConnStatus = true);
 public: 
@@ -102,7 +130,8 @@ public:
     // serverUrl - url of the InfluxDB 2 server (e.g. http://localhost:8086)
     // authToken - InfluxDB 2 authorization token 
     // certInfo - InfluxDB 2 server trusted certificate (or CA certificate) or certificate SHA1 fingerprint. Should be stored in PROGMEM.
-    HTTPService(ConnectionInfo *pConnInfo);
+    // transport - HTTP client to use, not owned. If nullptr, ArduinoHTTPTransport is created (ESP8266 and ESP32 only)
+    HTTPService(ConnectionInfo *pConnInfo, HTTPTransport *transport = nullptr);
     // Clean instance on deletion
     ~HTTPService();
     // Propagates http options to http client.
@@ -111,8 +140,11 @@ public:
     HTTPOptions &getHTTPOptions() { return _pConnInfo->httpOptions; }
     // Performs HTTP POST by sending data. On success calls response call back  
     bool doPOST(const char *url, const char *data, const char *contentType, int expectedCode, httpResponseCallback cb);
+    // Performs HTTP POST by sending data of known length. On success calls response call back  
+    bool doPOST(const char *url, const char *data, size_t length, const char *contentType, int expectedCode, httpResponseCallback cb);
     // Performs HTTP POST by sending stream. On success calls response call back  
-    bool doPOST(const char *url, Stream *stream, const char *contentType, int expectedCode, httpResponseCallback cb);
+    // contentEncoding - Optional. Value of Content-Encoding header, if stream is encoded (e.g. "gzip")
+    bool doPOST(const char *url, Stream *stream, const char *contentType, int expectedCode, httpResponseCallback cb, const char *contentEncoding = nullptr);
     // Performs HTTP GET. On success calls response call back    
     bool doGET(const char *url, int expectedCode, httpResponseCallback cb);
     // Performs HTTP DELETE. On success calls response call back    
@@ -128,7 +160,9 @@ public:
     // Returns response of last failed call.
     String getLastErrorMessage() const { return _pConnInfo->lastError; }
     // Returns true if HTTP connection is kept open
-    bool isConnected() const { return _httpClient && _httpClient->connected(); }
+    bool isConnected() const { return _transport && _transport->connected(); }
+    // Returns connection counters
+    const ConnectionStats &getConnectionStats() const { return _connStats; }
 };
 
 #endif //_HTTP_SERVICE_H_
\ No newline at end of file
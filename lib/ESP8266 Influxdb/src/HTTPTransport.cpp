@@ -0,0 +1,54 @@
+/**
+ *
+ * HTTPTransport.cpp: HTTP client interface used by HTTPService
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "HTTPTransport.h"
+
+String HTTPTransport::errorToString(int error) {
+  switch(error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED:
+      return F("connection refused");
+    case HTTPC_ERROR_SEND_HEADER_FAILED:
+      return F("send header failed");
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+      return F("send payload failed");
+    case HTTPC_ERROR_NOT_CONNECTED:
+      return F("not connected");
+    case HTTPC_ERROR_CONNECTION_LOST:
+      return F("connection lost");
+    case HTTPC_ERROR_NO_STREAM:
+      return F("no stream");
+    case HTTPC_ERROR_NO_HTTP_SERVER:
+      return F("no HTTP server");
+    case HTTPC_ERROR_TOO_LESS_RAM:
+      return F("too less ram");
+    case HTTPC_ERROR_ENCODING:
+      return F("Transfer-Encoding not supported");
+    case HTTPC_ERROR_STREAM_WRITE:
+      return F("Stream write error");
+    case HTTPC_ERROR_READ_TIMEOUT:
+      return F("read Timeout");
+    default:
+      return String();
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ *
+ * HTTPTransport.h: HTTP client interface used by HTTPService
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _HTTP_TRANSPORT_H_
+#define _HTTP_TRANSPORT_H_
+
+#include <Arduino.h>
+
+#if defined(ESP8266)
+# include <ESP8266HTTPClient.h>
+#elif defined(ESP32)
+# include <HTTPClient.h>
+#else
+// Errors of sending request and reading response, same as in HTTPClient of ESP8266 and ESP32 core
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+#endif
+
+/**
+ * HTTPTransport sends HTTP requests for HTTPService. It is used the same way as HTTPClient:
+ * begin(), addHeader(), sendRequest(), reading response and end().
+ * ArduinoHTTPTransport uses HTTPClient of the ESP8266/ESP32 core, PosixHTTPTransport uses BSD sockets,
+ * so the client can also run on a host against a local server.
+ */
+class HTTPTransport {
+  public:
+    virtual ~HTTPTransport() {}
+    // Sets whether connection is kept open after request and timeout [ms] for connecting and reading response
+    virtual void setOptions(bool reuse, int timeout) = 0;
+    virtual void setUserAgent(const String &userAgent) = 0;
+    // Prepares request to url. Returns false if url is not valid
+    virtual bool begin(const String &url) = 0;
+    virtual void addHeader(const String &name, const String &value) = 0;
+    // Sets names of response headers to keep
+    virtual void collectHeaders(const char *keys[], size_t count) = 0;
+    // Sends request with body of length bytes, data can be nullptr if there is no body.
+    // Returns HTTP status code or HTTPC_ERROR_* code
+    virtual int sendRequest(const char *method, const uint8_t *data, size_t length) = 0;
+    // Sends request with body of length bytes read from stream
+    virtual int sendRequest(const char *method, Stream *stream, size_t length) = 0;
+    // Sends request without body
+    int sendRequest(const char *method) { return sendRequest(method, (const uint8_t *)nullptr, 0); }
+    virtual bool hasHeader(const char *name) = 0;
+    virtual String header(const char *name) = 0;
+    // Returns response body length, -1 if it is not known
+    virtual int getSize() = 0;
+    // Reads whole response body
+    virtual String getString() = 0;
+    // Reads whole response body and writes it to stream. Returns number of bytes written or HTTPC_ERROR_* code
+    virtual int writeToStream(Stream *stream) = 0;
+    // Returns connection stream for reading response body as it arrives
+    virtual Stream *getStreamPtr() = 0;
+    virtual bool connected() = 0;
+    // Finishes request, connection is kept open if reuse is set and it can be used for next request
+    virtual void end() = 0;
+    // Closes connection
+    virtual void stop() = 0;
+    // Returns description of HTTPC_ERROR_* code
+    static String errorToString(int error);
+};
+
+#endif //_HTTP_TRANSPORT_H_
@@ -25,12 +25,10 @@
  * SOFTWARE.
 */
 #include "InfluxData.h"
-#include "util/helpers.h"
 
 void InfluxData::setTimestamp(long int seconds) 
 { 
-    _data->timestamp = timeStampToString(seconds,9);
-    strcat(_data->timestamp, "000000000"); 
+    setTime(seconds * 1000000000ULL);
 }
 
  String InfluxData::toString() const { 
@@ -68,6 +68,11 @@ void InfluxDBClient::setInsecure(bool value){
   _connInfo.insecure = value;
 }
 
+void InfluxDBClient::setHTTPTransport(HTTPTransport *transport) {
+    clean();
+    _transport = transport;
+}
+
 void InfluxDBClient::setConnectionParams(const String &serverUrl, const String &org, const String &bucket, const String &authToken, const char *certInfo) {
     clean();
     _connInfo.serverUrl = serverUrl;
@@ -110,7 +115,7 @@ bool InfluxDBClient::init() {
         _connInfo.lastError = F("Invalid URL scheme");
         return false;
     }
-    _service = new HTTPService(&_connInfo);
+    _service = new HTTPService(&_connInfo, _transport);
 
     setUrls();
     
@@ -126,6 +131,8 @@ InfluxDBClient::~InfluxDBClient() {
         }
         delete [] _writeBuffer;
         _writeBuffer = nullptr;
+        delete _spareBatch;
+        _spareBatch = nullptr;
         _bufferPointer = 0;
         _batchPointer = 0;
         _bufferCeiling = 0;
@@ -225,6 +232,9 @@ bool InfluxDBClient::setWriteOptions(const WriteOptions & writeOptions) {
     _writeOptions._maxRetryAttempts = writeOptions._maxRetryAttempts;
     _writeOptions._defaultTags = writeOptions._defaultTags;
     _writeOptions._useServerTimestamp = writeOptions._useServerTimestamp;
+    _writeOptions._gzip = writeOptions._gzip;
+    _writeOptions._adaptiveBatching = writeOptions._adaptiveBatching;
+    _flushPolicy.setLimits(_writeOptions._batchSize, _writeOptions._flushInterval);
     return true;
 }
 
@@ -253,6 +263,9 @@ void InfluxDBClient::resetBuffer() {
         }
         delete [] _writeBuffer;
     }
+    // batch size may have changed
+    delete _spareBatch;
+    _spareBatch = nullptr;
     INFLUXDB_CLIENT_DEBUG("[D] Reset buffer: buffer Size: %d, batch size: %d\n", _writeOptions._bufferSize, _writeOptions._batchSize);
     uint16_t a = _writeOptions._bufferSize/_writeOptions._batchSize;
     //limit to max(byte)
@@ -268,6 +281,7 @@ void InfluxDBClient::resetBuffer() {
     _bufferPointer = 0;
     _batchPointer = 0;
     _bufferCeiling = 0;
+    _hasPending = false;
 }
 
 void InfluxDBClient::reserveBuffer(int size) {
@@ -284,41 +298,29 @@ void InfluxDBClient::reserveBuffer(int size) {
     }
 }
 
-void InfluxDBClient::addZerosToTimestamp(Point &point, int zeroes) {
-    char *ts = point._data->timestamp, *s;
-    point._data->timestamp = new char[strlen(point._data->timestamp) + 1 + zeroes];
-    strcpy(point._data->timestamp, ts);
-    s = point._data->timestamp+strlen(ts);
-    for(int i=0;i<zeroes;i++) {
-        *s++ = '0';
-    }
-    *s = 0;
-    delete [] ts;
-}
-
 void InfluxDBClient::checkPrecisions(Point & point) {
     if(_writeOptions._writePrecision != WritePrecision::NoTime) {
         if(!point.hasTime()) {
             point.setTime(_writeOptions._writePrecision);
-        // Check different write precisions
-        } else if(point._data->tsWritePrecision != WritePrecision::NoTime && point._data->tsWritePrecision != _writeOptions._writePrecision) {
-            int diff = int(point._data->tsWritePrecision) - int(_writeOptions._writePrecision);
-            if(diff > 0) { //point has higher precision, cut 
-                point._data->timestamp[strlen(point._data->timestamp)-diff*3] = 0;
-            } else { //point has lower precision, add zeroes
-                addZerosToTimestamp(point, diff*-3);
-            }
+        } else {
+            point.rescaleTime(_writeOptions._writePrecision);
         }
     // check someone set WritePrecision on point and not on client. NS precision is ok, cause it is default on server
-    } else if(point.hasTime() && point._data->tsWritePrecision != WritePrecision::NoTime && point._data->tsWritePrecision != WritePrecision::NS) {
-        int diff = int(WritePrecision::NS) - int(point._data->tsWritePrecision);
-        addZerosToTimestamp(point, diff*3);
-    } 
+    } else {
+        point.rescaleTime(WritePrecision::NS);
+    }
 }
 
 bool InfluxDBClient::writePoint(Point & point) {
     if (point.hasFields()) {
         checkPrecisions(point);
+        _writeStats.pointsGenerated++;
+        // typical lines are formatted on stack, without allocation
+        char buff[256];
+        size_t length = point.writeLineProtocol(buff, sizeof(buff), _writeOptions._defaultTags, _writeOptions._useServerTimestamp);
+        if(length < sizeof(buff)) {
+            return writeRecord(buff, length);
+        }
         String line = pointToLineProtocol(point);
         return writeRecord(line);
     }
@@ -327,76 +329,158 @@ bool InfluxDBClient::writePoint(Point & point) {
 
 
 
-InfluxDBClient::Batch::Batch(uint16_t size):_size(size) {  
-    buffer = new char*[size]; 
-    for(int i=0;i< _size; i++) {
-        buffer[i] = nullptr; 
-    }
+// Initial arena size per line, arena grows if lines are longer
+static const uint32_t BatchLineSizeEstimate = 128;
+
+InfluxDBClient::Batch::Batch(uint16_t size, uint16_t expectedLines):_size(size) {  
+    _offsets = new uint32_t[size];
+    reserve(expectedLines * BatchLineSizeEstimate + 1);
 }
 
 
 InfluxDBClient::Batch::~Batch() { 
-    clear();
-    delete [] buffer; 
-    buffer = nullptr;
+    free(_data);
+    _data = nullptr;
+    delete [] _offsets;
+    _offsets = nullptr;
 }
 
 void InfluxDBClient::Batch::clear() {
-    for(int i=0;i< _size; i++) {
-        free(buffer[i]);
-        buffer[i] = nullptr; 
+    pointer = 0;
+    _length = 0;
+    if(_data) {
+        _data[0] = 0;
     }
 }
 
-bool InfluxDBClient::Batch::append(const char *line) {
+bool InfluxDBClient::Batch::reserve(uint32_t capacity) {
+    if(capacity <= _capacity) {
+        return true;
+    }
+    // grow geometrically to keep number of reallocations low
+    if(capacity < 2 * _capacity) {
+        capacity = 2 * _capacity;
+    }
+    char *data = (char *)realloc(_data, capacity);
+    if(!data) {
+        INFLUXDB_CLIENT_DEBUG("[E] Cannot allocate %u bytes for batch\n", capacity);
+        return false;
+    }
+    _data = data;
+    _capacity = capacity;
+    return true;
+}
+
+bool InfluxDBClient::Batch::append(const char *line, size_t length) {
     if(pointer == _size) {
         //overwriting, clean buffer
         clear();
-        pointer = 0;
     } 
-    buffer[pointer] = strdup(line);
+    // line, new line and terminating 0
+    if(!reserve(_length + length + 2)) {
+        return false;
+    }
+    _offsets[pointer] = _length;
+    memcpy(_data + _length, line, length);
+    _length += length;
+    _data[_length++] = '\n';
+    _data[_length] = 0;
     ++pointer;
-    return isFull();
+    return true;
 }
 
-char * InfluxDBClient::Batch::createData() {
-     int length = 0; 
-     char *buff = nullptr;
-     for(int c=0; c < pointer; c++) {
-        length += strlen(buffer[c]);
-        yield();
+const char *InfluxDBClient::Batch::getLine(uint16_t index, size_t &length) const {
+    uint32_t end = index + 1 < pointer ? _offsets[index + 1] : _length;
+    length = end - _offsets[index] - 1;
+    return _data + _offsets[index];
+}
+
+bool InfluxDBClient::Batch::load(BatchStore *store) {
+    clear();
+    size_t length = store->frontLength();
+    if(!length || !reserve(length + 1) || !store->readFront(_data)) {
+        return false;
     }
-    //create buffer for all lines including new line char and terminating char
-    if(length) {
-        buff = new char[length + pointer + 1];
-        if(buff) {
-            buff[0] = 0;
-            for(int c=0; c < pointer; c++) {
-                strcat(buff+strlen(buff), buffer[c]);
-                strcat(buff+strlen(buff), "\n");
-                yield();
-            }
+    _data[length] = 0;
+    // batch may have been stored with a larger batch size
+    uint32_t lines = 0;
+    for(uint32_t i = 0; i < length; i++) {
+        if(_data[i] == '\n') {
+            lines++;
         }
     }
-    return buff;
+    if(lines > _size) {
+        if(lines > UINT16_MAX) {
+            return false;
+        }
+        delete [] _offsets;
+        _offsets = new uint32_t[lines];
+        _size = lines;
+    }
+    // rebuild line offsets
+    uint32_t start = 0;
+    for(uint32_t i = 0; i < length; i++) {
+        if(_data[i] == '\n') {
+            _offsets[pointer++] = start;
+            start = i + 1;
+        }
+    }
+    if(start != length) {
+        // last line not terminated
+        clear();
+        return false;
+    }
+    _length = length;
+    return true;
 }
 
 bool InfluxDBClient::writeRecord(const String &record) {
-    return writeRecord(record.c_str());
+    return writeRecord(record.c_str(), record.length());
 }
 
 bool InfluxDBClient::writeRecord(const char *record) {    
+    return writeRecord(record, strlen(record));
+}
+
+bool InfluxDBClient::writeRecord(const char *record, size_t length) {    
     if(!_writeBuffer[_bufferPointer]) {
-        _writeBuffer[_bufferPointer] = new Batch(_writeOptions._batchSize);
-    }
-    if(isBufferFull() && _batchPointer <= _bufferPointer) {
-        // When we are overwriting buffer and nothing is written, batchPointer must point to the oldest point
-        _batchPointer = _bufferPointer+1;
-        if(_batchPointer == _writeBufferSize) {
-            _batchPointer = 0;
+        _writeBuffer[_bufferPointer] = newBatch();
+    }
+    Batch *batch = _writeBuffer[_bufferPointer];
+    // With a store, points are not appended to a batch waiting for retry, it is stored to keep order of points
+    if(batch->isFull() || (_batchStore && batch->retryCount > 0)) {
+        // Batch has not been written yet and will be overwritten, unless it can be stored.
+        // Older batches waiting for retry are stored first, stored batches are written oldest first
+        while(_batchStore && _batchPointer != _bufferPointer && _writeBuffer[_batchPointer]) {
+            storeBatch(_writeBuffer[_batchPointer]);
+            dropCurrentBatch();
         }
+        storeBatch(batch);
+        batch->clear();
+        batch->retryCount = 0;
+        // Overwritten batch is the oldest one, batchPointer must point to the next oldest
+        if(_batchPointer == _bufferPointer) {
+            _batchPointer = _bufferPointer+1;
+            if(_batchPointer == _writeBufferSize) {
+                _batchPointer = 0;
+            }
+        }
+    }
+    if(!batch->append(record, length)) {
+        _writeStats.pointsDropped++;
+        _connInfo.lastError = F("Not enough memory");
+        return false;
     }
-    if(_writeBuffer[_bufferPointer]->append(record)) { //we reached batch size
+    _writeStats.pointsEnqueued++;
+    _writeStats.bytesEnqueued += length + 1;
+    if(!_hasPending) {
+        _hasPending = true;
+        _pendingSince = millis();
+    }
+    if(_writeOptions._adaptiveBatching) {
+        _flushPolicy.onRecord(millis(), ESP.getFreeHeap());
+    }
+    if(batch->isFull()) { //we reached batch size
         _bufferPointer++;
         if(_bufferPointer == _writeBufferSize) { // writeBuffer is full
             _bufferPointer = 0;
@@ -412,6 +496,17 @@ bool InfluxDBClient::writeRecord(const char *record) {
 }
 
 bool InfluxDBClient::checkBuffer() {
+    if(_writeOptions._adaptiveBatching) {
+        // batch being filled reached adaptive size
+        bool reachedSize = _writeBuffer[_bufferPointer] && _writeBuffer[_bufferPointer]->pointer >= _flushPolicy.getBatchSize();
+        // or the oldest point waits too long
+        bool stale = _hasPending && _writeOptions._flushInterval > 0 && ((millis() - _pendingSince)/1000) >= _writeOptions._flushInterval;
+        bool full = _writeBuffer[_batchPointer] && _writeBuffer[_batchPointer]->isFull();
+        if(reachedSize || stale || full || isBufferFull()) {
+            return flushBufferInternal(false);
+        }
+        return true;
+    }
     // in case we (over)reach batchSize with non full buffer
     bool bufferReachedBatchsize = _writeBuffer[_batchPointer] && _writeBuffer[_batchPointer]->isFull();
     // or flush interval timed out
@@ -450,7 +545,10 @@ bool InfluxDBClient::flushBufferInternal(bool flashOnlyFull) {
         _connInfo.lastError += "s";
         return false;
     }
-    char *data;
+    // stored batches are older than those in buffer
+    if(_batchStore && !writeStoredBatches()) {
+        return false;
+    }
     bool success = true;
     // send all batches, It could happen there was long network outage and buffer is full
     while(_writeBuffer[_batchPointer] && (!flashOnlyFull ||  _writeBuffer[_batchPointer]->isFull())) {
@@ -463,39 +561,30 @@ bool InfluxDBClient::flushBufferInternal(bool flashOnlyFull) {
 
         INFLUXDB_CLIENT_DEBUG("[D] Writing batch, batchpointer: %d, size %d\n", _batchPointer, _writeBuffer[_batchPointer]->pointer);
         if(!_writeBuffer[_batchPointer]->isEmpty()) {
-            int statusCode = 0;
-            if(_streamWrite) {
-                statusCode = postData(_writeBuffer[_batchPointer]);
-            } else {
-                data = _writeBuffer[_batchPointer]->createData();
-                statusCode = postData(data);
-                delete [] data;
-            }
+            int statusCode = writeBatch(_writeBuffer[_batchPointer]);
             // retry on unsuccessfull connection or retryable status codes
             bool retry = (statusCode < 0 || statusCode >= 429) && _writeOptions._maxRetryAttempts > 0;
             success = statusCode >= 200 && statusCode < 300;
+            if(!success) {
+                _writeStats.failures++;
+            }
             // advance even on message failure x e <300;429)
             if(success || !retry) {
+                if(!success) {
+                    _writeStats.pointsDropped += _writeBuffer[_batchPointer]->pointer;
+                }
                 _lastFlushed = millis();
                 dropCurrentBatch();
             } else if(retry) {
                 _writeBuffer[_batchPointer]->retryCount++;
+                _writeStats.retries++;
                 if(statusCode > 0) { //apply retry strategy only in case of HTTP errors
                     if(_writeBuffer[_batchPointer]->retryCount > _writeOptions._maxRetryAttempts) {
                         INFLUXDB_CLIENT_DEBUG("[D] Reached max retry count, dropping batch\n");
+                        _writeStats.pointsDropped += _writeBuffer[_batchPointer]->pointer;
                         dropCurrentBatch();
                     }
-                    if(!_retryTime) {
-                        _retryTime = _writeOptions._retryInterval;
-                        if(_writeBuffer[_batchPointer]) {
-                            for(int i=1;i<_writeBuffer[_batchPointer]->retryCount;i++) {
-                                _retryTime *= _writeOptions._retryInterval;
-                            }
-                            if(_retryTime > _writeOptions._maxRetryInterval) {
-                                _retryTime = _writeOptions._maxRetryInterval;
-                            }
-                        }
-                    }
+                    setRetryTime(_writeBuffer[_batchPointer] ? _writeBuffer[_batchPointer]->retryCount : 1);
                 } 
                 INFLUXDB_CLIENT_DEBUG("[D] Leaving data in buffer for retry, retryInterval: %d\n",_retryTime);
                 // in case of retryable failure break loop
@@ -510,13 +599,35 @@ bool InfluxDBClient::flushBufferInternal(bool flashOnlyFull) {
         _bufferPointer = 0;
         _batchPointer = 0;
         _bufferCeiling = 0;
+        _hasPending = false;
         INFLUXDB_CLIENT_DEBUG("[D] Buffer empty\n");
     }
     return success;
 }
 
+InfluxDBClient::Batch *InfluxDBClient::newBatch() {
+    if(_spareBatch) {
+        Batch *batch = _spareBatch;
+        _spareBatch = nullptr;
+        return batch;
+    }
+    // with adaptive batching, batch is usually written before it is full, arena grows if needed
+    return new Batch(_writeOptions._batchSize, _writeOptions._adaptiveBatching ? _flushPolicy.getBatchSize() : _writeOptions._batchSize);
+}
+
+void InfluxDBClient::releaseBatch(Batch *batch) {
+    // batch loaded from store may be larger
+    if(_spareBatch || batch->getSize() != _writeOptions._batchSize) {
+        delete batch;
+    } else {
+        _spareBatch = batch;
+        _spareBatch->clear();
+        _spareBatch->retryCount = 0;
+    }
+}
+
 void  InfluxDBClient::dropCurrentBatch() {
-    delete _writeBuffer[_batchPointer];
+    releaseBatch(_writeBuffer[_batchPointer]);
     _writeBuffer[_batchPointer] = nullptr;
     _batchPointer++;
     //did we got over top?
@@ -529,6 +640,95 @@ void  InfluxDBClient::dropCurrentBatch() {
     INFLUXDB_CLIENT_DEBUG("[D] Dropped batch, batchpointer: %d\n", _batchPointer);
 }
 
+void InfluxDBClient::storeBatch(Batch *batch) {
+    if(_batchStore && _batchStore->push(batch->getData(), batch->getLength(), batch->pointer)) {
+        _writeStats.batchesStored++;
+    } else {
+        _writeStats.pointsDropped += batch->pointer;
+    }
+}
+
+void InfluxDBClient::setRetryTime(uint8_t retryCount) {
+    if(_retryTime) {
+        // suggested by server
+        return;
+    }
+    _retryTime = _writeOptions._retryInterval;
+    for(int i = 1; i < retryCount && _retryTime < _writeOptions._maxRetryInterval; i++) {
+        _retryTime *= _writeOptions._retryInterval;
+    }
+    if(_retryTime > _writeOptions._maxRetryInterval) {
+        _retryTime = _writeOptions._maxRetryInterval;
+    }
+}
+
+int InfluxDBClient::writeBatch(Batch *batch) {
+    uint32_t start = millis();
+    int statusCode;
+    if(_streamWrite || _writeOptions._gzip) {
+        statusCode = postData(batch);
+    } else {
+        statusCode = postData(batch->getData(), batch->getLength());
+    }
+    if(_writeOptions._adaptiveBatching) {
+        _flushPolicy.onWrite(millis() - start, statusCode >= 200 && statusCode < 300, ESP.getFreeHeap());
+    }
+    return statusCode;
+}
+
+bool InfluxDBClient::writeStoredBatches() {
+    if(_batchStore->isEmpty()) {
+        return true;
+    }
+    if(_batchStoreOffline) {
+        // cheap check instead of sending a batch again
+        if(!validateConnection()) {
+            return false;
+        }
+        _batchStoreOffline = false;
+    }
+    for(uint8_t i = 0; i < _writeBufferSize && !_batchStore->isEmpty(); i++) {
+        Batch *batch = newBatch();
+        if(!batch->load(_batchStore)) {
+            INFLUXDB_CLIENT_DEBUG("[E] Cannot load stored batch, dropping it\n");
+            _writeStats.storedBatchesDropped++;
+            releaseBatch(batch);
+            _batchStore->pop();
+            _storedRetryCount = 0;
+            continue;
+        }
+        int statusCode = writeBatch(batch);
+        uint16_t count = batch->pointer;
+        releaseBatch(batch);
+        if(statusCode >= 200 && statusCode < 300) {
+            _writeStats.batchesRestored++;
+            _lastFlushed = millis();
+        } else {
+            _writeStats.failures++;
+            if(statusCode < 0 || statusCode >= 429) {
+                // keep batch for later
+                _writeStats.retries++;
+                if(_storedRetryCount < UINT8_MAX) {
+                    _storedRetryCount++;
+                }
+                if(statusCode < 0) {
+                    _batchStoreOffline = true;
+                } else {
+                    // same back off as for batches in buffer, but stored batches are kept until written
+                    setRetryTime(_storedRetryCount);
+                }
+                return false;
+            }
+            // rejected by server
+            _writeStats.pointsDropped += count;
+        }
+        _batchStore->pop();
+        _storedRetryCount = 0;
+        yield();
+    }
+    return _batchStore->isEmpty();
+}
+
 String InfluxDBClient::pointToLineProtocol(const Point& point) {
     return point.createLineProtocol(_writeOptions._defaultTags, _writeOptions._useServerTimestamp);
 }
@@ -554,14 +754,17 @@ bool InfluxDBClient::validateConnection() {
     return ret;
 }
 
-int InfluxDBClient::postData(const char *data) {
+int InfluxDBClient::postData(const char *data, size_t length) {
     if(!_service && !init()) {
         return 0;
     }
     if(data) {
         INFLUXDB_CLIENT_DEBUG("[D] Writing to %s\n", _writeUrl.c_str());
         INFLUXDB_CLIENT_DEBUG("[D] Sending:\n%s\n", data);       
-        if(!_service->doPOST(_writeUrl.c_str(), data, PSTR("text/plain"), 204, nullptr)) {
+        _writeStats.batchesPosted++;
+        _writeStats.bytesSent += length;
+        _writeStats.bytesUncompressed += length;
+        if(!_service->doPOST(_writeUrl.c_str(), data, length, PSTR("text/plain"), 204, nullptr)) {
             INFLUXDB_CLIENT_DEBUG("[D] error %d: %s\n", _service->getLastStatusCode(), _service->getLastErrorMessage().c_str());
         }
         _retryTime = _service->getLastRetryAfter();
@@ -575,11 +778,28 @@ int InfluxDBClient::postData(Batch *batch) {
         return 0;
     }
 
-    BatchStreamer *bs = new BatchStreamer(batch);
+    Stream *bs = nullptr;
+    const char *contentEncoding = nullptr;
+    if(_writeOptions._gzip) {
+        GzipStream *gs = new GzipStream(batch->getData(), batch->getLength());
+        // very small batches do not compress
+        if(gs->getLength() < batch->getLength()) {
+            bs = gs;
+            contentEncoding = PSTR("gzip");
+        } else {
+            delete gs;
+        }
+    }
+    if(!bs) {
+        bs = new BatchStreamer(batch);
+    }
     INFLUXDB_CLIENT_DEBUG("[D] Writing to %s\n", _writeUrl.c_str());
     INFLUXDB_CLIENT_DEBUG("[D] Sending %d:\n", bs->available());       
+    _writeStats.batchesPosted++;
+    _writeStats.bytesSent += bs->available();
+    _writeStats.bytesUncompressed += batch->getLength();
     
-    if(!_service->doPOST(_writeUrl.c_str(), bs, PSTR("text/plain"), 204, nullptr)) {
+    if(!_service->doPOST(_writeUrl.c_str(), bs, PSTR("text/plain"), 204, nullptr, contentEncoding)) {
         INFLUXDB_CLIENT_DEBUG("[D] error %d: %s\n", _service->getLastStatusCode(), _service->getLastErrorMessage().c_str());
     }
     delete bs;
@@ -648,7 +868,7 @@ FluxQueryResult InfluxDBClient::query(const String &fluxQuery, QueryParams param
     CsvReader *reader = nullptr;
     _retryTime = 0;
     INFLUXDB_CLIENT_DEBUG("[D] Query: %s\n", body.c_str());
-    if(_service->doPOST(_queryUrl.c_str(), body.c_str(), PSTR("application/json"), 200, [&](HTTPClient *httpClient){
+    if(_service->doPOST(_queryUrl.c_str(), body.c_str(), body.length(), PSTR("application/json"), 200, [&](HTTPTransport *httpClient){
         bool chunked = false;
         if(httpClient->hasHeader(TransferEncoding)) {
             String header = httpClient->header(TransferEncoding);
@@ -707,12 +927,7 @@ static String escapeJSONString(const String &value) {
 InfluxDBClient::BatchStreamer::BatchStreamer(InfluxDBClient::Batch *batch) {
     _batch = batch;
     _read = 0;
-    _length = 0;
-    _pointer = 0;
-    _linePointer = 0;
-    for(uint16_t i=0;i<_batch->pointer;i++) {
-        _length += strlen(_batch->buffer[i])+1;
-    }
+    _length = _batch->getLength();
 }
 
 int InfluxDBClient::BatchStreamer::available() {
@@ -725,8 +940,6 @@ int InfluxDBClient::BatchStreamer::availableForWrite() {
 
 void InfluxDBClient::BatchStreamer::reset() {
     _read = 0;
-    _pointer = 0;
-    _linePointer = 0;
 }
 
 int InfluxDBClient::BatchStreamer::read(uint8_t* buffer, size_t len) {
@@ -740,15 +953,13 @@ size_t InfluxDBClient::BatchStreamer::readBytes(char* buffer, size_t len) {
 #elif defined(ESP32)
     INFLUXDB_CLIENT_DEBUG("BatchStream::readBytes %d, free_heap %d, max_alloc_heap %d\n", len, ESP.getFreeHeap(), ESP.getMaxAllocHeap());
 #endif
-    unsigned int r=0;
-    for(unsigned int i=0;i<len;i++) {
-        if(available()) {
-            buffer[i] = read();
-            r++;
-        } else {
-            break;
-        }
+    // copy as much of the remaining batch as fits
+    size_t r = available();
+    if(r > len) {
+        r = len;
     }
+    memcpy(buffer, _batch->getData() + _read, r);
+    _read += r;
     return r;
 }
 
@@ -756,28 +967,16 @@ int InfluxDBClient::BatchStreamer::read()  {
     int r = peek();
     if(r > 0) {
         ++_read;
-        ++_linePointer;
-        if(!_batch->buffer[_pointer][_linePointer-1]) {
-            ++_pointer;
-            _linePointer = 0;
-        }
     }
     return r;
 }
 
 int InfluxDBClient::BatchStreamer::peek() {
-    if(_pointer == _batch->pointer) {
+    if(_read == _length) {
         //This should not happen
         return -1;
     }
-    
-    int r;
-    if(!_batch->buffer[_pointer][_linePointer]) {
-        r = '\n';
-    } else {
-        r = _batch->buffer[_pointer][_linePointer];
-    }
-    return r;
+    return (uint8_t)_batch->getData()[_read];
 }
 
 size_t InfluxDBClient::BatchStreamer::write(uint8_t)  {
@@ -30,6 +30,7 @@
 #include <Arduino.h>
 #include "HTTPService.h"
 #include "Point.h"  
+#include "LineProtocolWriter.h"
 #include "WritePrecision.h"
 #include "query/FluxParser.h"
 #include "query/Params.h"
@@ -37,6 +38,9 @@
 #include "Options.h"
 #include "BucketsClient.h"
 #include "Version.h"
+#include "util/GzipStream.h"
+#include "BatchStore.h"
+#include "AdaptiveFlushPolicy.h"
 
 #ifdef USING_AXTLS
 #error AxTLS does not work
@@ -44,6 +48,34 @@
 
 class Test;
 
+// Write path counters, see InfluxDBClient::getWriteStats()
+struct WriteStats {
+    // Points converted to line protocol by writePoint
+    uint32_t pointsGenerated = 0;
+    // Records appended to the write buffer
+    uint32_t pointsEnqueued = 0;
+    // Line protocol bytes appended to the write buffer, including new line
+    uint32_t bytesEnqueued = 0;
+    // Records lost, overwritten in a full buffer or dropped after failed write
+    uint32_t pointsDropped = 0;
+    // Write requests sent to server
+    uint32_t batchesPosted = 0;
+    // Request body bytes sent to server, compressed if gzip is enabled
+    uint32_t bytesSent = 0;
+    // Request body bytes before compression
+    uint32_t bytesUncompressed = 0;
+    // Write requests that did not succeed
+    uint32_t failures = 0;
+    // Batches left in buffer for retrying
+    uint32_t retries = 0;
+    // Batches moved to batch store instead of being overwritten
+    uint32_t batchesStored = 0;
+    // Batches from batch store written to server
+    uint32_t batchesRestored = 0;
+    // Batches in batch store that could not be read back and were dropped
+    uint32_t storedBatchesDropped = 0;
+};
+
 /**
  * InfluxDBClient handles connection and basic operations for an InfluxDB server.
  * It provides write API with ability to write data in batches and retrying failed writes.
@@ -125,6 +157,7 @@ class InfluxDBClient {
     // Returns true if successful, false in case of any error 
     bool writeRecord(const String &record);
     bool writeRecord(const char *record);
+    bool writeRecord(const char *record, size_t length);
     // Writes record represented by Point to buffer
     // Returns true if successful, false in case of any error 
     bool writePoint(Point& point);
@@ -162,11 +195,27 @@ class InfluxDBClient {
     uint32_t getRemainingRetryTime();
     // Returns sub-client for managing buckets
     BucketsClient getBucketsClient();
-    // Enables/disables streaming write. This allows sending large batches without allocating buffer.
-    // It is about 50% slower than writing by allocated buffer (default);
+    // Enables/disables streaming write. Batch is sent in chunks pulled by HTTP client instead of a single write.
+    // Chunks are copied directly from batch memory, so it is about as fast as writing by buffer (default);
     void setStreamWrite(bool enable = true);
     // Returns true if HTTP connection is kept open (connection reuse must be set to true)
     bool isConnected() const { return _service && _service->isConnected(); }
+    // Returns connection counters: new connections (TLS handshakes), reused connections and their request times
+    ConnectionStats getConnectionStats() const { return _service ? _service->getConnectionStats() : ConnectionStats(); }
+    // Returns write path counters since start or last resetWriteStats()
+    const WriteStats &getWriteStats() const { return _writeStats; }
+    // Zeroes write path counters
+    void resetWriteStats() { _writeStats = WriteStats(); }
+    // Sets store for batches that would be overwritten in a full write buffer, e.g. during a network outage.
+    // Stored batches are written first, oldest first, once the server can be reached. nullptr disables storing.
+    void setBatchStore(BatchStore *store) { _batchStore = store; }
+    // Sets HTTP client used for requests instead of HTTPClient of the core, e.g. PosixHTTPTransport on a host.
+    // Transport is not owned and must be valid while the client is used. nullptr restores the default.
+    void setHTTPTransport(HTTPTransport *transport);
+    // Returns state of adaptive batching, see WriteOptions::adaptiveBatching
+    const AdaptiveFlushPolicy &getFlushPolicy() const { return _flushPolicy; }
+    // Sets thresholds of adaptive batching
+    void setFlushPolicyConfig(const AdaptiveFlushPolicy::Config &config) { _flushPolicy.setConfig(config); }
   protected:
     // Checks params and sets up security, if needed.
     // Returns true in case of success, otherwise false
@@ -174,24 +223,47 @@ class InfluxDBClient {
     // Cleans instances
     void clean();
   protected:
+    // Batch of lines kept in one contiguous arena, so appending is a copy and the arena is the request body
     class Batch {
     friend class Test;
       private:
         uint16_t _size = 0;
+        // Lines, each terminated by new line, followed by terminating 0
+        char *_data = nullptr;
+        // Used bytes of _data, without terminating 0
+        uint32_t _length = 0;
+        // Allocated bytes of _data
+        uint32_t _capacity = 0;
+        // Start offsets of lines in _data
+        uint32_t *_offsets = nullptr;
+        // Ensures arena can hold capacity bytes
+        bool reserve(uint32_t capacity);
       public:
         uint16_t pointer = 0;
-        char **buffer = nullptr;
         uint8_t retryCount = 0;
-        Batch(uint16_t size);
+        // size - maximum number of lines, expectedLines - number of lines the arena is initially sized for
+        Batch(uint16_t size, uint16_t expectedLines);
         ~Batch();
-        bool append(const char *line);
-        char *createData();
+        // Appends line of given length, overwriting batch if it is full.
+        // Returns false if there is not enough memory
+        bool append(const char *line, size_t length);
+        // Returns all lines separated by new line, or nullptr if empty
+        const char *getData() const { return _length ? _data : nullptr; }
+        // Returns length of data, without terminating 0
+        uint32_t getLength() const { return _length; }
+        // Returns line at index, without new line
+        const char *getLine(uint16_t index, size_t &length) const;
+        // Replaces content with the oldest batch in store, growing batch size if it holds more lines.
+        // Returns false if there is not enough memory or stored data is not a valid batch
+        bool load(BatchStore *store);
         void clear();
+        // Returns maximum number of lines
+        uint16_t getSize() const { return _size; }
         bool isFull() const {
           return pointer == _size;
         }
         bool isEmpty() const {
-          return pointer == 0 && !buffer[0];
+          return pointer == 0;
         }
     };
     class BatchStreamer : public Stream {
@@ -199,8 +271,6 @@ class InfluxDBClient {
         Batch *_batch;
         int _length;
         int _read;
-        uint16_t _pointer; //points to the item in batch
-        uint16_t _linePointer; //pointes to char in line of batch
       public:
         BatchStreamer(Batch *batch) ;
         virtual ~BatchStreamer() {};
@@ -229,6 +299,8 @@ class InfluxDBClient {
     String _queryUrl;
     // Points buffer
     Batch **_writeBuffer = nullptr;
+    // Written batch kept for reuse, so its arena is not reallocated for every batch
+    Batch *_spareBatch = nullptr;
     // Batch buffer size
     uint8_t _writeBufferSize;
     // Write options
@@ -249,24 +321,50 @@ class InfluxDBClient {
     BucketsClient _buckets;
     // Write using buffer or stream
     bool _streamWrite = false;
+    // Write path counters
+    WriteStats _writeStats;
+    // Store of batches which could not be written
+    BatchStore *_batchStore = nullptr;
+    // HTTP client set by setHTTPTransport
+    HTTPTransport *_transport = nullptr;
+    // Writing from batch store failed to connect, so connection is validated before next attempt
+    bool _batchStoreOffline = false;
+    // Failed attempts to write the oldest stored batch, for retry back off
+    uint8_t _storedRetryCount = 0;
+    // Adaptive batch size
+    AdaptiveFlushPolicy _flushPolicy;
+    // Buffer holds points, the oldest added at _pendingSince
+    bool _hasPending = false;
+    uint32_t _pendingSince = 0;
   protected:    
-    // Sends POST request with data in body
-    int postData(const char *data);
+    // Sends POST request with data of given length in body
+    int postData(const char *data, size_t length);
     int postData(Batch *batch);
+    // Sends batch, streamed or compressed according to options
+    int writeBatch(Batch *batch);
+    // Writes batches from batch store, oldest first, at most as many as the write buffer holds.
+    // Returns true if store is empty
+    bool writeStoredBatches();
       // Sets cached InfluxDB server API URLs
     bool setUrls();
     // Ensures buffer has required size
     void reserveBuffer(int size);
+    // Moves batch to batch store, or counts its points as dropped
+    void storeBatch(Batch *batch);
+    // Sets retry time for retryCount failed attempts, unless server suggested one
+    void setRetryTime(uint8_t retryCount);
     // Drops current batch and advances batch pointer
     void dropCurrentBatch();
+    // Returns empty batch, reusing the spare one if available
+    Batch *newBatch();
+    // Keeps batch as spare one, or deletes it
+    void releaseBatch(Batch *batch);
     // Writes all points in buffer, with respect to the batch size, and in case of success clears the buffer.
     //  flashOnlyFull - whether to flush only full batches
     // Returns true if successful, false in case of any error 
     bool flushBufferInternal(bool flashOnlyFull);
     // Checks precision of point and mofifies if needed
     void checkPrecisions(Point & point);
-    // helper which adds zeroes to timestamo of point to increase precision
-    static void addZerosToTimestamp(Point &point, int zeroes);
 };
 
 
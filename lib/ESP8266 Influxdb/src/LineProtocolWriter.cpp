@@ -0,0 +1,328 @@
+/**
+ *
+ * LineProtocolWriter.cpp: Allocation free line protocol encoder
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "LineProtocolWriter.h"
+
+static const char EscapeChars[] = "=\r\n\t ,";
+static const uint32_t Pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+LineProtocolWriter::LineProtocolWriter(char *buffer, size_t size):_buffer(buffer),_size(size) {
+    reset();
+}
+
+void LineProtocolWriter::reset() {
+    _length = 0;
+    _part = Part::Empty;
+    if(_size) {
+        _buffer[0] = 0;
+    }
+}
+
+void LineProtocolWriter::put(char c) {
+    if(_length + 1 < _size) {
+        _buffer[_length] = c;
+        _buffer[_length + 1] = 0;
+    }
+    ++_length;
+}
+
+void LineProtocolWriter::put(const char *s, size_t length) {
+    if(_length + length < _size) {
+        memcpy(_buffer + _length, s, length);
+        _buffer[_length + length] = 0;
+        _length += length;
+    } else {
+        // copy what fits, length still counts everything
+        for(size_t i = 0; i < length; i++) {
+            put(s[i]);
+        }
+    }
+}
+
+void LineProtocolWriter::putEscapedKey(const char *key, bool escapeEqual) {
+    const char *escape = escapeEqual ? EscapeChars : EscapeChars + 1;
+    char c;
+    while((c = *key++)) {
+        if(strchr(escape, c)) {
+            put('\\');
+        }
+        put(c);
+    }
+}
+
+LineProtocolWriter& LineProtocolWriter::measurement(const char *name) {
+    reset();
+    putEscapedKey(name, false);
+    _part = Part::Measurement;
+    return *this;
+}
+
+LineProtocolWriter& LineProtocolWriter::tag(const char *key, const char *value) {
+    put(',');
+    putEscapedKey(key, true);
+    put('=');
+    putEscapedKey(value, true);
+    _part = Part::Tags;
+    return *this;
+}
+
+void LineProtocolWriter::fieldKey(const char *key) {
+    put(_part < Part::Fields ? ' ' : ',');
+    putEscapedKey(key, true);
+    put('=');
+    _part = Part::Fields;
+}
+
+LineProtocolWriter& LineProtocolWriter::field(const char *key, long long value) {
+    char num[MaxNumberLength];
+    size_t n = formatInteger(num, value);
+    num[n++] = 'i';
+    return rawField(key, num, n);
+}
+
+LineProtocolWriter& LineProtocolWriter::field(const char *key, unsigned long long value) {
+    char num[MaxNumberLength];
+    size_t n = formatUnsigned(num, value);
+    num[n++] = 'i';
+    return rawField(key, num, n);
+}
+
+LineProtocolWriter& LineProtocolWriter::field(const char *key, double value, int decimalPlaces) {
+    if(isnan(value) || isinf(value)) {
+        return *this;
+    }
+    char num[MaxNumberLength];
+    return rawField(key, num, formatFixed(num, value, decimalPlaces));
+}
+
+LineProtocolWriter& LineProtocolWriter::field(const char *key, bool value) {
+    return value ? rawField(key, "true", 4) : rawField(key, "false", 5);
+}
+
+LineProtocolWriter& LineProtocolWriter::field(const char *key, const char *value) {
+    fieldKey(key);
+    put('"');
+    char c;
+    while((c = *value++)) {
+        if(c == '\\' || c == '"') {
+            put('\\');
+        }
+        put(c);
+    }
+    put('"');
+    return *this;
+}
+
+LineProtocolWriter& LineProtocolWriter::rawField(const char *key, const char *value, size_t length) {
+    fieldKey(key);
+    put(value, length);
+    return *this;
+}
+
+LineProtocolWriter& LineProtocolWriter::timestamp(unsigned long long timestamp) {
+    char num[MaxNumberLength];
+    put(' ');
+    put(num, formatUnsigned(num, timestamp));
+    _part = Part::Time;
+    return *this;
+}
+
+LineProtocolWriter& LineProtocolWriter::raw(const char *text, size_t length) {
+    put(text, length);
+    if(_part == Part::Empty) {
+        _part = Part::Measurement;
+    }
+    return *this;
+}
+
+LineProtocolWriter& LineProtocolWriter::escaped(const char *text) {
+    putEscapedKey(text, true);
+    return *this;
+}
+
+size_t LineProtocolWriter::formatUnsigned(char *out, unsigned long long value) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while(value);
+    for(size_t i = 0; i < n; i++) {
+        out[i] = digits[n - 1 - i];
+    }
+    return n;
+}
+
+size_t LineProtocolWriter::formatInteger(char *out, long long value) {
+    if(value < 0) {
+        out[0] = '-';
+        return 1 + formatUnsigned(out + 1, -(unsigned long long)value);
+    }
+    return formatUnsigned(out, value);
+}
+
+static int clampDecimalPlaces(int decimalPlaces) {
+    return decimalPlaces < 0 ? 0 : decimalPlaces > 9 ? 9 : decimalPlaces;
+}
+
+// Writes magnitude, which is value x 10^decimalPlaces, with decimal point
+static size_t formatDecimal(char *out, bool negative, unsigned long long magnitude, int decimalPlaces) {
+    size_t n = 0;
+    // sign even if value rounds to zero, like formatFixed()
+    if(negative) {
+        out[n++] = '-';
+    }
+    n += LineProtocolWriter::formatUnsigned(out + n, magnitude / Pow10[decimalPlaces]);
+    if(decimalPlaces) {
+        uint32_t fraction = magnitude % Pow10[decimalPlaces];
+        out[n++] = '.';
+        for(int i = decimalPlaces - 1; i >= 0; i--) {
+            out[n + i] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        n += decimalPlaces;
+    }
+    return n;
+}
+
+// Produces the digits of dtostrf(), which String(value, decimalPlaces) used before: half of the last
+// digit is added, then digits are taken off one by one by multiplying by 10. Ties and digits beyond
+// double precision therefore come out as they did, only the space padding dtostrf() adds to a
+// single digit without decimal places is left out.
+size_t LineProtocolWriter::formatFixed(char *out, double value, int decimalPlaces) {
+    if(isnan(value) || isinf(value)) {
+        int n = snprintf(out, MaxNumberLength, "%g", value);
+        return n < MaxNumberLength ? n : MaxNumberLength - 1;
+    }
+    if(decimalPlaces < 0) {
+        decimalPlaces = 0;
+    }
+    bool negative = value < 0.0;
+    double number = negative ? -value : value;
+    double rounding = 2.0;
+    for(int i = 0; i < decimalPlaces; i++) {
+        rounding *= 10.0;
+    }
+    number += 1.0 / rounding;
+    double tenpow = 1.0;
+    int digits = 1;
+    while(number >= 10.0 * tenpow) {
+        tenpow *= 10.0;
+        digits++;
+    }
+    if(negative + digits + (decimalPlaces ? decimalPlaces + 1 : 0) > MaxNumberLength) {
+        // too long, scientific notation is valid line protocol too
+        int n = snprintf(out, MaxNumberLength, "%.17g", value);
+        return n < MaxNumberLength ? n : MaxNumberLength - 1;
+    }
+    number /= tenpow;
+    size_t n = 0;
+    if(negative) {
+        out[n++] = '-';
+    }
+    for(int remaining = digits + decimalPlaces; remaining > 0; ) {
+        int digit = (int)number;
+        if(digit > 9) {
+            digit = 9;
+        }
+        out[n++] = '0' + digit;
+        if(--remaining == decimalPlaces && decimalPlaces > 0) {
+            out[n++] = '.';
+        }
+        number -= digit;
+        number *= 10.0;
+    }
+    return n;
+}
+
+// Integer arithmetic gives the digits of formatFixed(value / 10^scale) below this magnitude,
+// where double still holds every digit
+static const unsigned long long MaxExactMagnitude = 1000000000000000ULL;
+
+size_t LineProtocolWriter::formatScaled(char *out, long long value, int scale, int decimalPlaces) {
+    scale = clampDecimalPlaces(scale);
+    if(decimalPlaces < 0) {
+        decimalPlaces = 0;
+    }
+    unsigned long long magnitude = value < 0 ? -(unsigned long long)value : value;
+    bool exact = decimalPlaces <= 9 && magnitude < MaxExactMagnitude;
+    if(exact && decimalPlaces < scale) {
+        uint32_t divisor = Pow10[scale - decimalPlaces];
+        uint32_t dropped = magnitude % divisor;
+        // a tie rounds the way its nearest double does
+        exact = dropped != divisor / 2;
+        magnitude = magnitude / divisor + (dropped > divisor / 2);
+    } else if(exact) {
+        exact = magnitude < MaxExactMagnitude / Pow10[decimalPlaces - scale];
+        magnitude *= Pow10[decimalPlaces - scale];
+    }
+    if(!exact) {
+        return formatFixed(out, value / (double)Pow10[scale], decimalPlaces);
+    }
+    return formatDecimal(out, value < 0, magnitude, decimalPlaces);
+}
+
+size_t LineProtocolWriter::escapeKey(char *out, const char *key, bool escapeEqual) {
+    const char *escape = escapeEqual ? EscapeChars : EscapeChars + 1;
+    size_t n = 0;
+    char c;
+    while((c = *key++)) {
+        if(strchr(escape, c)) {
+            if(out) {
+                out[n] = '\\';
+            }
+            n++;
+        }
+        if(out) {
+            out[n] = c;
+        }
+        n++;
+    }
+    return n;
+}
+
+size_t LineProtocolWriter::escapeValue(char *out, const char *value) {
+    size_t n = 0;
+    char c;
+    if(out) {
+        out[n] = '"';
+    }
+    n++;
+    while((c = *value++)) {
+        if(c == '\\' || c == '"') {
+            if(out) {
+                out[n] = '\\';
+            }
+            n++;
+        }
+        if(out) {
+            out[n] = c;
+        }
+        n++;
+    }
+    if(out) {
+        out[n] = '"';
+    }
+    return n + 1;
+}
@@ -0,0 +1,117 @@
+/**
+ *
+ * LineProtocolWriter.h: Allocation free line protocol encoder
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _LINE_PROTOCOL_WRITER_H_
+#define _LINE_PROTOCOL_WRITER_H_
+
+#include <Arduino.h>
+
+/**
+ * LineProtocolWriter encodes a single line of InfluxDB line protocol into a caller provided buffer.
+ * Names and values are escaped and numbers are formatted in place, in one pass and without heap allocation.
+ * Parts must be added in order: measurement, tags, fields, timestamp.
+ * Example:
+ *   char buff[128];
+ *   LineProtocolWriter w(buff, sizeof(buff));
+ *   w.measurement("environment").tag("device", "esp32").field("temperature", 21.5, 1).timestamp(1711390037);
+ *   if(!w.overflow()) client.writeRecord(w.c_str(), w.length());
+ */
+class LineProtocolWriter {
+  public:
+    // Maximum length of a number formatted by the format* functions
+    static const uint8_t MaxNumberLength = 32;
+
+    LineProtocolWriter(char *buffer, size_t size);
+    // Clears buffer to start a new line
+    void reset();
+    // Starts line with measurement name
+    LineProtocolWriter& measurement(const char *name);
+    // Adds tag
+    LineProtocolWriter& tag(const char *key, const char *value);
+    // Adds integer field
+    LineProtocolWriter& field(const char *key, long long value);
+    LineProtocolWriter& field(const char *key, unsigned long long value);
+    LineProtocolWriter& field(const char *key, long value) { return field(key, (long long)value); }
+    LineProtocolWriter& field(const char *key, unsigned long value) { return field(key, (unsigned long long)value); }
+    LineProtocolWriter& field(const char *key, int value) { return field(key, (long long)value); }
+    LineProtocolWriter& field(const char *key, unsigned int value) { return field(key, (unsigned long long)value); }
+    // Adds float field with fixed number of decimal places. NaN and infinity are skipped.
+    LineProtocolWriter& field(const char *key, double value, int decimalPlaces = 2);
+    // Adds boolean field
+    LineProtocolWriter& field(const char *key, bool value);
+    // Adds string field
+    LineProtocolWriter& field(const char *key, const char *value);
+    // Adds field with already formatted value, e.g. "12i"
+    LineProtocolWriter& rawField(const char *key, const char *value, size_t length);
+    // Sets timestamp
+    LineProtocolWriter& timestamp(unsigned long long timestamp);
+    // Appends already escaped text, e.g. cached measurement and tags
+    LineProtocolWriter& raw(const char *text, size_t length);
+    // Appends text escaped as tag key, tag value or field key, e.g. tag value after cached ",key="
+    LineProtocolWriter& escaped(const char *text);
+    // Returns line, always 0 terminated
+    const char *c_str() const { return _buffer; }
+    // Returns line length. If it is not less than buffer size, line is truncated, see overflow()
+    size_t length() const { return _length; }
+    // Returns true if line did not fit into the buffer
+    bool overflow() const { return _length >= _size; }
+    // Returns true if at least one field has been added
+    bool hasFields() const { return _part >= Part::Fields; }
+
+    // Formatting helpers. Write number into out, which must have space for MaxNumberLength chars, and return its length.
+    // Output is not 0 terminated.
+    static size_t formatInteger(char *out, long long value);
+    static size_t formatUnsigned(char *out, unsigned long long value);
+    // Formats value rounded to decimalPlaces digits after decimal point, with the same digits as String(value, decimalPlaces)
+    // of the ESP32 core, but no leading space. Values longer than MaxNumberLength are written in scientific notation (%.17g).
+    static size_t formatFixed(char *out, double value, int decimalPlaces);
+    // Formats integer value with implied scale (0-9, e.g. 1234 with scale 2 is 12.34) rounded to decimalPlaces digits
+    // after decimal point. Output equals formatFixed(value / 10^scale), but is computed with integer arithmetic,
+    // except for ties of dropped digits and numbers of more than 15 digits.
+    static size_t formatScaled(char *out, long long value, int scale, int decimalPlaces);
+    // Escapes measurement (escapeEqual = false), tag key, tag value or field key. Writes to out, if not nullptr.
+    // Returns escaped length.
+    static size_t escapeKey(char *out, const char *key, bool escapeEqual = true);
+    // Escapes and quotes string field value. Writes to out, if not nullptr. Returns escaped length.
+    static size_t escapeValue(char *out, const char *value);
+  private:
+    enum class Part : uint8_t {
+        Empty,
+        Measurement,
+        Tags,
+        Fields,
+        Time
+    };
+    char *_buffer;
+    size_t _size;
+    size_t _length;
+    Part _part;
+  private:
+    void put(char c);
+    void put(const char *s, size_t length);
+    void putEscapedKey(const char *key, bool escapeEqual);
+    void fieldKey(const char *key);
+};
+
+#endif //_LINE_PROTOCOL_WRITER_H_
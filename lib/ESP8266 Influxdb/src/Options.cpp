@@ -53,4 +53,6 @@ void WriteOptions::printTo(Print &dest) const {
     dest.print("\t_maxRetryAttempts: "); dest.println(_maxRetryAttempts);
     dest.print("\t_defaultTags: "); dest.println(_defaultTags);
     dest.print("\t_useServerTimestamp: "); dest.println(_useServerTimestamp);
+    dest.print("\t_gzip: "); dest.println(_gzip);
+    dest.print("\t_adaptiveBatching: "); dest.println(_adaptiveBatching);
 }
@@ -66,6 +66,10 @@ private:
     String _defaultTags;
     //  Let server assign timestamp in given precision. Do not sent timestamp.
     bool _useServerTimestamp;
+    // Compress write requests body with gzip. Default false.
+    bool _gzip;
+    // Adapt number of points written at once up to batch size. Default false.
+    bool _adaptiveBatching;
 public:
     WriteOptions():
         _writePrecision(WritePrecision::NoTime),
@@ -75,7 +79,9 @@ public:
         _retryInterval(5),
         _maxRetryInterval(300),
         _maxRetryAttempts(3),
-        _useServerTimestamp(false) {
+        _useServerTimestamp(false),
+        _gzip(false),
+        _adaptiveBatching(false) {
         }
     // Sets timestamp precision. If timestamp precision is set, but a point does not have a timestamp, timestamp is automatically assigned from the device clock.
     // If useServerTimestamp is set to true, timestamp is not sent, only precision is specified for the server.
@@ -101,6 +107,13 @@ public:
     WriteOptions& clearDefaultTags() { _defaultTags = (char *)nullptr; return *this; }
     // If timestamp precision is set and useServerTimestamp  is true, timestamp from point is not sent, or assigned.
     WriteOptions& useServerTimestamp(bool useServerTimestamp) { _useServerTimestamp = useServerTimestamp; return *this; }
+    // If gzip is true, batches are sent gzip compressed (Content-Encoding: gzip). Saves bandwidth on repetitive data at the cost of CPU time.
+    // Compression uses fixed ~2kB of memory and does not allocate a buffer for compressed data.
+    WriteOptions& gzip(bool gzip) { _gzip = gzip; return *this; }
+    // If adaptiveBatching is true, batch size is the maximum number of points written at once. Actual number grows
+    // when requests take long and shrinks on failures or low memory, see AdaptiveFlushPolicy.
+    // Flush interval is then the maximum time a point waits in buffer.
+    WriteOptions& adaptiveBatching(bool adaptiveBatching) { _adaptiveBatching = adaptiveBatching; return *this; }
     // prints options values to a Print device. E.g. opts.printTo(Serial);
     void printTo(Print &dest) const;
 };
@@ -120,15 +133,22 @@ private:
     // Timeout [ms] for reading server response.
     // Default 5000ms  
     int _httpReadTimeout;
+    // Time [ms] after which a kept open idle connection is closed and a new one is opened for next request,
+    // as servers and NAT gateways silently drop idle connections. 0 means no limit.
+    // Default 0
+    uint32_t _idleTimeout;
 public:
     HTTPOptions():
         _connectionReuse(false),
-        _httpReadTimeout(5000) {
+        _httpReadTimeout(5000),
+        _idleTimeout(0) {
         }
     // Set true if HTTP connection should be kept open. Usable for frequent writes.
     HTTPOptions& connectionReuse(bool connectionReuse) { _connectionReuse = connectionReuse; return *this; }
     // Sets timeout after which HTTP stops reading
     HTTPOptions& httpReadTimeout(int httpReadTimeoutMs) { _httpReadTimeout = httpReadTimeoutMs; return *this; }
+    // Sets time after which a kept open idle connection is not reused
+    HTTPOptions& idleTimeout(uint32_t idleTimeoutMs) { _idleTimeout = idleTimeoutMs; return *this; }
 };
 
 #endif //_OPTIONS_H_
@@ -15,6 +15,9 @@
 # include <esp_arduino_version.h>
 # define INFLUXDB_CLIENT_PLATFORM "ESP32"
 # define INFLUXDB_CLIENT_PLATFORM_VERSION VERSION_STR(ESP_ARDUINO_VERSION_MAJOR, ESP_ARDUINO_VERSION_MINOR, ESP_ARDUINO_VERSION_PATCH)
+#else
+# define INFLUXDB_CLIENT_PLATFORM "POSIX"
+# define INFLUXDB_CLIENT_PLATFORM_VERSION "0"
 #endif
 
 #endif //_PLATFORM_H_
\ No newline at end of file
@@ -26,6 +26,8 @@
 */
 
 #include "Point.h"
+#include <limits.h>
+#include "LineProtocolWriter.h"
 #include "util/helpers.h"
 
 Point::Point(const String & measurement)
@@ -38,13 +40,13 @@ Point::~Point() {
 
 Point::Data::Data(char * measurement) {
   this->measurement = measurement;
-  timestamp = nullptr;
+  timestamp = 0;
+  hasTimestamp = false;
   tsWritePrecision = WritePrecision::NoTime;
 }
 
 Point::Data::~Data() {
   delete [] measurement;
-  delete [] timestamp;
 }
 
 Point::Point(const Point &other) {
@@ -58,33 +60,53 @@ Point& Point::operator=(const Point &other) {
   return *this;
 }
 
+// Appends escaped key, tag value or string field value to dest
+static void appendEscaped(String &dest, const char *value, bool isFieldValue) {
+  size_t len = isFieldValue ? LineProtocolWriter::escapeValue(nullptr, value) : LineProtocolWriter::escapeKey(nullptr, value);
+  char buff[64];
+  // long values are rare, allocate only for them
+  char *s = len <= sizeof(buff) ? buff : new char[len];
+  if(isFieldValue) {
+    LineProtocolWriter::escapeValue(s, value);
+  } else {
+    LineProtocolWriter::escapeKey(s, value);
+  }
+  dest.concat(s, len);
+  if(s != buff) {
+    delete [] s;
+  }
+}
+
 void Point::addTag(const String &name, String value) {
   if(_data->tags.length() > 0) {
       _data->tags += ',';
   }
-  char *s = escapeKey(name);
-  _data->tags += s;
-  delete [] s;
+  appendEscaped(_data->tags, name.c_str(), false);
   _data->tags += '=';
-  s = escapeKey(value);
-  _data->tags += s;
-  delete [] s;
+  appendEscaped(_data->tags, value.c_str(), false);
 }
 
 void Point::addField(const String &name, long long value) {
-  char buff[23];
-  snprintf(buff, 50, "%lld", value);
-  putField(name, String(buff)+"i");
+  char buff[LineProtocolWriter::MaxNumberLength];
+  size_t n = LineProtocolWriter::formatInteger(buff, value);
+  buff[n++] = 'i';
+  putField(name, buff, n);
 }
 
 void Point::addField(const String &name, unsigned long long value) {
-  char buff[23];
-  snprintf(buff, 50, "%llu", value);
-  putField(name, String(buff)+"i");
+  char buff[LineProtocolWriter::MaxNumberLength];
+  size_t n = LineProtocolWriter::formatUnsigned(buff, value);
+  buff[n++] = 'i';
+  putField(name, buff, n);
 }
 
 void Point::addField(const String &name, const char *value) { 
-    putField(name, escapeValue(value)); 
+  if(_data->fields.length() > 0) {
+      _data->fields += ',';
+  }
+  appendEscaped(_data->fields, name.c_str(), false);
+  _data->fields += '=';
+  appendEscaped(_data->fields, value, true);
 }
 
 void Point::addField(const String &name, const __FlashStringHelper *pstr) {
@@ -92,39 +114,50 @@ void Point::addField(const String &name, const __FlashStringHelper *pstr) {
 }
 
 void Point::addField(const String &name, float value, int decimalPlaces) { 
-    if(!isnan(value)) putField(name, String(value, decimalPlaces)); 
+    addField(name, (double)value, decimalPlaces);
 }
 
 void Point::addField(const String &name, double value, int decimalPlaces) {
-    if(!isnan(value)) putField(name, String(value, decimalPlaces)); 
+    // infinity is not valid in line protocol
+    if(!isnan(value) && !isinf(value)) {
+        char buff[LineProtocolWriter::MaxNumberLength];
+        putField(name, buff, LineProtocolWriter::formatFixed(buff, value, decimalPlaces));
+    }
+}
+
+void Point::addScaledField(const String &name, long long value, uint8_t scale, int decimalPlaces) {
+    char buff[LineProtocolWriter::MaxNumberLength];
+    putField(name, buff, LineProtocolWriter::formatScaled(buff, value, scale, decimalPlaces));
 }
 
 void Point::addField(const String &name, char value) { 
-    addField(name, String(value).c_str()); 
+    char s[] = {value, 0};
+    addField(name, s); 
 }
 
 void Point::addField(const String &name, unsigned char value) {
-    putField(name, String(value)+"i"); 
+    addField(name, (unsigned long long)value); 
 }
 
 void Point::addField(const String &name, int value) { 
-    putField(name, String(value)+"i"); 
+    addField(name, (long long)value); 
 }
 
 void Point::addField(const String &name, unsigned int value) { 
-    putField(name, String(value)+"i"); 
+    addField(name, (unsigned long long)value); 
 }
 
 void Point::addField(const String &name, long value)  { 
-    putField(name, String(value)+"i"); 
+    addField(name, (long long)value); 
 }
 
 void Point::addField(const String &name, unsigned long value) { 
-    putField(name, String(value)+"i"); 
+    addField(name, (unsigned long long)value); 
 }
 
 void Point::addField(const String &name, bool value)  { 
-    putField(name, bool2string(value)); 
+    const char *s = bool2string(value);
+    putField(name, s, strlen(s)); 
 }
 
 void Point::addField(const String &name, const String &value)  { 
@@ -132,23 +165,35 @@ void Point::addField(const String &name, const String &value)  {
 }
 
 void Point::putField(const String &name, const String &value) {
+    putField(name, value.c_str(), value.length());
+}
+
+void Point::putField(const String &name, const char *value, size_t length) {
     if(_data->fields.length() > 0) {
         _data->fields += ',';
     }
-    char *s = escapeKey(name);
-    _data->fields += s;
-    delete [] s;
+    appendEscaped(_data->fields, name.c_str(), false);
     _data->fields += '=';
-    _data->fields += value;
+    _data->fields.concat(value, length);
 }
 
 String Point::toLineProtocol(const String &includeTags) const {
     return createLineProtocol(includeTags);
 }
 
+size_t Point::toLineProtocol(char *buffer, size_t size, const String &includeTags) const {
+    return writeLineProtocol(buffer, size, includeTags);
+}
+
 String Point::createLineProtocol(const String &incTags, bool excludeTimestamp) const {
     String line;
-    line.reserve(strLen(_data->measurement) + 1 + incTags.length() + 1 + _data->tags.length() + 1 + _data->fields.length() + 1 + strLen(_data->timestamp));
+    char ts[LineProtocolWriter::MaxNumberLength + 1];
+    size_t tsLength = 0;
+    if(hasTime() && !excludeTimestamp) {
+        tsLength = LineProtocolWriter::formatUnsigned(ts, _data->timestamp);
+    }
+    ts[tsLength] = 0;
+    line.reserve(strLen(_data->measurement) + 1 + incTags.length() + 1 + _data->tags.length() + 1 + _data->fields.length() + 1 + tsLength);
     line += _data->measurement;
     if(incTags.length()>0) {
         line += ",";
@@ -162,60 +207,117 @@ String Point::createLineProtocol(const String &incTags, bool excludeTimestamp) c
         line += " ";
         line += _data->fields;
     }
-    if(hasTime() && !excludeTimestamp) {
+    if(tsLength) {
         line += " ";
-        line += _data->timestamp;
+        line += ts;
     }
     return line;
  }
 
+size_t Point::writeLineProtocol(char *buffer, size_t size, const String &incTags, bool excludeTimestamp) const {
+    // parts are already escaped
+    LineProtocolWriter writer(buffer, size);
+    writer.raw(_data->measurement, strLen(_data->measurement));
+    if(incTags.length()>0) {
+        writer.raw(",", 1).raw(incTags.c_str(), incTags.length());
+    }
+    if(hasTags()) {
+        writer.raw(",", 1).raw(_data->tags.c_str(), _data->tags.length());
+    }
+    if(hasFields()) {
+        writer.raw(" ", 1).raw(_data->fields.c_str(), _data->fields.length());
+    }
+    if(hasTime() && !excludeTimestamp) {
+        writer.timestamp(_data->timestamp);
+    }
+    return writer.length();
+}
+
 void Point::setTime(WritePrecision precision) {
     struct timeval tv;
     gettimeofday(&tv, NULL);
     
     switch(precision) {
         case WritePrecision::NS:
-            setTime(getTimeStamp(&tv,9));
+            setTime(getTimeStamp(&tv,9), precision);
             break;
         case WritePrecision::US:
-            setTime(getTimeStamp(&tv,6));
+            setTime(getTimeStamp(&tv,6), precision);
             break;
         case WritePrecision::MS: 
-            setTime(getTimeStamp(&tv,3));
+            setTime(getTimeStamp(&tv,3), precision);
             break;
         case WritePrecision::S:
-            setTime(getTimeStamp(&tv,0));
+            setTime(getTimeStamp(&tv,0), precision);
             break;
         case WritePrecision::NoTime:
-            setTime((char *)nullptr);
+            _data->hasTimestamp = false;
+            _data->tsWritePrecision = precision;
             break;
     }
-    _data->tsWritePrecision = precision;
 }
 
 void  Point::setTime(unsigned long long timestamp) {
-    setTime(timeStampToString(timestamp));
+    _data->timestamp = timestamp;
+    _data->hasTimestamp = true;
+}
+
+void Point::setTime(unsigned long long timestamp, WritePrecision precision) {
+    setTime(timestamp);
+    _data->tsWritePrecision = precision;
 }
 
 void Point::setTime(const String &timestamp) {
-    setTime(cloneStr(timestamp.c_str()));
+    setTime(timestamp.c_str());
 }
 
 void Point::setTime(const char *timestamp) {
-    setTime(cloneStr(timestamp));    
+    if(strLen(timestamp) == 0) {
+        _data->hasTimestamp = false;
+        return;
+    }
+    // strtoull() would take garbage as 0 and wrap negative numbers, keep current time instead
+    unsigned long long value = 0;
+    for(const char *p = timestamp; *p; p++) {
+        unsigned digit = *p - '0';
+        if(digit > 9 || value > (ULLONG_MAX - digit) / 10) {
+            return;
+        }
+        value = value * 10 + digit;
+    }
+    setTime(value);
 }
 
-void Point::setTime(char *timestamp) {
-    delete [] _data->timestamp;
-    _data->timestamp = timestamp;
+String Point::getTime() const {
+    char ts[LineProtocolWriter::MaxNumberLength + 1];
+    size_t length = 0;
+    if(hasTime()) {
+        length = LineProtocolWriter::formatUnsigned(ts, _data->timestamp);
+    }
+    ts[length] = 0;
+    return ts;
+}
+
+void Point::rescaleTime(WritePrecision precision) {
+    static const unsigned long Pow1000[] = {1, 1000, 1000000, 1000000000};
+    if(!hasTime() || _data->tsWritePrecision == WritePrecision::NoTime || precision == WritePrecision::NoTime) {
+        return;
+    }
+    int diff = int(_data->tsWritePrecision) - int(precision);
+    if(diff > 0) { // point has higher precision, cut
+        _data->timestamp /= Pow1000[diff];
+    } else if(diff < 0) { // point has lower precision, add zeroes
+        _data->timestamp *= Pow1000[-diff];
+    }
+    _data->tsWritePrecision = precision;
 }
 
 void  Point::clearFields() {
-    _data->fields = (char *)nullptr;
-    delete [] _data->timestamp;
-    _data->timestamp = nullptr;
+    // keep allocated memory for reuse
+    _data->fields = "";
+    _data->hasTimestamp = false;
 }
 
 void Point:: clearTags() {
-    _data->tags = (char *)nullptr;
+    _data->tags = "";
 }
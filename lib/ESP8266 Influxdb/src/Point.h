@@ -46,6 +46,8 @@ friend class InfluxDBClient;
     // Adds string tag 
     void addTag(const String &name, String value);
     // Add field with various types
+    // Add float field with decimalPlaces digits after decimal point, same digits as String(value, decimalPlaces).
+    // NaN and infinity are not valid line protocol and are skipped, numbers longer than 32 characters are written in scientific notation
     void addField(const String &name, float value, int decimalPlaces = 2);
     void addField(const String &name, double value, int decimalPlaces = 2);
     void addField(const String &name, char value);
@@ -60,13 +62,21 @@ friend class InfluxDBClient;
     void addField(const String &name, long long value);
     void addField(const String &name, unsigned long long value);
     void addField(const String &name, const char *value);
+    // Add float field given as integer with implied decimal scale, e.g. (2150, 2) for 21.50 or (2929, 3) for 2.929,
+    // with decimalPlaces digits after decimal point. Output equals addField(name, value / 10^scale, decimalPlaces),
+    // but is formatted with integer arithmetic, except for ties of dropped digits and numbers of more than 15 digits
+    void addScaledField(const String &name, long long value, uint8_t scale, int decimalPlaces = 2);
     // Set timestamp to `now()` and store it in specified precision, nanoseconds by default. Date and time must be already set. See `configTime` in the device API
     void setTime(WritePrecision writePrecision = WritePrecision::NS);
     // Set timestamp in offset since epoch (1.1.1970). Correct precision must be set InfluxDBClient::setWriteOptions.
     void setTime(unsigned long long timestamp);
+    // Set timestamp in offset since epoch (1.1.1970) in given precision. It is rescaled to the precision set by InfluxDBClient::setWriteOptions when written.
+    void setTime(unsigned long long timestamp, WritePrecision precision);
     // Set timestamp in offset since epoch (1.1.1970 00:00:00). Correct precision must be set InfluxDBClient::setWriteOptions.
+    // Empty string removes timestamp. A string other than a non-negative decimal integer is ignored.
     void setTime(const String &timestamp);
     // Set timestamp in offset since epoch (1.1.1970 00:00:00). Correct precision must be set InfluxDBClient::setWriteOptions.
+    // Empty string removes timestamp. A string other than a non-negative decimal integer is ignored.
     void setTime(const char *timestamp);
     // Clear all fields. Usefull for reusing point  
     void clearFields();
@@ -77,11 +87,14 @@ friend class InfluxDBClient;
     // True if a point contains at least one tag
     bool hasTags() const   { return _data->tags.length() > 0; }
     // True if a point contains timestamp
-    bool hasTime() const   { return strLen(_data->timestamp) > 0; }
+    bool hasTime() const   { return _data->hasTimestamp; }
     // Creates line protocol with optionally added tags
     String toLineProtocol(const String &includeTags = "") const;
+    // Writes line protocol with optionally added tags into buffer, without allocating memory.
+    // Returns line length. If it is not less than size, line was truncated and a bigger buffer is needed.
+    size_t toLineProtocol(char *buffer, size_t size, const String &includeTags = "") const;
     // returns current timestamp
-    String getTime() const { return _data->timestamp; } 
+    String getTime() const;
   protected:
     class Data {
       public:
@@ -90,16 +103,21 @@ friend class InfluxDBClient;
         char *measurement;
         String tags;
         String fields;
-        char *timestamp;
+        unsigned long long timestamp;
+        bool hasTimestamp;
+        // Precision of timestamp, NoTime if not known
         WritePrecision tsWritePrecision;
     };
     std::shared_ptr<Data> _data;
   protected:    
     // method for formating field into line protocol
     void putField(const String &name, const String &value);
-    // set timestamp
-    void setTime(char *timestamp);
+    void putField(const String &name, const char *value, size_t length);
+    // Changes precision of timestamp, if it is known
+    void rescaleTime(WritePrecision precision);
     // Creates line protocol string
     String createLineProtocol(const String &incTags, bool excludeTimestamp = false) const;
+    // Writes line protocol into buffer, returns line length
+    size_t writeLineProtocol(char *buffer, size_t size, const String &incTags, bool excludeTimestamp = false) const;
 };
 #endif //_POINT_H_
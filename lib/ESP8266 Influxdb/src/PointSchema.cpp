@@ -0,0 +1,91 @@
+/**
+ *
+ * PointSchema.cpp: Precompiled line protocol shape of fixed measurements
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "PointSchema.h"
+#include <new>
+
+PointSchemaBase::PointSchemaBase(const char *measurement, const char *const *tagKeys, uint8_t tagCount, const SchemaField *fields, uint8_t fieldCount, SchemaField *fieldStorage, uint16_t *ends):
+    _ends(ends), _fields(fieldStorage), _tagCount(tagCount), _fieldCount(fieldCount) {
+    size_t length = LineProtocolWriter::escapeKey(nullptr, measurement, false);
+    for(uint8_t i = 0; i < tagCount; i++) {
+        length += 2 + LineProtocolWriter::escapeKey(nullptr, tagKeys[i]);
+    }
+    for(uint8_t i = 0; i < fieldCount; i++) {
+        length += 2 + LineProtocolWriter::escapeKey(nullptr, fields[i].key);
+        _fields[i] = fields[i];
+    }
+    _text = new (std::nothrow) char[length];
+    if(!_text) {
+        return;
+    }
+    size_t n = LineProtocolWriter::escapeKey(_text, measurement, false);
+    _ends[0] = n;
+    for(uint8_t i = 0; i < tagCount; i++) {
+        _text[n++] = ',';
+        n += LineProtocolWriter::escapeKey(_text + n, tagKeys[i]);
+        _text[n++] = '=';
+        _ends[1 + i] = n;
+    }
+    for(uint8_t i = 0; i < fieldCount; i++) {
+        _text[n++] = i ? ',' : ' ';
+        n += LineProtocolWriter::escapeKey(_text + n, fields[i].key);
+        _text[n++] = '=';
+        _ends[1 + tagCount + i] = n;
+    }
+}
+
+PointSchemaBase::~PointSchemaBase() {
+    delete [] _text;
+}
+
+size_t PointSchemaBase::toLineProtocol(char *buffer, size_t size, const char *const *tagValues, const long long *values, unsigned long long timestamp) const {
+    LineProtocolWriter writer(buffer, size);
+    if(!_text) {
+        return 0;
+    }
+    writer.raw(_text, _ends[0]);
+    for(uint8_t i = 0; i < _tagCount; i++) {
+        if(tagValues[i] && *tagValues[i]) {
+            writer.raw(_text + _ends[i], _ends[1 + i] - _ends[i]).escaped(tagValues[i]);
+        }
+    }
+    char num[LineProtocolWriter::MaxNumberLength];
+    for(uint8_t i = 0; i < _fieldCount; i++) {
+        uint8_t segment = 1 + _tagCount + i;
+        writer.raw(_text + _ends[segment - 1], _ends[segment] - _ends[segment - 1]);
+        const SchemaField &field = _fields[i];
+        size_t n;
+        if(field.isInteger) {
+            n = LineProtocolWriter::formatInteger(num, values[i]);
+            num[n++] = 'i';
+        } else {
+            n = LineProtocolWriter::formatScaled(num, values[i], field.scale, field.decimalPlaces);
+        }
+        writer.raw(num, n);
+    }
+    if(timestamp) {
+        writer.timestamp(timestamp);
+    }
+    return writer.length();
+}
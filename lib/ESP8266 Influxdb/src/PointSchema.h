@@ -0,0 +1,117 @@
+/**
+ *
+ * PointSchema.h: Precompiled line protocol shape of fixed measurements
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _POINT_SCHEMA_H_
+#define _POINT_SCHEMA_H_
+
+#include "LineProtocolWriter.h"
+
+/**
+ * Field of a PointSchema. Values are integers, float fields have an implied decimal scale.
+ */
+struct SchemaField {
+    const char *key;
+    // Decimal places implied in the value, e.g. 2 for temperature x 100
+    uint8_t scale;
+    // Decimal places written for float field
+    uint8_t decimalPlaces;
+    // Written as integer, with 'i' suffix
+    bool isInteger;
+
+    // Integer field
+    static constexpr SchemaField integer(const char *key) { return SchemaField{key, 0, 0, true}; }
+    // Float field from scaled integer value, e.g. scaled("voltage", 3) for value in mV
+    static constexpr SchemaField scaled(const char *key, uint8_t scale, uint8_t decimalPlaces = 2) {
+        return SchemaField{key, scale, decimalPlaces, false};
+    }
+};
+
+/**
+ * Capacity independent part of PointSchema.
+ * Holds measurement, tag keys and field keys escaped once, with separators, in a single allocation.
+ */
+class PointSchemaBase {
+  public:
+    ~PointSchemaBase();
+    PointSchemaBase(const PointSchemaBase &) = delete;
+    PointSchemaBase& operator=(const PointSchemaBase &) = delete;
+    // Returns false if there was not enough memory for the escaped names
+    bool isValid() const { return _text != nullptr; }
+    // Writes line into buffer.
+    // tagValues - tag values in schema order, tags with null or empty value are omitted
+    // values - field values in schema order
+    // timestamp - 0 for no timestamp
+    // Returns line length. If it is not less than size, line is truncated
+    size_t toLineProtocol(char *buffer, size_t size, const char *const *tagValues, const long long *values, unsigned long long timestamp) const;
+  protected:
+    PointSchemaBase(const char *measurement, const char *const *tagKeys, uint8_t tagCount, const SchemaField *fields, uint8_t fieldCount, SchemaField *fieldStorage, uint16_t *ends);
+  private:
+    // Escaped measurement, then ",tag=" for each tag, then " field=" and ",field=" for each field
+    char *_text;
+    // End of each segment in _text
+    uint16_t *_ends;
+    SchemaField *_fields;
+    uint8_t _tagCount;
+    uint8_t _fieldCount;
+};
+
+/**
+ * Storage of PointSchema filled in by PointSchemaBase. It is a base class listed before PointSchemaBase,
+ * so it is constructed before PointSchemaBase constructor writes into it.
+ */
+template<uint8_t NTags, uint8_t NFields>
+struct PointSchemaStorage {
+    SchemaField _fieldStorage[NFields];
+    uint16_t _endStorage[1 + NTags + NFields];
+};
+
+/**
+ * PointSchema formats points with the same measurement, tag keys and field keys, e.g. readings of
+ * a sensor type, with names escaped only once. Writing a point then copies cached text and formats
+ * the numbers, without Point's per point strings.
+ * Default tags of the client write options are not added to the line.
+ * Example:
+ *   const char *const tagKeys[] = {"device"};
+ *   const SchemaField fields[] = {SchemaField::scaled("temperature", 2), SchemaField::integer("rssi")};
+ *   PointSchema<1, 2> schema("environment", tagKeys, fields);
+ *   const char *tags[] = {"esp32"};
+ *   char buff[128];
+ *   size_t len = schema.toLineProtocol(buff, sizeof(buff), tags, {2150, -70}, 1711390037);
+ *   if(len < sizeof(buff)) client.writeRecord(buff, len);
+ * writes "environment,device=esp32 temperature=21.50,rssi=-70i 1711390037"
+ */
+template<uint8_t NTags, uint8_t NFields>
+class PointSchema : private PointSchemaStorage<NTags, NFields>, public PointSchemaBase {
+  static_assert(NFields > 0, "Line protocol requires at least one field");
+  public:
+    // tagKeys - NTags tag keys, may be nullptr if there are no tags
+    // fields - NFields field definitions
+    PointSchema(const char *measurement, const char *const *tagKeys, const SchemaField (&fields)[NFields]):
+        PointSchemaBase(measurement, tagKeys, NTags, fields, NFields, this->_fieldStorage, this->_endStorage) {}
+    size_t toLineProtocol(char *buffer, size_t size, const char *const *tagValues, const long long (&values)[NFields], unsigned long long timestamp = 0) const {
+        return PointSchemaBase::toLineProtocol(buffer, size, tagValues, values, timestamp);
+    }
+};
+
+#endif //_POINT_SCHEMA_H_
@@ -0,0 +1,514 @@
+/**
+ *
+ * PosixHTTPTransport.cpp: HTTP transport over BSD sockets
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "PosixHTTPTransport.h"
+
+#if !defined(ESP8266)
+
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "util/debug.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+bool SocketStream::fill(bool wait) {
+  if(_fd < 0) {
+    return false;
+  }
+  int r = recv(_fd, _buffer, sizeof(_buffer), wait ? 0 : MSG_DONTWAIT);
+  if(r > 0) {
+    _pos = 0;
+    _len = r;
+    return true;
+  }
+  // timeout or no data yet is not an error
+  if(r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+    _closed = true;
+  }
+  return false;
+}
+
+bool SocketStream::readLine(String &line) {
+  line = "";
+  for(;;) {
+    if(_pos == _len && !fill()) {
+      return false;
+    }
+    uint8_t *start = _buffer + _pos;
+    uint8_t *end = (uint8_t *)memchr(start, '\n', _len - _pos);
+    size_t n = (end ? end : _buffer + _len) - start;
+    line.concat((const char *)start, n);
+    _pos += n;
+    if(end) {
+      _pos++;
+      if(line.length() > 0 && line.charAt(line.length() - 1) == '\r') {
+        line.remove(line.length() - 1);
+      }
+      return true;
+    }
+  }
+}
+
+int SocketStream::available() {
+  if(_pos == _len) {
+    fill(false);
+  }
+  return _len - _pos;
+}
+
+int SocketStream::read() {
+  if(_pos == _len && !fill()) {
+    return -1;
+  }
+  return _buffer[_pos++];
+}
+
+int SocketStream::peek() {
+  if(_pos == _len && !fill()) {
+    return -1;
+  }
+  return _buffer[_pos];
+}
+
+size_t SocketStream::readBytes(char *buffer, size_t length) {
+  size_t read = 0;
+  while(read < length) {
+    if(_pos == _len && !fill()) {
+      break;
+    }
+    size_t n = _len - _pos;
+    if(n > length - read) {
+      n = length - read;
+    }
+    memcpy(buffer + read, _buffer + _pos, n);
+    _pos += n;
+    read += n;
+  }
+  return read;
+}
+
+size_t SocketStream::write(const uint8_t *data, size_t length) {
+  size_t sent = 0;
+  while(_fd >= 0 && sent < length) {
+    int r = send(_fd, data + sent, length - sent, MSG_NOSIGNAL);
+    if(r <= 0) {
+      _closed = true;
+      break;
+    }
+    sent += r;
+  }
+  return sent;
+}
+
+PosixHTTPTransport::PosixHTTPTransport() {
+}
+
+PosixHTTPTransport::~PosixHTTPTransport() {
+  stop();
+}
+
+bool PosixHTTPTransport::begin(const String &url) {
+  if(url != _url) {
+    if(!url.startsWith("http://")) {
+      INFLUXDB_CLIENT_DEBUG("[E] PosixHTTPTransport supports only http: %s\n", url.c_str());
+      return false;
+    }
+    _url = url;
+    int hostStart = 7;
+    int pathStart = url.indexOf('/', hostStart);
+    String hostPort = pathStart < 0 ? url.substring(hostStart) : url.substring(hostStart, pathStart);
+    _path = pathStart < 0 ? String("/") : url.substring(pathStart);
+    int colon = hostPort.indexOf(':');
+    if(colon >= 0) {
+      _host = hostPort.substring(0, colon);
+      _port = hostPort.substring(colon + 1).toInt();
+    } else {
+      _host = hostPort;
+      _port = 80;
+    }
+  }
+  if(_fd >= 0 && (_host != _connectedHost || _port != _connectedPort)) {
+    stop();
+  }
+  _requestHeaders = "";
+  for(uint8_t i = 0; i < _headerCount; i++) {
+    _headerValues[i] = "";
+  }
+  _size = -1;
+  _chunked = false;
+  _keepAlive = false;
+  _responseRead = false;
+  return _host.length() > 0 && _port > 0;
+}
+
+void PosixHTTPTransport::addHeader(const String &name, const String &value) {
+  _requestHeaders += name;
+  _requestHeaders += F(": ");
+  _requestHeaders += value;
+  _requestHeaders += F("\r\n");
+}
+
+void PosixHTTPTransport::collectHeaders(const char *keys[], size_t count) {
+  _headerCount = count < MaxHeaders ? count : MaxHeaders;
+  for(uint8_t i = 0; i < _headerCount; i++) {
+    _headerKeys[i] = keys[i];
+    _headerValues[i] = "";
+  }
+}
+
+bool PosixHTTPTransport::hasHeader(const char *name) {
+  for(uint8_t i = 0; i < _headerCount; i++) {
+    if(strcasecmp(_headerKeys[i], name) == 0) {
+      return _headerValues[i].length() > 0;
+    }
+  }
+  return false;
+}
+
+String PosixHTTPTransport::header(const char *name) {
+  for(uint8_t i = 0; i < _headerCount; i++) {
+    if(strcasecmp(_headerKeys[i], name) == 0) {
+      return _headerValues[i];
+    }
+  }
+  return String();
+}
+
+bool PosixHTTPTransport::connected() {
+  if(_fd < 0) {
+    return false;
+  }
+  // peer may have closed a kept open connection meanwhile
+  return _stream.available() > 0 || !_stream.isClosed();
+}
+
+bool PosixHTTPTransport::connect() {
+  stop();
+  struct addrinfo hints, *res;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  char port[6];
+  snprintf(port, sizeof(port), "%u", _port);
+  if(getaddrinfo(_host.c_str(), port, &hints, &res) != 0) {
+    INFLUXDB_CLIENT_DEBUG("[E] Cannot resolve %s\n", _host.c_str());
+    return false;
+  }
+  for(struct addrinfo *ai = res; ai && _fd < 0; ai = ai->ai_next) {
+    int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if(fd < 0) {
+      continue;
+    }
+    struct timeval tv;
+    tv.tv_sec = _timeout / 1000;
+    tv.tv_usec = (_timeout % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    // request head and body are sent by separate calls
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+    // no MSG_NOSIGNAL on macOS, writing to a socket closed by server must not raise SIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    if(::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      _fd = fd;
+    } else {
+      close(fd);
+    }
+  }
+  freeaddrinfo(res);
+  if(_fd < 0) {
+    return false;
+  }
+  _stream.setSocket(_fd);
+  _connectedHost = _host;
+  _connectedPort = _port;
+  return true;
+}
+
+bool PosixHTTPTransport::writeAll(const uint8_t *data, size_t length) {
+  return _stream.write(data, length) == length;
+}
+
+/**
+ * Collects request head in a fixed buffer and sends it in as few writes as possible.
+ */
+class HeadWriter {
+  public:
+    HeadWriter(SocketStream &stream):_stream(stream),_length(0),_ok(true) {}
+    void add(const char *text, size_t length) {
+      while(length > 0) {
+        size_t n = sizeof(_buffer) - _length;
+        if(n > length) {
+          n = length;
+        }
+        memcpy(_buffer + _length, text, n);
+        _length += n;
+        text += n;
+        length -= n;
+        if(_length == sizeof(_buffer)) {
+          flush();
+        }
+      }
+    }
+    void add(const char *text) { add(text, strlen(text)); }
+    void add(const String &text) { add(text.c_str(), text.length()); }
+    void add(unsigned long number) {
+      char digits[12];
+      add(digits, snprintf(digits, sizeof(digits), "%lu", number));
+    }
+    bool flush() {
+      if(_length > 0) {
+        _ok = _ok && _stream.write(_buffer, _length) == _length;
+        _length = 0;
+      }
+      return _ok;
+    }
+  private:
+    SocketStream &_stream;
+    uint8_t _buffer[256];
+    size_t _length;
+    bool _ok;
+};
+
+int PosixHTTPTransport::sendHeader(const char *method, size_t length) {
+  if(!connected() && !connect()) {
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  HeadWriter head(_stream);
+  head.add(method);
+  head.add(" ", 1);
+  head.add(_path);
+  head.add(" HTTP/1.1\r\nHost: ");
+  head.add(_host);
+  if(_port != 80) {
+    head.add(":", 1);
+    head.add((unsigned long)_port);
+  }
+  head.add("\r\nUser-Agent: ");
+  head.add(_userAgent);
+  head.add(_reuse ? "\r\nConnection: keep-alive" : "\r\nConnection: close");
+  head.add("\r\nContent-Length: ");
+  head.add((unsigned long)length);
+  head.add("\r\n", 2);
+  head.add(_requestHeaders);
+  head.add("\r\n", 2);
+  if(!head.flush()) {
+    stop();
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  return 0;
+}
+
+int PosixHTTPTransport::sendRequest(const char *method, const uint8_t *data, size_t length) {
+  int r = sendHeader(method, length);
+  if(r) {
+    return r;
+  }
+  if(length && !writeAll(data, length)) {
+    stop();
+    return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+  return readResponse();
+}
+
+int PosixHTTPTransport::sendRequest(const char *method, Stream *stream, size_t length) {
+  int r = sendHeader(method, length);
+  if(r) {
+    return r;
+  }
+  uint8_t buffer[512];
+  size_t sent = 0;
+  while(sent < length) {
+    size_t n = stream->readBytes((char *)buffer, length - sent < sizeof(buffer) ? length - sent : sizeof(buffer));
+    if(n == 0 || !writeAll(buffer, n)) {
+      stop();
+      return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+    sent += n;
+  }
+  return readResponse();
+}
+
+// Returns true if header name of length characters is key
+static bool isHeader(const char *name, int length, const char *key) {
+  return (int)strlen(key) == length && strncasecmp(name, key, length) == 0;
+}
+
+int PosixHTTPTransport::readResponse() {
+  String &line = _line;
+  if(!_stream.readLine(line)) {
+    bool closed = _stream.isClosed();
+    stop();
+    return closed ? HTTPC_ERROR_CONNECTION_LOST : HTTPC_ERROR_READ_TIMEOUT;
+  }
+  if(!line.startsWith("HTTP/1.")) {
+    stop();
+    return HTTPC_ERROR_NO_HTTP_SERVER;
+  }
+  // HTTP/1.0 closes connection by default
+  _keepAlive = line.charAt(7) == '1';
+  int code = atoi(line.c_str() + 9);
+  for(;;) {
+    if(!_stream.readLine(line)) {
+      stop();
+      return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    if(line.length() == 0) {
+      break;
+    }
+    int colon = line.indexOf(':');
+    if(colon <= 0) {
+      continue;
+    }
+    const char *name = line.c_str();
+    const char *value = name + colon + 1;
+    while(*value == ' ') {
+      value++;
+    }
+    if(isHeader(name, colon, "Content-Length")) {
+      _size = atoi(value);
+    } else if(isHeader(name, colon, "Transfer-Encoding")) {
+      _chunked = strcasecmp(value, "chunked") == 0;
+    } else if(isHeader(name, colon, "Connection")) {
+      _keepAlive = strcasecmp(value, "close") != 0;
+    }
+    for(uint8_t i = 0; i < _headerCount; i++) {
+      if(isHeader(name, colon, _headerKeys[i])) {
+        _headerValues[i] = value;
+      }
+    }
+  }
+  _responseRead = code == 204 || code == 304 || _size == 0;
+  if(_responseRead) {
+    _size = 0;
+  }
+  return code;
+}
+
+/**
+ * Appends written data to a String.
+ */
+class StringPrint : public Print {
+  public:
+    StringPrint(String &string):_string(string) {}
+    virtual size_t write(uint8_t data) override { _string += (char)data; return 1; }
+    virtual size_t write(const uint8_t *data, size_t length) override { _string.concat((const char *)data, length); return length; }
+  private:
+    String &_string;
+};
+
+int PosixHTTPTransport::readBody(Print &out) {
+  if(_fd < 0) {
+    return HTTPC_ERROR_NOT_CONNECTED;
+  }
+  if(_responseRead) {
+    return 0;
+  }
+  uint8_t buffer[256];
+  int total = 0;
+  if(_chunked) {
+    for(;;) {
+      if(!_stream.readLine(_line)) {
+        return HTTPC_ERROR_READ_TIMEOUT;
+      }
+      size_t chunk = strtoul(_line.c_str(), nullptr, 16);
+      if(chunk == 0) {
+        // trailer ends with empty line
+        while(_stream.readLine(_line) && _line.length() > 0);
+        break;
+      }
+      while(chunk > 0) {
+        size_t n = _stream.readBytes((char *)buffer, chunk < sizeof(buffer) ? chunk : sizeof(buffer));
+        if(n == 0) {
+          return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        out.write(buffer, n);
+        chunk -= n;
+        total += n;
+      }
+      // CRLF after chunk data
+      if(!_stream.readLine(_line)) {
+        return HTTPC_ERROR_READ_TIMEOUT;
+      }
+    }
+  } else if(_size > 0) {
+    while(total < _size) {
+      size_t n = _stream.readBytes((char *)buffer, _size - total < (int)sizeof(buffer) ? _size - total : sizeof(buffer));
+      if(n == 0) {
+        return HTTPC_ERROR_READ_TIMEOUT;
+      }
+      out.write(buffer, n);
+      total += n;
+    }
+  } else {
+    // body ends when server closes connection
+    size_t n;
+    while((n = _stream.readBytes((char *)buffer, sizeof(buffer))) > 0) {
+      out.write(buffer, n);
+      total += n;
+    }
+    _keepAlive = false;
+  }
+  _responseRead = true;
+  return total;
+}
+
+String PosixHTTPTransport::getString() {
+  String body;
+  if(_size > 0) {
+    body.reserve(_size);
+  }
+  StringPrint out(body);
+  readBody(out);
+  return body;
+}
+
+int PosixHTTPTransport::writeToStream(Stream *stream) {
+  return readBody(*stream);
+}
+
+void PosixHTTPTransport::end() {
+  if(!_reuse || !_keepAlive || !_responseRead) {
+    stop();
+  }
+}
+
+void PosixHTTPTransport::stop() {
+  if(_fd >= 0) {
+    close(_fd);
+    _fd = -1;
+  }
+  _stream.setSocket(-1);
+}
+
+#endif //!ESP8266
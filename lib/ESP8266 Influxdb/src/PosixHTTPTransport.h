@@ -0,0 +1,129 @@
+/**
+ *
+ * PosixHTTPTransport.h: HTTP transport over BSD sockets
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _POSIX_HTTP_TRANSPORT_H_
+#define _POSIX_HTTP_TRANSPORT_H_
+
+#if !defined(ESP8266)
+
+#include "HTTPTransport.h"
+
+class Test;
+
+/**
+ * SocketStream reads from and writes to a socket through a small receive buffer.
+ */
+class SocketStream : public Stream {
+  public:
+    SocketStream():_fd(-1) {}
+    void setSocket(int fd) { _fd = fd; _pos = _len = 0; _closed = false; }
+    // Receives data to the empty buffer, waiting at most socket timeout if wait is set.
+    // Returns false if no data arrived or connection was closed
+    bool fill(bool wait = true);
+    // Returns true if peer closed connection or it failed
+    bool isClosed() const { return _closed; }
+    // Reads line without line end, false on timeout or closed connection
+    bool readLine(String &line);
+    // Stream overrides
+    virtual int available() override;
+    virtual int read() override;
+    virtual int peek() override;
+    virtual size_t readBytes(char *buffer, size_t length) override;
+    virtual size_t write(uint8_t data) override { return write(&data, 1); }
+    virtual size_t write(const uint8_t *data, size_t length) override;
+    virtual void flush() override {}
+  private:
+    int _fd;
+    uint8_t _buffer[512];
+    uint16_t _pos = 0;
+    uint16_t _len = 0;
+    bool _closed = false;
+};
+
+/**
+ * PosixHTTPTransport sends HTTP/1.1 requests over a plain TCP socket. It supports only http URLs.
+ * Runs on a host (Linux, macOS) and on ESP32 (lwIP sockets), e.g. to benchmark the client against a local server.
+ */
+class PosixHTTPTransport : public HTTPTransport {
+friend class Test;
+  public:
+    PosixHTTPTransport();
+    virtual ~PosixHTTPTransport();
+    virtual void setOptions(bool reuse, int timeout) override { _reuse = reuse; _timeout = timeout; }
+    virtual void setUserAgent(const String &userAgent) override { _userAgent = userAgent; }
+    virtual bool begin(const String &url) override;
+    virtual void addHeader(const String &name, const String &value) override;
+    virtual void collectHeaders(const char *keys[], size_t count) override;
+    using HTTPTransport::sendRequest;
+    virtual int sendRequest(const char *method, const uint8_t *data, size_t length) override;
+    virtual int sendRequest(const char *method, Stream *stream, size_t length) override;
+    virtual bool hasHeader(const char *name) override;
+    virtual String header(const char *name) override;
+    virtual int getSize() override { return _size; }
+    virtual String getString() override;
+    virtual int writeToStream(Stream *stream) override;
+    virtual Stream *getStreamPtr() override { return _fd >= 0 ? &_stream : nullptr; }
+    virtual bool connected() override;
+    virtual void end() override;
+    virtual void stop() override;
+  private:
+    static const uint8_t MaxHeaders = 4;
+    int _fd = -1;
+    SocketStream _stream;
+    bool _reuse = false;
+    int _timeout = 5000;
+    String _userAgent;
+    // Host and port of the open connection and of the request
+    String _host;
+    uint16_t _port = 0;
+    String _connectedHost;
+    uint16_t _connectedPort = 0;
+    String _path;
+    // Url of last begin(), parsed only when it changes
+    String _url;
+    String _requestHeaders;
+    // Response line being read, kept to reuse its memory
+    String _line;
+    const char *_headerKeys[MaxHeaders];
+    String _headerValues[MaxHeaders];
+    uint8_t _headerCount = 0;
+    int _size = -1;
+    bool _chunked = false;
+    // Server keeps connection open after response
+    bool _keepAlive = false;
+    // Whole response has been read, so connection can be used for next request
+    bool _responseRead = false;
+  private:
+    bool connect();
+    bool writeAll(const uint8_t *data, size_t length);
+    // Sends request line and headers
+    int sendHeader(const char *method, size_t length);
+    // Reads status line and headers. Returns status code or error
+    int readResponse();
+    // Reads body to out. Returns number of bytes read or HTTPC_ERROR_* code
+    int readBody(Print &out);
+};
+
+#endif //!ESP8266
+#endif //_POSIX_HTTP_TRANSPORT_H_
@@ -34,10 +34,6 @@ CsvReader::~CsvReader() {
     delete _scanner;
 }
 
-std::vector<String> CsvReader::getRow() {
-    return _row;
-};
-
 void CsvReader::close() {
     clearRow();
     _scanner->close();
@@ -54,55 +50,74 @@ enum class CsvParsingState {
     QuotedQuote
 };
 
+String &CsvReader::startField(size_t index) {
+    if(index == _row.size()) {
+        _row.push_back(String());
+    } else {
+        _row[index] = "";
+    }
+    return _row[index];
+}
+
 bool CsvReader::next() {
-     clearRow();
      bool status = _scanner->next();
      if(!status) {
+          clearRow();
           _error =  _scanner->getError();
          return false;
      }
-    String line = _scanner->getLine();
+    size_t length;
+    const char *line = _scanner->getLine(length);
+    const char *end = line + length;
     CsvParsingState state = CsvParsingState::UnquotedField;
-    std::vector<String> fields {""};
-    size_t i = 0; // index of the current field
-    for (char c : line) {
+    size_t fields = 0; // number of fields
+    String *field = &startField(fields++);
+    // Characters from span to current position are copied to field at once
+    const char *span = line;
+    for (const char *p = line; p < end; p++) {
+        char c = *p;
         switch (state) {
             case CsvParsingState::UnquotedField:
                 switch (c) {
                     case ',': // end of field
-                              fields.push_back(""); i++;
+                              field->concat(span, p - span);
+                              field = &startField(fields++);
+                              span = p + 1;
                               break;
-                    case '"': state = CsvParsingState::QuotedField;
+                    case '"': field->concat(span, p - span);
+                              span = p + 1;
+                              state = CsvParsingState::QuotedField;
                               break;
-                    default:  fields[i] += c;
-                              break; 
                 }
                 break;
             case CsvParsingState::QuotedField:
                 switch (c) {
-                    case '"': state = CsvParsingState::QuotedQuote;
+                    case '"': field->concat(span, p - span);
+                              span = p + 1;
+                              state = CsvParsingState::QuotedQuote;
                               break;
-                    default:  fields[i] += c;
-                              break; 
                 }
                 break;
             case CsvParsingState::QuotedQuote:
                 switch (c) {
                     case ',': // , after closing quote
-                              fields.push_back(""); i++;
+                              field = &startField(fields++);
+                              span = p + 1;
                               state = CsvParsingState::UnquotedField;
                               break;
-                    case '"': // "" -> "
-                              fields[i] += '"';
+                    case '"': // "" -> ", keep second quote
+                              span = p;
                               state = CsvParsingState::QuotedField;
                               break;
                     default:  // end of quote
+                              span = p + 1;
                               state = CsvParsingState::UnquotedField;
                               break; 
                 }
                 break;
         }
     }
-    _row = fields;
+    field->concat(span, end - span);
+    _row.resize(fields);
     return true;
 }
@@ -40,10 +40,13 @@ public:
     ~CsvReader();
     bool next();
     void close();
-    std::vector<String> getRow();
+    // Returns fields of current row, valid until next call of next()
+    const std::vector<String> &getRow() const { return _row; }
     int getError() const { return _error; };
 private:
     void clearRow();
+    // Returns empty field at index, reusing String of previous row
+    String &startField(size_t index);
     HttpStreamScanner *_scanner = nullptr;
     std::vector<String> _row;
     int _error = 0;
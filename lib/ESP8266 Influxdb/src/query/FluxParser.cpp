@@ -122,12 +122,12 @@ readRow:
     bool stat = _data->_reader->next();
     if(!stat) {
         if(_data->_reader->getError()< 0) {
-            _data->_error = HTTPClient::errorToString(_data->_reader->getError());
+            _data->_error = HTTPTransport::errorToString(_data->_reader->getError());
             INFLUXDB_CLIENT_DEBUG("Error '%s'\n", _data->_error.c_str());
         }
         return false;
     }
-    std::vector<String> vals = _data->_reader->getRow();
+    const std::vector<String> &vals = _data->_reader->getRow();
     INFLUXDB_CLIENT_DEBUG("[D] FluxQueryResult: vals.size %d\n", vals.size());
     if(vals.size() < 2) {
         goto readRow;
@@ -202,7 +202,7 @@ readRow:
 	return true;
 }
 
-FluxDateTime *FluxQueryResult::convertRfc3339(String &value, const char *type) {
+FluxDateTime *FluxQueryResult::convertRfc3339(const String &value, const char *type) {
     tm t = {0,0,0,0,0,0,0,0,0};
     // has the time part
     int zet = value.indexOf('Z');
@@ -240,7 +240,7 @@ FluxDateTime *FluxQueryResult::convertRfc3339(String &value, const char *type) {
     return new FluxDateTime(value, type, t, fracts);
 }
 
-FluxBase *FluxQueryResult::convertValue(String &value, String &dataType) {
+FluxBase *FluxQueryResult::convertValue(const String &value, String &dataType) {
     FluxBase *ret = nullptr;
     if(dataType.equals(FluxDatatypeDatetimeRFC3339) || dataType.equals(FluxDatatypeDatetimeRFC3339Nano)) {
         const char *type = FluxDatatypeDatetimeRFC3339;
@@ -25,80 +25,224 @@
  * SOFTWARE.
 */
 #include "HttpStreamScanner.h"
+#include <new>
 
 // Uncomment bellow in case of a problem and rebuild sketch
 //#define INFLUXDB_CLIENT_DEBUG_ENABLE
 #include "util/debug.h"
 #include "util/helpers.h"
 
-HttpStreamScanner::HttpStreamScanner(HTTPClient *client, bool chunked)
+HttpStreamScanner::HttpStreamScanner(HTTPTransport *client, bool chunked, size_t maxLineLength)
 {
     _client = client;
+    _maxLineLength = maxLineLength;
     _stream = client->getStreamPtr();
     _chunked = chunked;
-    _chunkHeader = chunked;
     _len = client->getSize();
+    _buffer[0] = 0;
     INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner: chunked: %s, size: %d\n", bool2string(_chunked), _len);
 }
 
+HttpStreamScanner::~HttpStreamScanner() {
+    if(_buffer != _fixedBuffer) {
+        delete [] _buffer;
+    }
+}
+
 bool HttpStreamScanner::next() {
-    while(_client->connected() && (_len > 0 || _len == -1)) {
-        _line = _stream->readStringUntil('\n');
-        INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner: line: %s\n", _line.c_str());
+    for(;;) {
+        char *end = (char *)memchr(_buffer + _scanned, '\n', _end - _scanned);
+        size_t next;
+        if(end) {
+            next = end - _buffer + 1;
+        } else if(fill()) {
+            continue;
+        } else {
+            if(_error || _start == _end) {
+                return false;
+            }
+            // last line without line terminator
+            end = _buffer + _end;
+            next = _end;
+        }
+        // fill() moves unread data to the beginning of buffer, so line start is known only now
+        char *start = _buffer + _start;
+        _start = _scanned = next;
+        if(end > start && *(end - 1) == '\r') {
+            end--;
+        }
+        *end = 0;
+        _line = start;
+        _lineLength = end - start;
         ++_linesNum;
-        int lineLen = _line.length();
-        if(lineLen == 0) {
-            _error = HTTPC_ERROR_READ_TIMEOUT;
+        INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner: line: %s\n", _line);
+        return true;
+    }
+}
+
+bool HttpStreamScanner::fill() {
+    _scanned = _end;
+    // move unread data to the beginning to make space
+    if(_start > 0) {
+        memmove(_buffer, _buffer + _start, _end - _start);
+        _end -= _start;
+        _scanned -= _start;
+        _start = 0;
+    }
+    if(_buffer != _fixedBuffer && _end < BufferSize) {
+        shrink();
+    }
+    if(!_stream) {
+        _error = HTTPC_ERROR_NO_STREAM;
+        return false;
+    }
+    for(;;) {
+        if(_chunked ? _chunkState == ChunkState::Done : _len == 0) {
+            return false;
+        }
+        if(_end == _capacity && !grow()) {
+            INFLUXDB_CLIENT_DEBUG("[E] HttpStreamScanner: line longer than %u\n", (unsigned)_capacity);
+            _error = HTTPC_ERROR_TOO_LESS_RAM;
             return false;
-        } 
-        int r = lineLen +1; //+1 for terminating \n
-        _line.trim(); //remove \r
-        if(!_chunked || !_chunkHeader) {
-            _read += r;
-            if(_lastChunkLine.length() > 0) { //fix broken line
-                _line = _lastChunkLine + _line;
-                _lastChunkLine = "";
+        }
+        size_t len = _capacity - _end;
+        // never read beyond the body, connection may be kept open for next request
+        if(_chunked) {
+            // chunk data is followed by CRLF, other parts are read byte by byte
+            size_t max = _chunkState == ChunkState::Data ? _chunkLen + 2 : 1;
+            if(len > max) {
+                len = max;
             }
-        
-        } 
-        if(_chunkHeader && r == 2) { //empty line at the end of chunk
-            //last line was complete so return
-            _line  = _lastChunkLine;
-            _lastChunkLine = "";
-            return true;
+        } else if(_len > 0 && len > (size_t)_len) {
+            len = _len;
         }
-        if(_chunkHeader){
-            _chunkLen = (int) strtol((const char *) _line.c_str(), NULL, 16);
-            INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner chunk len: %d\n", _chunkLen);
-            _chunkHeader = false;
-            _read = 0;
-            if(_chunkLen == 0) { //last chunk
-                _error = 0;
-                _line = "";
+        int avail;
+        uint32_t waitStart = millis();
+        while((avail = _stream->available()) <= 0) {
+            if(!_client->connected()) {
+                if(_chunked || _len > 0) {
+                    INFLUXDB_CLIENT_DEBUG("[E] HttpStreamScanner: connection lost\n");
+                    _error = HTTPC_ERROR_CONNECTION_LOST;
+                }
                 return false;
-            } else {
-                continue;
             }
-        } else if(_chunked && _read >= _chunkLen){ //we reached end of chunk. 
-            _lastChunkLine = _line;
-            _chunkHeader = true;
-            continue;
+            if(millis() - waitStart > _stream->getTimeout()) {
+                _error = HTTPC_ERROR_READ_TIMEOUT;
+                return false;
+            }
+            delay(1);
+        }
+        if(len > (size_t)avail) {
+            len = avail;
         }
-        
+        size_t read = _stream->readBytes(_buffer + _end, len);
         if(_len > 0) {
-            _len -= r;
-            INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner new len: %d\n", _len);
+            _len -= read;
         }
-        return true;
+        if(_chunked) {
+            read = decodeChunked(_buffer + _end, read);
+        }
+        _end += read;
+        if(read > 0) {
+            return true;
+        }
+    }
+}
+
+bool HttpStreamScanner::grow() {
+    if(_capacity >= _maxLineLength) {
+        return false;
+    }
+    size_t capacity = _capacity * 2;
+    if(capacity > _maxLineLength) {
+        capacity = _maxLineLength;
     }
-    if(!_client->connected() && ( (_chunked && _chunkLen > 0) || (!_chunked && _len > 0))) { //report error only if we didn't went to 
-        _error = HTTPC_ERROR_CONNECTION_LOST;
-        INFLUXDB_CLIENT_DEBUG("HttpStreamScanner connection lost\n");
-    } 
-    return false;
+    char *buffer = new (std::nothrow) char[capacity + 1];
+    if(!buffer) {
+        return false;
+    }
+    INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner: line buffer %u\n", (unsigned)capacity);
+    memcpy(buffer, _buffer, _end);
+    if(_buffer != _fixedBuffer) {
+        delete [] _buffer;
+    }
+    _buffer = buffer;
+    _capacity = capacity;
+    return true;
+}
+
+void HttpStreamScanner::shrink() {
+    memcpy(_fixedBuffer, _buffer, _end);
+    delete [] _buffer;
+    _buffer = _fixedBuffer;
+    _capacity = BufferSize;
+}
+
+size_t HttpStreamScanner::decodeChunked(char *data, size_t length) {
+    char *start = data;
+    char *out = data;
+    char *end = data + length;
+    while(data < end) {
+        char c = *data;
+        switch(_chunkState) {
+            case ChunkState::Size:
+                if(isxdigit(c)) {
+                    _chunkLen = (_chunkLen << 4) | (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+                } else if(c == '\n') {
+                    INFLUXDB_CLIENT_DEBUG("[D] HttpStreamScanner chunk len: %d\n", _chunkLen);
+                    _chunkState = _chunkLen > 0 ? ChunkState::Data : ChunkState::Trailer;
+                } else if(c != '\r') {
+                    _chunkState = ChunkState::Extension;
+                }
+                data++;
+                break;
+            case ChunkState::Extension:
+                if(c == '\n') {
+                    _chunkState = _chunkLen > 0 ? ChunkState::Data : ChunkState::Trailer;
+                }
+                data++;
+                break;
+            case ChunkState::Data: {
+                size_t n = end - data;
+                if(n > _chunkLen) {
+                    n = _chunkLen;
+                }
+                memmove(out, data, n);
+                out += n;
+                data += n;
+                _chunkLen -= n;
+                if(_chunkLen == 0) {
+                    _chunkState = ChunkState::DataEnd;
+                }
+                break;
+            }
+            case ChunkState::DataEnd:
+                if(c == '\n') {
+                    _chunkState = ChunkState::Size;
+                }
+                data++;
+                break;
+            case ChunkState::Trailer:
+                if(c == '\n') {
+                    _chunkState = ChunkState::Done;
+                } else if(c != '\r') {
+                    _chunkState = ChunkState::TrailerLine;
+                }
+                data++;
+                break;
+            case ChunkState::TrailerLine:
+                if(c == '\n') {
+                    _chunkState = ChunkState::Trailer;
+                }
+                data++;
+                break;
+            case ChunkState::Done:
+                return out - start;
+        }
+    }
+    return out - start;
 }
 
 void HttpStreamScanner::close() {
     _client->end();
 }
-
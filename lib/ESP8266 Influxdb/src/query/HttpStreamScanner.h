@@ -27,37 +27,71 @@
 #ifndef _HTTP_STREAM_SCANNER_
 #define _HTTP_STREAM_SCANNER_
 
-#if defined(ESP8266)
-# include <ESP8266HTTPClient.h>
-#elif defined(ESP32)
-# include <HTTPClient.h>
-#endif //ESP8266
+#include "../HTTPTransport.h"
 
 /** 
- * HttpStreamScanner parses response stream from  HTTPClient for lines.
+ * HttpStreamScanner parses response stream from HTTP transport for lines.
  * By repeatedly calling next() it searches for new line.
  * If next() returns false, it can mean end of stream or an error.
  * Check getError() for nonzero if an error occured
+ * Data are read in blocks into a fixed buffer, chunked transfer encoding is decoded in place,
+ * and lines are returned as pointers into the buffer. A line longer than the buffer is read into
+ * a heap buffer, doubled as needed up to maxLineLength, and freed once the lines fit again.
  */ 
 class HttpStreamScanner {
 public:
-    HttpStreamScanner(HTTPClient *client, bool chunked);
+    // Size of fixed line buffer, longer lines are read into heap
+    static const uint16_t BufferSize = 1024;
+    // Default limit of line length, longer line stops reading with HTTPC_ERROR_TOO_LESS_RAM
+    static const size_t DefaultMaxLineLength = 16384;
+    HttpStreamScanner(HTTPTransport *client, bool chunked, size_t maxLineLength = DefaultMaxLineLength);
+    ~HttpStreamScanner();
     bool next();
     void close();
-    const String &getLine() const { return _line; }
+    // Returns current line without line terminator, valid until next call of next()
+    const char *getLine(size_t &length) const { length = _lineLength; return _line; }
     int getError() const { return _error; }
     int getLinesNum() const {return _linesNum; }
 private:
-    HTTPClient *_client;
+    enum class ChunkState : uint8_t {
+        Size,
+        Extension,
+        Data,
+        DataEnd,
+        Trailer,
+        TrailerLine,
+        Done
+    };
+    // Reads more data into buffer. Returns false at the end of body or on error
+    bool fill();
+    // Decodes chunked encoding of data in place, returns decoded length
+    size_t decodeChunked(char *data, size_t length);
+    // Moves data to a twice larger heap buffer. Returns false if the limit is reached or allocation fails
+    bool grow();
+    // Moves data back to the fixed buffer, when it fits there
+    void shrink();
+    HTTPTransport *_client;
     Stream *_stream = nullptr;
+    // Remaining body length, -1 if not known
     int _len;
-    String _line;
+    // Fixed buffer, +1 for terminating the last line
+    char _fixedBuffer[BufferSize + 1];
+    // Buffered body data, either the fixed buffer or a heap one of _capacity + 1 bytes
+    char *_buffer = _fixedBuffer;
+    size_t _capacity = BufferSize;
+    size_t _maxLineLength;
+    // Start and end of data not yet returned
+    size_t _start = 0;
+    size_t _end = 0;
+    // Position up to which line end was already searched
+    size_t _scanned = 0;
+    const char *_line = _buffer;
+    size_t _lineLength = 0;
     int _linesNum= 0;
-    int _read = 0;
     bool _chunked;
-    bool _chunkHeader;
-    int _chunkLen = 0;
-    String _lastChunkLine;
+    ChunkState _chunkState = ChunkState::Size;
+    // Remaining length of current chunk
+    uint32_t _chunkLen = 0;
     int _error = 0;
 };
 
@@ -0,0 +1,201 @@
+/**
+ *
+ * FlashLog.cpp: Append-only log of batches in a flash partition
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "FlashLog.h"
+#include <stddef.h>
+
+// "IFXL"
+static const uint32_t SectorMagic = 0x4C584649;
+
+#if defined(ESP32)
+PartitionFlashRegion::PartitionFlashRegion(const char *label):_label(label) {
+}
+
+bool PartitionFlashRegion::begin() {
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, _label);
+    return _partition != nullptr;
+}
+
+uint32_t PartitionFlashRegion::size() const {
+    return _partition ? _partition->size & ~(SectorSize - 1) : 0;
+}
+
+bool PartitionFlashRegion::read(uint32_t offset, void *buffer, size_t length) {
+    return _partition && esp_partition_read(_partition, offset, buffer, length) == ESP_OK;
+}
+
+bool PartitionFlashRegion::write(uint32_t offset, const void *data, size_t length) {
+    return _partition && esp_partition_write(_partition, offset, data, length) == ESP_OK;
+}
+
+bool PartitionFlashRegion::erase(uint32_t offset) {
+    return _partition && esp_partition_erase_range(_partition, offset, SectorSize) == ESP_OK;
+}
+#endif
+
+FlashLog::FlashLog(FlashRegion &flash):_flash(flash) {
+}
+
+bool FlashLog::begin() {
+    _sectorCount = 0;
+    if(!_flash.begin() || _flash.size() < 2 * FlashRegion::SectorSize) {
+        return false;
+    }
+    _sectorCount = _flash.size() / FlashRegion::SectorSize;
+    _frontLength = 0;
+    // newest sector has the highest sequence
+    bool found = false;
+    SectorHeader header;
+    for(uint16_t i = 0; i < _sectorCount; i++) {
+        if(readSectorHeader(i, header) && (!found || header.sequence > _headSequence)) {
+            found = true;
+            _headSector = i;
+            _headSequence = header.sequence;
+        }
+    }
+    if(!found) {
+        _headSector = _sectorCount - 1;
+        _headSequence = 0;
+    }
+    // Continue in a fresh sector, the rest of the head sector may hold an interrupted write
+    _headOffset = FlashRegion::SectorSize;
+    // oldest sector is the first one of the sequence ending at head
+    _tailSector = _headSector;
+    if(found) {
+        for(uint16_t i = 1; i < _sectorCount; i++) {
+            uint16_t prev = (_headSector + _sectorCount - i) % _sectorCount;
+            if(!readSectorHeader(prev, header) || header.sequence != _headSequence - i) {
+                break;
+            }
+            _tailSector = prev;
+        }
+        _tailOffset = sizeof(SectorHeader);
+    } else {
+        _tailOffset = _headOffset;
+    }
+    return true;
+}
+
+bool FlashLog::readSectorHeader(uint16_t sector, SectorHeader &header) {
+    return _flash.read(sectorOffset(sector), &header, sizeof(header)) && header.magic == SectorMagic;
+}
+
+bool FlashLog::readRecordHeader(uint16_t sector, uint32_t offset, RecordHeader &header) {
+    if(offset + sizeof(RecordHeader) > FlashRegion::SectorSize || !_flash.read(sectorOffset(sector) + offset, &header, sizeof(header))) {
+        return false;
+    }
+    // erased or damaged
+    return header.length > 0 && header.length <= maxLength() && offset + recordSize(header.length) <= FlashRegion::SectorSize;
+}
+
+bool FlashLog::seekFront() {
+    if(_frontLength) {
+        return true;
+    }
+    RecordHeader header;
+    while(_tailSector != _headSector || _tailOffset < _headOffset) {
+        if(!readRecordHeader(_tailSector, _tailOffset, header)) {
+            if(_tailSector == _headSector) {
+                _tailOffset = _headOffset;
+                break;
+            }
+            _tailSector = (_tailSector + 1) % _sectorCount;
+            _tailOffset = sizeof(SectorHeader);
+            continue;
+        }
+        if(header.state == Committed) {
+            _frontLength = header.length;
+            return true;
+        }
+        // consumed or interrupted write
+        _tailOffset += recordSize(header.length);
+    }
+    return false;
+}
+
+bool FlashLog::nextSector() {
+    uint16_t next = (_headSector + 1) % _sectorCount;
+    if(next == _tailSector && _tailSector != _headSector) {
+        // ring is full, drop the oldest sector
+        RecordHeader header;
+        for(uint32_t offset = _tailOffset; readRecordHeader(_tailSector, offset, header); offset += recordSize(header.length)) {
+            if(header.state == Committed) {
+                _dropped += header.count;
+            }
+        }
+        _tailSector = (next + 1) % _sectorCount;
+        _tailOffset = sizeof(SectorHeader);
+        _frontLength = 0;
+    }
+    SectorHeader sectorHeader = {SectorMagic, _headSequence + 1};
+    if(!_flash.erase(sectorOffset(next)) || !_flash.write(sectorOffset(next), &sectorHeader, sizeof(sectorHeader))) {
+        return false;
+    }
+    _headSector = next;
+    _headSequence++;
+    _headOffset = sizeof(SectorHeader);
+    return true;
+}
+
+bool FlashLog::push(const char *data, size_t length, uint16_t count) {
+    if(!_sectorCount || !length || length > maxLength()) {
+        return false;
+    }
+    uint32_t size = recordSize(length);
+    if(_headOffset + size > FlashRegion::SectorSize && !nextSector()) {
+        return false;
+    }
+    uint32_t offset = sectorOffset(_headSector) + _headOffset;
+    // space is used even if the write fails
+    _headOffset += size;
+    // data is written before the record is committed, so an interrupted write is skipped
+    RecordHeader header = {(uint16_t)length, (uint8_t)(count > 0xFF ? 0xFF : count), Erased};
+    if(!_flash.write(offset, &header, sizeof(header)) || !_flash.write(offset + sizeof(header), data, length)) {
+        return false;
+    }
+    uint8_t state = Committed;
+    return _flash.write(offset + offsetof(RecordHeader, state), &state, 1);
+}
+
+bool FlashLog::isEmpty() {
+    return !seekFront();
+}
+
+size_t FlashLog::frontLength() {
+    return seekFront() ? _frontLength : 0;
+}
+
+bool FlashLog::readFront(char *buffer) {
+    return seekFront() && _flash.read(sectorOffset(_tailSector) + _tailOffset + sizeof(RecordHeader), buffer, _frontLength);
+}
+
+void FlashLog::pop() {
+    if(!seekFront()) {
+        return;
+    }
+    uint8_t state = Consumed;
+    _flash.write(sectorOffset(_tailSector) + _tailOffset + offsetof(RecordHeader, state), &state, 1);
+    _tailOffset += recordSize(_frontLength);
+    _frontLength = 0;
+}
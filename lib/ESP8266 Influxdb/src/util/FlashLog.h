@@ -0,0 +1,135 @@
+/**
+ *
+ * FlashLog.h: Append-only log of batches in a flash partition
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _FLASH_LOG_H_
+#define _FLASH_LOG_H_
+
+#include <Arduino.h>
+#include "../BatchStore.h"
+
+/**
+ * FlashRegion provides raw access to a NOR flash area. Erase sets all bits of a sector to 1, write can only clear bits.
+ */
+class FlashRegion {
+  public:
+    static const uint32_t SectorSize = 4096;
+    virtual ~FlashRegion() {}
+    // Prepares region for use. Returns false if it is not available
+    virtual bool begin() { return true; }
+    // Returns region size in bytes, multiple of SectorSize
+    virtual uint32_t size() const = 0;
+    virtual bool read(uint32_t offset, void *buffer, size_t length) = 0;
+    virtual bool write(uint32_t offset, const void *data, size_t length) = 0;
+    // Erases sector starting at offset
+    virtual bool erase(uint32_t offset) = 0;
+};
+
+#if defined(ESP32)
+#include <esp_partition.h>
+/**
+ * FlashRegion backed by a data partition, e.g. the "spiffs" partition when no file system is used.
+ */
+class PartitionFlashRegion : public FlashRegion {
+  public:
+    // label - partition name in the partition table
+    PartitionFlashRegion(const char *label);
+    // Finds partition. Returns false if it does not exist
+    virtual bool begin() override;
+    virtual uint32_t size() const override;
+    virtual bool read(uint32_t offset, void *buffer, size_t length) override;
+    virtual bool write(uint32_t offset, const void *data, size_t length) override;
+    virtual bool erase(uint32_t offset) override;
+  private:
+    const char *_label;
+    const esp_partition_t *_partition = nullptr;
+};
+#endif
+
+/**
+ * FlashLog is a BatchStore keeping batches in flash, so they survive outages longer than the write buffer and restarts.
+ * Sectors are filled in a ring, each starting with a header with increasing sequence number. A batch is a record,
+ * which is committed after its data is written and marked consumed when removed, by clearing bits of its state,
+ * so a sector is erased only once per pass through the ring and wear is spread evenly.
+ * Interrupted writes are skipped when the log is opened. When the ring is full, the oldest sector is dropped.
+ * Only positions are kept in RAM.
+ */
+class FlashLog : public BatchStore {
+  public:
+    FlashLog(FlashRegion &flash);
+    // Scans flash for stored batches. Region must have at least 2 sectors.
+    // Returns false if region cannot be used
+    bool begin();
+    // Returns maximum data length of a batch
+    static size_t maxLength() { return FlashRegion::SectorSize - sizeof(SectorHeader) - sizeof(RecordHeader); }
+    // Returns number of lines dropped because log was full
+    uint32_t getDropped() const { return _dropped; }
+
+    // BatchStore overrides
+    virtual bool push(const char *data, size_t length, uint16_t count) override;
+    virtual bool isEmpty() override;
+    virtual size_t frontLength() override;
+    virtual bool readFront(char *buffer) override;
+    virtual void pop() override;
+  private:
+    struct SectorHeader {
+        uint32_t magic;
+        uint32_t sequence;
+    };
+    struct RecordHeader {
+        uint16_t length;
+        // Number of lines, saturated
+        uint8_t count;
+        uint8_t state;
+    };
+    // Record states, each next one clears bits of the previous one
+    enum RecordState : uint8_t {
+        Erased = 0xFF,
+        Committed = 0x7F,
+        Consumed = 0x3F
+    };
+    FlashRegion &_flash;
+    uint16_t _sectorCount = 0;
+    // Sector written to and offset of next record in it
+    uint16_t _headSector = 0;
+    uint32_t _headSequence = 0;
+    uint32_t _headOffset = 0;
+    // Sector and offset of the oldest record, which may be already consumed
+    uint16_t _tailSector = 0;
+    uint32_t _tailOffset = 0;
+    // Data length of oldest committed record at tail, 0 if not known yet
+    uint16_t _frontLength = 0;
+    uint32_t _dropped = 0;
+  private:
+    static uint32_t recordSize(uint16_t length) { return (sizeof(RecordHeader) + length + 3) & ~3u; }
+    static uint32_t sectorOffset(uint16_t sector) { return (uint32_t)sector * FlashRegion::SectorSize; }
+    bool readSectorHeader(uint16_t sector, SectorHeader &header);
+    // Reads record header at offset in sector. Returns false if there is no record
+    bool readRecordHeader(uint16_t sector, uint32_t offset, RecordHeader &header);
+    // Moves tail to the oldest committed record. Returns false if log is empty
+    bool seekFront();
+    // Starts writing to the next sector, dropping the oldest one if needed
+    bool nextSector();
+};
+
+#endif //_FLASH_LOG_H_
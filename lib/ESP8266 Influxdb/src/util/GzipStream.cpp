@@ -0,0 +1,258 @@
+/**
+ *
+ * GzipStream.cpp: Fixed memory gzip compressor for InfluxDB Client for Arduino
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "GzipStream.h"
+
+// Deflate length codes 257..285: base length and number of extra bits
+static const uint16_t LengthBase[] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+static const uint8_t LengthExtra[] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+// Deflate distance codes 0..23 (up to the window size): base distance and number of extra bits
+static const uint16_t DistanceBase[] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073};
+static const uint8_t DistanceExtra[] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10};
+// CRC-32 (polynomial 0xEDB88320) by nibbles
+static const uint32_t CrcTable[] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static const uint16_t MinMatch = 3;
+static const uint16_t MaxMatch = 258;
+
+GzipStream::GzipStream(const char *data, size_t length):_data((const uint8_t *)data),_dataLength(length) {
+    // counting pass, so the length is known before sending
+    reset();
+    _length = 0;
+    while(encode()) {
+        _length += _pendingEnd;
+        _pendingEnd = 0;
+    }
+    reset();
+}
+
+void GzipStream::reset() {
+    _read = 0;
+    _pos = 0;
+    _stage = Stage::Header;
+    _bits = 0;
+    _bitCount = 0;
+    _pendingStart = 0;
+    _pendingEnd = 0;
+    _crc = 0xFFFFFFFF;
+    memset(_hashTable, 0, sizeof(_hashTable));
+}
+
+int GzipStream::available() {
+    return _length - _read;
+}
+
+int GzipStream::peek() {
+    if(_pendingStart == _pendingEnd) {
+        _pendingStart = _pendingEnd = 0;
+        if(!encode()) {
+            return -1;
+        }
+    }
+    return _pending[_pendingStart];
+}
+
+int GzipStream::read() {
+    int r = peek();
+    if(r >= 0) {
+        ++_pendingStart;
+        ++_read;
+    }
+    return r;
+}
+
+int GzipStream::read(uint8_t* buffer, size_t len) {
+    return readBytes((char *)buffer, len);
+}
+
+size_t GzipStream::readBytes(char* buffer, size_t len) {
+    size_t r = 0;
+    while(r < len && peek() >= 0) {
+        size_t n = _pendingEnd - _pendingStart;
+        if(n > len - r) {
+            n = len - r;
+        }
+        memcpy(buffer + r, _pending + _pendingStart, n);
+        _pendingStart += n;
+        _read += n;
+        r += n;
+    }
+    return r;
+}
+
+size_t GzipStream::write(uint8_t)  {
+    return 0;
+}
+
+bool GzipStream::encode() {
+    switch(_stage) {
+        case Stage::Header: {
+            // magic, deflate, no flags, no mtime, no extra flags, unknown OS
+            static const uint8_t header[] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+            memcpy(_pending, header, sizeof(header));
+            _pendingEnd = sizeof(header);
+            // single final block with fixed Huffman codes
+            putBits(1, 1);
+            putBits(1, 2);
+            _stage = Stage::Body;
+            return true;
+        }
+        case Stage::Body:
+            if(_pos < _dataLength) {
+                uint16_t distance;
+                uint16_t length = findMatch(distance);
+                size_t from = _pos;
+                if(length) {
+                    putMatch(length, distance);
+                    // index skipped positions too, so following lines find their match
+                    for(size_t i = _pos + 1; i < _pos + length; i++) {
+                        insertHash(i);
+                    }
+                    _pos += length;
+                } else {
+                    putLiteral(_data[_pos++]);
+                }
+                updateCrc(from, _pos);
+            } else {
+                // end of block, pad to byte
+                putCode(0, 7);
+                if(_bitCount) {
+                    putBits(0, 8 - _bitCount);
+                }
+                _stage = Stage::Trailer;
+            }
+            return true;
+        case Stage::Trailer: {
+            uint32_t crc = ~_crc;
+            for(int i = 0; i < 4; i++) {
+                putByte(crc >> (8 * i));
+            }
+            for(int i = 0; i < 4; i++) {
+                putByte(_dataLength >> (8 * i));
+            }
+            _stage = Stage::Done;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void GzipStream::putByte(uint8_t b) {
+    _pending[_pendingEnd++] = b;
+}
+
+void GzipStream::putBits(uint32_t value, uint8_t count) {
+    _bits |= value << _bitCount;
+    _bitCount += count;
+    while(_bitCount >= 8) {
+        putByte(_bits);
+        _bits >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+void GzipStream::putCode(uint16_t code, uint8_t length) {
+    uint16_t reversed = 0;
+    for(uint8_t i = 0; i < length; i++) {
+        reversed = (reversed << 1) | (code & 1);
+        code >>= 1;
+    }
+    putBits(reversed, length);
+}
+
+void GzipStream::putLiteral(uint8_t literal) {
+    if(literal < 144) {
+        putCode(0x30 + literal, 8);
+    } else {
+        putCode(0x190 + literal - 144, 9);
+    }
+}
+
+void GzipStream::putMatch(uint16_t length, uint16_t distance) {
+    uint8_t code = sizeof(LengthBase)/sizeof(LengthBase[0]) - 1;
+    while(LengthBase[code] > length) {
+        code--;
+    }
+    uint16_t symbol = 257 + code;
+    if(symbol < 280) {
+        putCode(symbol - 256, 7);
+    } else {
+        putCode(0xc0 + symbol - 280, 8);
+    }
+    putBits(length - LengthBase[code], LengthExtra[code]);
+    code = sizeof(DistanceBase)/sizeof(DistanceBase[0]) - 1;
+    while(DistanceBase[code] > distance) {
+        code--;
+    }
+    putCode(code, 5);
+    putBits(distance - DistanceBase[code], DistanceExtra[code]);
+}
+
+static inline uint16_t hash3(const uint8_t *p, uint8_t bits) {
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - bits);
+}
+
+void GzipStream::insertHash(size_t pos) {
+    if(pos + MinMatch <= _dataLength) {
+        _hashTable[hash3(_data + pos, HashBits)] = pos;
+    }
+}
+
+uint16_t GzipStream::findMatch(uint16_t &distance) {
+    if(_pos + MinMatch > _dataLength) {
+        return 0;
+    }
+    uint16_t &entry = _hashTable[hash3(_data + _pos, HashBits)];
+    // positions are truncated to 16 bits, window is much smaller
+    distance = (uint16_t)(_pos - entry);
+    entry = _pos;
+    if(distance == 0 || distance > WindowSize || distance > _pos) {
+        return 0;
+    }
+    const uint8_t *s = _data + _pos, *m = s - distance;
+    size_t max = _dataLength - _pos;
+    if(max > MaxMatch) {
+        max = MaxMatch;
+    }
+    uint16_t length = 0;
+    while(length < max && s[length] == m[length]) {
+        length++;
+    }
+    return length >= MinMatch ? length : 0;
+}
+
+void GzipStream::updateCrc(size_t from, size_t to) {
+    uint32_t crc = _crc;
+    for(size_t i = from; i < to; i++) {
+        crc ^= _data[i];
+        crc = (crc >> 4) ^ CrcTable[crc & 0x0f];
+        crc = (crc >> 4) ^ CrcTable[crc & 0x0f];
+    }
+    _crc = crc;
+}
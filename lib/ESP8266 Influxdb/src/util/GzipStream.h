@@ -0,0 +1,104 @@
+/**
+ *
+ * GzipStream.h: Fixed memory gzip compressor for InfluxDB Client for Arduino
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _GZIP_STREAM_H_
+#define _GZIP_STREAM_H_
+
+#include <Arduino.h>
+
+/**
+ * GzipStream reads data in memory as gzip (RFC 1952) compressed stream.
+ * Compression uses single deflate block with fixed Huffman codes and greedy LZ77 matching
+ * over a small window. Matches are searched directly in the source data, so memory use
+ * is fixed (~2.1kB) regardless of data size. Compressed output is produced on demand,
+ * as it is read, so it's never held in memory as a whole.
+ * Compressed length is known in advance (see available()), as a counting pass is done in constructor.
+ */
+class GzipStream : public Stream {
+  public:
+    // data - source data, must be valid during the stream lifetime
+    // length - source data length
+    GzipStream(const char *data, size_t length);
+    virtual ~GzipStream() {};
+    // Restarts compression to read from the beginning
+    void reset();
+    // Returns compressed length
+    size_t getLength() const { return _length; }
+
+    // Stream overrides
+    virtual int available() override;
+    virtual int read() override;
+    virtual int read(uint8_t* buffer, size_t len);
+    virtual size_t readBytes(char* buffer, size_t len) override;
+    virtual int peek() override;
+    virtual void flush() override {};
+    virtual size_t write(uint8_t data) override;
+  private:
+    static const uint8_t HashBits = 10;
+    // Maximum distance of a match
+    static const uint16_t WindowSize = 4096;
+    enum class Stage : uint8_t {
+        Header,
+        Body,
+        Trailer,
+        Done
+    };
+    // Source data
+    const uint8_t *_data;
+    size_t _dataLength;
+    // Compressed length
+    size_t _length;
+    // Compressed bytes read
+    size_t _read;
+    // Position in source data
+    size_t _pos;
+    Stage _stage;
+    // Bits not yet forming a whole byte, LSB first
+    uint32_t _bits;
+    uint8_t _bitCount;
+    // Encoded bytes not yet read
+    uint8_t _pending[16];
+    uint8_t _pendingStart;
+    uint8_t _pendingEnd;
+    uint32_t _crc;
+    // Last (truncated) positions of 3 byte sequences by their hash
+    uint16_t _hashTable[1 << HashBits];
+  private:
+    // Encodes next step (header, single token or trailer) into pending buffer.
+    // Returns false when everything has been encoded
+    bool encode();
+    // Adds bits, LSB first
+    void putBits(uint32_t value, uint8_t count);
+    // Adds Huffman code, MSB first
+    void putCode(uint16_t code, uint8_t length);
+    void putByte(uint8_t b);
+    void putLiteral(uint8_t literal);
+    void putMatch(uint16_t length, uint16_t distance);
+    // Returns length of the longest match found for current position, 0 if none
+    uint16_t findMatch(uint16_t &distance);
+    void insertHash(size_t pos);
+    void updateCrc(size_t from, size_t to);
+};
+
+#endif //_GZIP_STREAM_H_
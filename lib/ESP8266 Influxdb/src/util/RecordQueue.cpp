@@ -0,0 +1,92 @@
+/**
+ *
+ * RecordQueue.cpp: Lock-free single producer single consumer queue of variable length records
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#include "RecordQueue.h"
+
+RecordQueue::RecordQueue(size_t capacity):_head(0),_tail(0) {
+  // power of two, so positions stay continuous when the counters overflow
+  _capacity = 2;
+  while(_capacity * 2 <= capacity) {
+    _capacity *= 2;
+  }
+  _buffer = new uint8_t[_capacity];
+}
+
+RecordQueue::~RecordQueue() {
+  delete [] _buffer;
+}
+
+size_t RecordQueue::maxLength() const {
+  // half of the ring, so a record fits into empty queue wherever the ring is skipped
+  size_t max = _capacity / 2 - 2;
+  return max < WrapMarker ? max : WrapMarker - 1;
+}
+
+bool RecordQueue::push(const void *data, size_t length) {
+  if(length > maxLength()) {
+    return false;
+  }
+  size_t size = recordSize(length);
+  uint32_t head = _head.load(std::memory_order_relaxed);
+  uint32_t tail = _tail.load(std::memory_order_acquire);
+  size_t pos = head & (_capacity - 1);
+  // record is never split, rest of the ring is skipped when it does not fit there
+  size_t skip = size > _capacity - pos ? _capacity - pos : 0;
+  if(head - tail + skip + size > _capacity) {
+    return false;
+  }
+  if(skip) {
+    writeLength(pos, WrapMarker);
+    pos = 0;
+  }
+  writeLength(pos, length);
+  memcpy(_buffer + pos + 2, data, length);
+  _head.store(head + skip + size, std::memory_order_release);
+  return true;
+}
+
+const uint8_t *RecordQueue::front(size_t &length) {
+  uint32_t tail = _tail.load(std::memory_order_relaxed);
+  if(tail == _head.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  size_t pos = tail & (_capacity - 1);
+  uint16_t l = readLength(pos);
+  if(l == WrapMarker) {
+    // the record following the marker is published together with it
+    tail += _capacity - pos;
+    _tail.store(tail, std::memory_order_release);
+    pos = 0;
+    l = readLength(pos);
+  }
+  length = l;
+  return _buffer + pos + 2;
+}
+
+void RecordQueue::pop() {
+  size_t length;
+  if(front(length)) {
+    _tail.store(_tail.load(std::memory_order_relaxed) + recordSize(length), std::memory_order_release);
+  }
+}
@@ -0,0 +1,75 @@
+/**
+ *
+ * RecordQueue.h: Lock-free single producer single consumer queue of variable length records
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef _RECORD_QUEUE_H_
+#define _RECORD_QUEUE_H_
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * RecordQueue passes variable length records (e.g. line protocol lines) from one producer task
+ * to one consumer task without locking. Records are stored in a byte ring, each prefixed by its length,
+ * so a record is copied only when pushed and is read in place.
+ * Capacity is rounded down to a power of two, a record takes its length plus 2 bytes, rounded up to even.
+ */
+class RecordQueue {
+  public:
+    // capacity - ring size in bytes
+    RecordQueue(size_t capacity);
+    ~RecordQueue();
+    // Copies record to the queue (producer only). Returns false if there is not enough free space
+    bool push(const void *data, size_t length);
+    // Returns oldest record and its length, nullptr if queue is empty (consumer only).
+    // Record stays valid until pop()
+    const uint8_t *front(size_t &length);
+    // Removes oldest record (consumer only)
+    void pop();
+    bool isEmpty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+    // Returns bytes used by queued records, may be called by any task.
+    // Tail is loaded first, so the difference cannot underflow, and it is clamped if both moved in between
+    size_t used() const {
+      uint32_t tail = _tail.load(std::memory_order_acquire);
+      uint32_t used = _head.load(std::memory_order_acquire) - tail;
+      return used < _capacity ? used : _capacity;
+    }
+    size_t capacity() const { return _capacity; }
+    // Returns maximum length of a record
+    size_t maxLength() const;
+  private:
+    // Length of the record placeholder filling the ring end, when next record does not fit there
+    static const uint16_t WrapMarker = 0xFFFF;
+    uint8_t *_buffer;
+    size_t _capacity;
+    // Bytes written so far, only producer modifies it
+    std::atomic<uint32_t> _head;
+    // Bytes consumed so far, only consumer modifies it
+    std::atomic<uint32_t> _tail;
+  private:
+    static size_t recordSize(size_t length) { return (2 + length + 1) & ~(size_t)1; }
+    uint16_t readLength(size_t pos) const { uint16_t l; memcpy(&l, _buffer + pos, 2); return l; }
+    void writeLength(size_t pos, uint16_t length) { memcpy(_buffer + pos, &length, 2); }
+};
+
+#endif //_RECORD_QUEUE_H_
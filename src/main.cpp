@@ -6,29 +6,95 @@
 #include <ElegantOTA.h>
 #include <ArduinoJson.h>
 #include "ATC_MiThermometer.h"
+#include "SensorHistory.h"
+#include "ChangeFilter.h"
+#include "SeqLock.h"
 #include <InfluxDbClient.h>
 #include <InfluxDbCloud.h>
+#include <PointSchema.h>
+#include <util/FlashLog.h>
+#include <AsyncWriter.h>
 
 #include "build_version.h"
 #include <credentials.h>
 
 #define TZ_INFO "UTC-8"
-#define MAX_BATCH_SIZE 2
-#define WRITE_BUFFER_SIZE 4
+// Batch size adapts to write latency and free heap, up to MAX_BATCH_SIZE
+#define MAX_BATCH_SIZE 20
+// Room for 5 full batches; batches are usually written at the adaptive size, before they are full
+#define WRITE_BUFFER_SIZE 100
+#define MAX_STALENESS_SEC 60 // A reading is uploaded at most this long after it was taken
+// Connection to InfluxDB is kept open to skip the TLS handshake, unless it was idle this long
+#define HTTP_IDLE_TIMEOUT_MS 90000
 #define WRITE_PRECISION WritePrecision::S
 // Declare InfluxDB client instance with preconfigured InfluxCloud certificate
 InfluxDBClient influxDBClient(INFLUXDB_URL, INFLUXDB_ORG, INFLUXDB_BUCKET, INFLUXDB_TOKEN, InfluxDbCloud2CACert);
-// Declare Data point
-Point measurementPoint("thermometer-v2");
+// Line protocol shape of the readings, names are escaped once
+const char *const measurementTags[] = {"device"};
+const SchemaField measurementFields[] = {
+    SchemaField::scaled("temperature", 2),  // x 100°C
+    SchemaField::scaled("humidity", 2),     // x 100%
+    SchemaField::scaled("batt_voltage", 3), // [mV]
+    SchemaField::integer("batt_level"),
+    SchemaField::integer("rssi")
+};
+PointSchema<1, 5> measurementSchema("thermometer-v2", measurementTags, measurementFields);
+#define LINE_BUFFER_SIZE 192 // Line protocol record of a reading
+
+// Batches that would be overwritten in the write buffer during an outage are kept in the unused
+// spiffs partition (448 KB, a few days of readings) and written once the server is reachable again
+PartitionFlashRegion spillFlash("spiffs");
+FlashLog spillLog(spillFlash);
+
+// Readings are written by a separate task, so a slow server never stalls BLE processing in loop()
+#define WRITE_QUEUE_SIZE 4096 // Readings waiting for the writer task, ~30 lines
+AsyncWriter influxWriter(influxDBClient, WRITE_QUEUE_SIZE);
+// Client state copied by the writer task, so GET /metrics reads it untorn
+struct WriterMetrics
+{
+    WriteStats stats;
+    ConnectionStats connection;
+    AdaptiveFlushPolicy flushPolicy;
+    uint32_t storeDropped;
+};
+SeqLock<WriterMetrics> writerMetrics;
 
 JsonDocument versionJSON;
-JsonDocument dataJSON;
-#define BLE_SCAN_TIME_SEC 5 // BLE scan time in seconds
+#define LOOP_DELAY_MS 1000 // Period of processing readings received by the BLE scan
+
+#define MAX_SENSORS 16 // Capacity of the sensor table
+
+// Known sensors' BLE addresses and their readings, shared by BLE scanner, web server and InfluxDB writer
+SensorTable<MAX_SENSORS> sensorTable = {"a4:c1:38:17:35:30", "a4:c1:38:47:00:1c", "a4:c1:38:52:31:ff"};
+// Part of the GET / ETag, the table version starts over at every boot
+uint32_t bootNonce = 0;
+
+#define HISTORY_DEPTH 120        // Samples kept per sensor
+#define HISTORY_INTERVAL_SEC 60  // Minimum time between history samples
+
+// Recent temperature and humidity of each sensor, ~4 bytes per sample
+SensorHistory<MAX_SENSORS, HISTORY_DEPTH> sensorHistory;
 
-// List of known sensors' BLE addresses
-std::vector<std::string> knownBLEAddresses = {"a4:c1:38:17:35:30", "a4:c1:38:47:00:1c", "a4:c1:38:52:31:ff"};
+// Readings are only uploaded if they differ from the last uploaded one by more than these deadbands
+#define DEADBAND_TEMPERATURE 10   // x 100°C
+#define DEADBAND_HUMIDITY 50      // x 100%
+#define DEADBAND_BATT_VOLTAGE 20  // mV
+#define DEADBAND_BATT_LEVEL 1     // %
+#define MAX_SILENCE_SEC 600       // Upload at least every 10 minutes, even if nothing has changed
 
-ATC_MiThermometer miThermometer(knownBLEAddresses);
+ChangeFilter<MAX_SENSORS> changeFilter({DEADBAND_TEMPERATURE, DEADBAND_HUMIDITY, DEADBAND_BATT_VOLTAGE, DEADBAND_BATT_LEVEL, MAX_SILENCE_SEC});
+
+// Upload cost per sensor, reported by GET /metrics
+struct SensorUploadStats
+{
+    uint32_t points;  // points written to the InfluxDB client
+    uint32_t bytes;   // line protocol bytes of these points
+};
+SensorUploadStats sensorUploadStats[MAX_SENSORS] = {};
+// Readings formatted into line protocol by measurementSchema, reported by GET /metrics
+uint32_t pointsGenerated = 0;
+
+ATC_MiThermometer miThermometer(sensorTable);
 AsyncWebServer server(80);
 WiFiMulti wifiMulti;
 
@@ -65,25 +131,216 @@ void onOTAEnd(bool success)
     // <Add your own code here>
 }
 
+// Formats value / 10^decimals without trailing zeros, e.g. (1980, 2) -> "19.8", (5800, 2) -> "58"
+char *formatScaled(char *out, size_t size, int32_t value, int decimals)
+{
+    int32_t divisor = 1;
+    for (int i = 0; i < decimals; i++)
+        divisor *= 10;
+    uint32_t magnitude = value < 0 ? -(int64_t)value : value;
+    uint32_t fraction = magnitude % divisor;
+    int len = snprintf(out, size, "%s%u", value < 0 ? "-" : "", (unsigned)(magnitude / divisor));
+    if (fraction)
+    {
+        while (fraction % 10 == 0)
+        {
+            fraction /= 10;
+            decimals--;
+        }
+        snprintf(out + len, size - len, ".%0*u", decimals, (unsigned)fraction);
+    }
+    return out;
+}
+
+// Writes one sensor record of the GET / array
+size_t formatSensorJson(char *out, size_t size, const char *mac, const MiThData_t &reading)
+{
+    char temperature[12], humidity[12], batt_voltage[12];
+    int len = snprintf(out, size,
+                       "{\"mac\":\"%s\",\"timestamp\":%llu,\"temperature\":%s,\"humidity\":%s,"
+                       "\"batt_voltage\":%s,\"batt_level\":%u,\"rssi\":%d}",
+                       mac, (unsigned long long)reading.timestamp,
+                       formatScaled(temperature, sizeof(temperature), reading.temperature, 2),
+                       formatScaled(humidity, sizeof(humidity), reading.humidity, 2),
+                       formatScaled(batt_voltage, sizeof(batt_voltage), reading.batt_voltage, 3),
+                       reading.batt_level, reading.rssi);
+    return len < (int)size ? len : size - 1;
+}
+
+// Chunked JSON array response. Records are produced one at a time by nextRecord()
+// and copied into AsyncWebServer's chunk buffer, so memory use does not depend on the array length.
+struct JsonArrayStream
+{
+    virtual ~JsonArrayStream() {}
+
+    // Writes the next record into out and returns its length, 0 if there are no more records
+    virtual size_t nextRecord(char *out, size_t size) = 0;
+
+    // AwsResponseFiller
+    size_t fill(uint8_t *buffer, size_t maxLen)
+    {
+        size_t written = 0;
+        while (written < maxLen)
+        {
+            if (sent == len)
+            {
+                if (closed)
+                    break;
+                size_t recordLen = nextRecord(record + 1, sizeof(record) - 1);
+                if (recordLen)
+                {
+                    record[0] = started ? ',' : '[';
+                    len = 1 + recordLen;
+                }
+                else
+                {
+                    // Opening bracket is still missing when there are no records
+                    const char *tail = started ? "]" : "[]";
+                    len = strlen(tail);
+                    memcpy(record, tail, len);
+                    closed = true;
+                }
+                started = true;
+                sent = 0;
+            }
+            size_t n = std::min(maxLen - written, len - sent);
+            memcpy(buffer + written, record + sent, n);
+            sent += n;
+            written += n;
+        }
+        return written;
+    }
+
+    bool started = false;
+    bool closed = false;
+    char record[160];  // serialized record with leading '[' or ','
+    size_t len = 0;
+    size_t sent = 0;
+};
+
+void sendJsonArrayStream(AsyncWebServerRequest *request, std::shared_ptr<JsonArrayStream> stream, const char *etag = nullptr)
+{
+    AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+        [stream](uint8_t *buffer, size_t maxLen, size_t) -> size_t
+        {
+            return stream->fill(buffer, maxLen);
+        });
+    if (etag)
+    {
+        response->addHeader("ETag", etag);
+    }
+    request->send(response);
+}
+
+// GET / records: latest reading of each sensor
+struct SensorJsonStream : JsonArrayStream
+{
+    size_t nextRecord(char *out, size_t size) override
+    {
+        if (next == sensorTable.size())
+            return 0;
+        // Consistent copy, the BLE side keeps updating while we serialize
+        MiThData_t reading;
+        sensorTable.getSnapshot(next, reading);
+        char mac[18];
+        return formatSensorJson(out, size, sensorTable.macString(next++, mac), reading);
+    }
+
+    size_t next = 0;  // index of the next sensor to serialize
+};
+
+// GET /history records: samples of one sensor since a point in time
+struct HistoryJsonStream : JsonArrayStream
+{
+    size_t nextRecord(char *out, size_t size) override
+    {
+        SensorHistoryBase::Sample sample;
+        do
+        {
+            if (!sensorHistory.next(index, cursor, sample))
+                return 0;
+        } while (sample.timestamp < since);
+        char temperature[12], humidity[12];
+        int len = snprintf(out, size, "{\"timestamp\":%u,\"temperature\":%s,\"humidity\":%s}",
+                           (unsigned)sample.timestamp,
+                           formatScaled(temperature, sizeof(temperature), sample.temperature, 2),
+                           formatScaled(humidity, sizeof(humidity), sample.humidity, 2));
+        return len < (int)size ? len : size - 1;
+    }
+
+    size_t index;
+    uint32_t since;
+    SensorHistoryBase::Cursor cursor;
+};
+
+// Serialized GET / response, rebuilt record by record only when a reading has been published since.
+// Requests in flight keep their copy alive through the shared pointer.
+std::shared_ptr<String> rootBody;
+uint32_t rootVersion;
+
 void handle_get_root(AsyncWebServerRequest *request)
 {
     Serial.println("Handling GET API request");
-    JsonArray array = dataJSON.to<JsonArray>();
-    for (int i = 0; i < miThermometer.data.size(); i++)
-    {
-        JsonObject nested = array.add<JsonObject>();
-        nested["mac"] = knownBLEAddresses[i].c_str();
-        nested["timestamp"] = miThermometer.data[i].timestamp;
-        nested["temperature"] = miThermometer.data[i].temperature / 100.0;
-        nested["humidity"] = miThermometer.data[i].humidity / 100.0;
-        nested["batt_voltage"] = miThermometer.data[i].batt_voltage / 1000.0;
-        nested["batt_level"] = miThermometer.data[i].batt_level;
-        nested["rssi"] = miThermometer.data[i].rssi;
+    // Read before serializing, a reading published meanwhile triggers another rebuild
+    uint32_t version = sensorTable.getVersion();
+    char etag[20];
+    snprintf(etag, sizeof(etag), "\"%08x%08x\"", (unsigned)bootNonce, (unsigned)version);
+
+    // Client already has the current data
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag)
+    {
+        AsyncWebServerResponse *response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        request->send(response);
+        return;
     }
-    String json;
-    serializeJson(dataJSON, json);
-    Serial.println(json);
-    request->send(200, "application/json", json);
+
+    if (!rootBody || version != rootVersion)
+    {
+        std::shared_ptr<String> body = std::make_shared<String>();
+        SensorJsonStream stream;
+        body->reserve(sensorTable.size() * sizeof(stream.record));
+        uint8_t chunk[sizeof(stream.record)];
+        size_t len;
+        while ((len = stream.fill(chunk, sizeof(chunk))) > 0)
+        {
+            body->concat(reinterpret_cast<const char *>(chunk), len);
+        }
+        rootBody = body;
+        rootVersion = version;
+    }
+
+    std::shared_ptr<String> body = rootBody;
+    AsyncWebServerResponse *response = request->beginResponse("application/json", body->length(),
+        [body](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        {
+            size_t len = std::min(maxLen, body->length() - index);
+            memcpy(buffer, body->c_str() + index, len);
+            return len;
+        });
+    response->addHeader("ETag", etag);
+    request->send(response);
+}
+
+void handle_get_history(AsyncWebServerRequest *request)
+{
+    Serial.println("Handling GET history API request");
+    if (!request->hasParam("mac"))
+    {
+        request->send(400, "text/plain", "Missing mac parameter");
+        return;
+    }
+    int index = sensorTable.find(SensorTableBase::parseMac(request->getParam("mac")->value().c_str()));
+    if (index < 0)
+    {
+        request->send(404, "text/plain", "Unknown sensor");
+        return;
+    }
+    std::shared_ptr<HistoryJsonStream> stream = std::make_shared<HistoryJsonStream>();
+    stream->index = index;
+    stream->since = request->hasParam("since") ? strtoul(request->getParam("since")->value().c_str(), nullptr, 10) : 0;
+    sensorHistory.begin(index, stream->cursor);
+    sendJsonArrayStream(request, stream);
 }
 
 void handle_get_version(AsyncWebServerRequest *request)
@@ -97,6 +354,72 @@ void handle_get_version(AsyncWebServerRequest *request)
     request->send(200, "application/json", json);
 }
 
+// Runs in the writer task after each use of the client
+void onWriterStatus(const InfluxDBClient &client)
+{
+    WriterMetrics metrics;
+    metrics.stats = client.getWriteStats();
+    metrics.connection = client.getConnectionStats();
+    metrics.flushPolicy = client.getFlushPolicy();
+    metrics.storeDropped = spillLog.getDropped();
+    writerMetrics.write(metrics);
+}
+
+void handle_get_metrics(AsyncWebServerRequest *request)
+{
+    Serial.println("Handling GET metrics API request");
+    WriterMetrics writer;
+    writerMetrics.read(writer);
+    const WriteStats &stats = writer.stats;
+    JsonDocument metrics;
+    metrics["uptime"] = millis() / 1000;
+    metrics["readings_passed"] = changeFilter.getPassed();
+    metrics["readings_suppressed"] = changeFilter.getSuppressed();
+    metrics["points_generated"] = pointsGenerated;
+    metrics["points_enqueued"] = stats.pointsEnqueued;
+    metrics["points_dropped"] = stats.pointsDropped;
+    metrics["bytes_enqueued"] = stats.bytesEnqueued;
+    metrics["batches_posted"] = stats.batchesPosted;
+    metrics["bytes_sent"] = stats.bytesSent;
+    metrics["bytes_uncompressed"] = stats.bytesUncompressed;
+    metrics["failures"] = stats.failures;
+    metrics["retries"] = stats.retries;
+    metrics["batches_stored"] = stats.batchesStored;
+    metrics["batches_restored"] = stats.batchesRestored;
+    metrics["stored_batches_dropped"] = stats.storedBatchesDropped;
+    metrics["points_dropped_by_store"] = writer.storeDropped;
+    metrics["points_rejected_by_queue"] = influxWriter.getRejected();
+    metrics["queued_bytes"] = influxWriter.getQueued();
+    const AdaptiveFlushPolicy &flushPolicy = writer.flushPolicy;
+    JsonObject policy = metrics["flush_policy"].to<JsonObject>();
+    policy["batch_size"] = flushPolicy.getBatchSize();
+    policy["decision"] = AdaptiveFlushPolicy::decisionToString(flushPolicy.getLastDecision());
+    policy["latency_ms"] = flushPolicy.getLatency();
+    policy["interval_ms"] = flushPolicy.getInterval();
+    policy["grows"] = flushPolicy.getGrows();
+    policy["shrinks"] = flushPolicy.getShrinks();
+    const ConnectionStats &connStats = writer.connection;
+    JsonObject connection = metrics["connection"].to<JsonObject>();
+    connection["connects"] = connStats.connects;
+    connection["reuses"] = connStats.reuses;
+    connection["idle_closes"] = connStats.idleCloses;
+    connection["reconnects"] = connStats.reconnects;
+    connection["connect_ms"] = connStats.connects ? connStats.connectTime / connStats.connects : 0;
+    connection["reuse_ms"] = connStats.reuses ? connStats.reuseTime / connStats.reuses : 0;
+    JsonArray sensors = metrics["sensors"].to<JsonArray>();
+    for (size_t i = 0; i < sensorTable.size(); i++)
+    {
+        char mac[18];
+        JsonObject sensor = sensors.add<JsonObject>();
+        sensor["mac"] = sensorTable.macString(i, mac);
+        sensor["points"] = sensorUploadStats[i].points;
+        sensor["bytes"] = sensorUploadStats[i].bytes;
+    }
+    String json;
+    serializeJson(metrics, json);
+    request->send(200, "application/json", json);
+}
+
 void handle_get_reboot(AsyncWebServerRequest *request)
 {
     Serial.println("Handling GET Reboot API request");
@@ -124,11 +447,15 @@ void setup()
     Serial.println(ssid);
     Serial.print("IP address: ");
     Serial.println(WiFi.localIP());
+    // Hardware RNG is a true random source once the radio is on
+    bootNonce = esp_random();
 
     timeSync(TZ_INFO, "pool.ntp.org", "time.nis.gov");
 
     server.on("/", HTTP_GET, handle_get_root);
+    server.on("/history", HTTP_GET, handle_get_history);
     server.on("/version", HTTP_GET, handle_get_version);
+    server.on("/metrics", HTTP_GET, handle_get_metrics);
     server.on("/reboot", HTTP_GET, handle_get_reboot);
 
     ElegantOTA.begin(&server); // Start ElegantOTA
@@ -153,10 +480,25 @@ void setup()
         Serial.println(influxDBClient.getLastErrorMessage());
     }
     // Increase buffer to allow caching of failed writes
-    influxDBClient.setWriteOptions(WriteOptions().writePrecision(WRITE_PRECISION).batchSize(MAX_BATCH_SIZE).bufferSize(WRITE_BUFFER_SIZE));
+    influxDBClient.setWriteOptions(WriteOptions().writePrecision(WRITE_PRECISION).batchSize(MAX_BATCH_SIZE).bufferSize(WRITE_BUFFER_SIZE).flushInterval(MAX_STALENESS_SEC).adaptiveBatching(true).gzip(true));
+    influxDBClient.setHTTPOptions(HTTPOptions().connectionReuse(true).idleTimeout(HTTP_IDLE_TIMEOUT_MS));
+    if (spillLog.begin())
+    {
+        influxDBClient.setBatchStore(&spillLog);
+        Serial.println(spillLog.isEmpty() ? "Spill log empty" : "Spill log holds unwritten batches");
+    }
+    else
+    {
+        Serial.println("Spill log not available, check spiffs partition");
+    }
+    // From now on the client is used by the writer task only
+    influxWriter.setStatusCallback(onWriterStatus);
+    influxWriter.begin();
 
     // Initialization
     miThermometer.begin();
+    // Scan continuously, readings are collected in loop()
+    miThermometer.startStreaming();
 }
 
 void loop()
@@ -170,50 +512,77 @@ void loop()
     // Set sensor data invalid
     miThermometer.resetData();
 
-    // Get sensor data - run BLE scan for <scanTime>
-    unsigned found = miThermometer.getData(BLE_SCAN_TIME_SEC);
+    // Get sensor data received by the BLE scan since last iteration
+    unsigned found = miThermometer.update();
 
-    for (int i = 0; i < miThermometer.data.size(); i++)
+    for (int i = 0; i < sensorTable.size(); i++)
     {
-        u64_t timestamp = time(nullptr);
-        if (miThermometer.data[i].valid)
+        const MiThData_t &data = sensorTable.data(i);
+        if (data.valid)
         {
-            miThermometer.data[i].timestamp = timestamp;
+            char mac[18];
+            sensorTable.macString(i, mac);
             Serial.println();
-            Serial.printf("Sensor %d: %s\n", i, knownBLEAddresses[i].c_str());
-            Serial.printf("temperature %.1f°C\n", miThermometer.data[i].temperature / 100.0);
-            Serial.printf("humidity %d%%\n", miThermometer.data[i].humidity / 100.0);
-            Serial.printf("%.3fV\n", miThermometer.data[i].batt_voltage / 1000.0);
-            Serial.printf("batt_level %d%%\n", miThermometer.data[i].batt_level);
-            Serial.printf("rssi %ddBm\n", miThermometer.data[i].rssi);
+            Serial.printf("Sensor %d: %s\n", i, mac);
+            Serial.printf("temperature %.1f°C\n", data.temperature / 100.0);
+            Serial.printf("humidity %.2f%%\n", data.humidity / 100.0);
+            Serial.printf("%.3fV\n", data.batt_voltage / 1000.0);
+            Serial.printf("batt_level %d%%\n", data.batt_level);
+            Serial.printf("rssi %ddBm\n", data.rssi);
             Serial.println();
 
-            // Add tags to the data point
-            measurementPoint.clearTags();
-            measurementPoint.addTag("device", knownBLEAddresses[i].c_str());
-            measurementPoint.clearFields();
-            measurementPoint.setTime(miThermometer.data[i].timestamp);
-            measurementPoint.addField("temperature", miThermometer.data[i].temperature / 100.0);
-            measurementPoint.addField("humidity", miThermometer.data[i].humidity / 100.0);
-            measurementPoint.addField("batt_voltage", miThermometer.data[i].batt_voltage / 1000.0);
-            measurementPoint.addField("batt_level", miThermometer.data[i].batt_level);
-            measurementPoint.addField("rssi", miThermometer.data[i].rssi);
-
-            Serial.print("Write to buffer/server: ");
-            Serial.println(measurementPoint.toLineProtocol());
-            influxDBClient.writePoint(measurementPoint);
-            if (!influxDBClient.writePoint(measurementPoint))
+            if (data.timestamp - sensorHistory.lastTime(i) >= HISTORY_INTERVAL_SEC)
+            {
+                sensorHistory.append(i, data.timestamp, data.temperature, data.humidity);
+            }
+
+            // Skip repeated advertisements and changes within the deadbands
+            if (!changeFilter.shouldSend(i, data))
+            {
+                continue;
+            }
+
+            // Format reading into line protocol
+            char line[LINE_BUFFER_SIZE];
+            const char *tags[] = {mac};
+            size_t length = measurementSchema.toLineProtocol(line, sizeof(line), tags,
+                {data.temperature, data.humidity, data.batt_voltage, data.batt_level, data.rssi}, data.timestamp);
+
+            // 0 means the schema could not be allocated, sizeof(line) or more that the line is truncated
+            if (length == 0 || length >= sizeof(line))
+            {
+                Serial.println("Reading could not be formatted, skipped");
+                continue;
+            }
+            pointsGenerated++;
+
+            Serial.print("Write to queue: ");
+            Serial.println(mac);
+            if (influxWriter.write(line, length))
             {
-                Serial.print("InfluxDB write failed: ");
-                Serial.println(influxDBClient.getLastErrorMessage());
+                // Only a queued reading becomes the new baseline, a skipped one is sent with the next reading
+                changeFilter.commit(i, data);
+                sensorUploadStats[i].points++;
+                sensorUploadStats[i].bytes += length + 1;
+            }
+            else
+            {
+                Serial.println("InfluxDB write queue full, reading skipped");
             }
         }
     }
-    Serial.print("Devices found: ");
-    Serial.println(found);
-    Serial.println();
+    // Outcome of the writes done by the writer task
+    WriteEvent event;
+    while (influxWriter.pollEvent(event))
+    {
+        Serial.printf("InfluxDB %s: %u, status %d\n", AsyncWriter::eventTypeToString(event.type), event.count, event.statusCode);
+    }
+    if (found)
+    {
+        Serial.print("Readings received: ");
+        Serial.println(found);
+        Serial.println();
+    }
 
-    // Delete results fromBLEScan buffer to release memory
-    miThermometer.clearScanResults();
-    delay(5000);
+    delay(LOOP_DELAY_MS);
 }
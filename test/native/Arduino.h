@@ -0,0 +1,291 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Arduino.h
+//
+// Minimal Arduino core for the native test environment (see [env:native] in platformio.ini).
+//
+// Provides just what the libraries in lib/ use: String, Print, Stream, PROGMEM helpers,
+// timing, logging and free heap. Time and free heap can be controlled by tests.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strcpy_P strcpy
+#define memcpy_P memcpy
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+
+#define log_e(fmt, ...) fprintf(stderr, "[E] " fmt "\n", ##__VA_ARGS__)
+#define log_w(fmt, ...) fprintf(stderr, "[W] " fmt "\n", ##__VA_ARGS__)
+#define log_i(fmt, ...)
+#define log_d(fmt, ...)
+
+typedef bool boolean;
+class __FlashStringHelper;
+
+//! Offset added to millis(), so tests can let time pass without waiting
+inline unsigned long &hostMillisOffset()
+{
+    static unsigned long offset = 0;
+    return offset;
+}
+
+inline void hostAdvanceMillis(unsigned long ms)
+{
+    hostMillisOffset() += ms;
+}
+
+inline unsigned long micros()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis()
+{
+    return micros() / 1000 + hostMillisOffset();
+}
+
+inline void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield()
+{
+    std::this_thread::yield();
+}
+
+inline void configTzTime(const char *, const char *, const char *, const char *)
+{
+}
+
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char *s) : std::string(s ? s : "") {}
+    String(const std::string &s) : std::string(s) {}
+    String(const __FlashStringHelper *s) : std::string(reinterpret_cast<const char *>(s)) {}
+    explicit String(char c) : std::string(1, c) {}
+    explicit String(int v) : std::string(std::to_string(v)) {}
+    explicit String(unsigned int v) : std::string(std::to_string(v)) {}
+    explicit String(long v) : std::string(std::to_string(v)) {}
+    explicit String(unsigned long v) : std::string(std::to_string(v)) {}
+    explicit String(long long v) : std::string(std::to_string(v)) {}
+    explicit String(unsigned long long v) : std::string(std::to_string(v)) {}
+    explicit String(unsigned char v) : std::string(std::to_string(v)) {}
+    explicit String(double v, unsigned int decimals = 2) { format(v, decimals); }
+    explicit String(float v, unsigned int decimals = 2) { format(v, decimals); }
+
+    String &operator=(const char *s)
+    {
+        if (s)
+            assign(s);
+        else
+            clear();
+        return *this;
+    }
+    String &operator+=(const String &s) { append(s); return *this; }
+    String &operator+=(const char *s) { append(s); return *this; }
+    String &operator+=(char c) { push_back(c); return *this; }
+    String &operator+=(const __FlashStringHelper *s) { append(reinterpret_cast<const char *>(s)); return *this; }
+    String &operator+=(int v) { append(std::to_string(v)); return *this; }
+    String &operator+=(unsigned int v) { append(std::to_string(v)); return *this; }
+    String &operator+=(long v) { append(std::to_string(v)); return *this; }
+    String &operator+=(unsigned long v) { append(std::to_string(v)); return *this; }
+
+    bool reserve(size_t n) { std::string::reserve(n); return true; }
+    bool concat(const char *s, unsigned int n) { append(s, n); return true; }
+    bool concat(const String &s) { append(s); return true; }
+    bool concat(const char *s) { append(s); return true; }
+    bool concat(char c) { push_back(c); return true; }
+    bool equals(const String &s) const { return compare(s) == 0; }
+    bool equals(const char *s) const { return compare(s) == 0; }
+    bool equalsIgnoreCase(const String &s) const { return strcasecmp(c_str(), s.c_str()) == 0; }
+    bool startsWith(const String &s) const { return compare(0, s.size(), s) == 0; }
+    bool endsWith(const String &s) const { return size() >= s.size() && compare(size() - s.size(), s.size(), s) == 0; }
+    char charAt(unsigned int i) const { return i < size() ? (*this)[i] : 0; }
+    int indexOf(char c, unsigned int from = 0) const { return position(find(c, from)); }
+    int indexOf(const String &s, unsigned int from = 0) const { return position(find(s, from)); }
+    int lastIndexOf(char c) const { return position(rfind(c)); }
+    String substring(unsigned int from) const { return from < size() ? String(substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < to && from < size() ? String(substr(from, to - from)) : String(); }
+    void remove(unsigned int from) { if (from < size()) erase(from); }
+    void remove(unsigned int from, unsigned int count) { if (from < size()) erase(from, count); }
+    void replace(const String &from, const String &to)
+    {
+        for (size_t p = 0; (p = find(from, p)) != npos; p += to.size())
+            std::string::replace(p, from.size(), to);
+    }
+    void toLowerCase() { for (char &c : *this) c = (char)tolower(c); }
+    void toUpperCase() { for (char &c : *this) c = (char)toupper(c); }
+    void trim()
+    {
+        size_t first = find_first_not_of(" \t\r\n");
+        if (first == npos) {
+            clear();
+            return;
+        }
+        assign(substr(first, find_last_not_of(" \t\r\n") - first + 1));
+    }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+    double toDouble() const { return atof(c_str()); }
+
+private:
+    void format(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        assign(buf);
+    }
+    static int position(size_t p) { return p == npos ? -1 : (int)p; }
+};
+
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const __FlashStringHelper *b) { String r(a); r += b; return r; }
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (n < size && write(buffer[n]))
+            n++;
+        return n;
+    }
+    size_t write(const char *s) { return write(reinterpret_cast<const uint8_t *>(s), strlen(s)); }
+    size_t print(const char *s) { return write(s); }
+    size_t print(const String &s) { return write(reinterpret_cast<const uint8_t *>(s.c_str()), s.length()); }
+    size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned int v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+    template <typename T>
+    size_t println(const T &v) { return print(v) + write("\r\n"); }
+    size_t println() { return write("\r\n"); }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[256];
+        va_list args;
+        va_start(args, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        return n > 0 ? write(reinterpret_cast<const uint8_t *>(buf), std::min((size_t)n, sizeof(buf) - 1)) : 0;
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    virtual size_t readBytes(char *buffer, size_t length)
+    {
+        size_t n = 0;
+        for (int c; n < length && (c = timedRead()) >= 0; n++)
+            buffer[n] = (char)c;
+        return n;
+    }
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes(reinterpret_cast<char *>(buffer), length); }
+    String readStringUntil(char terminator)
+    {
+        String s;
+        for (int c; (c = timedRead()) >= 0 && c != terminator;)
+            s += (char)c;
+        return s;
+    }
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() const { return _timeout; }
+
+protected:
+    int timedRead()
+    {
+        unsigned long start = millis();
+        do {
+            int c = read();
+            if (c >= 0)
+                return c;
+            yield();
+        } while (millis() - start < _timeout);
+        return -1;
+    }
+    unsigned long _timeout = 1000;
+};
+
+//! Serial writes to stdout
+class HostSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    using Print::write;
+};
+
+inline HostSerial &hostSerial()
+{
+    static HostSerial serial;
+    return serial;
+}
+#define Serial hostSerial()
+
+//! Free heap reported by ESP, tests can set it to simulate low memory
+class HostEsp
+{
+public:
+    uint32_t getFreeHeap() const { return freeHeap; }
+    uint32_t getMaxAllocHeap() const { return freeHeap; }
+    void restart() {}
+    uint32_t freeHeap = 200000;
+};
+
+inline HostEsp &hostEsp()
+{
+    static HostEsp esp;
+    return esp;
+}
+#define ESP hostEsp()
+
+#endif
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BaselinePoint.h
+//
+// Reference for native tests and benchmarks of line protocol formatting: a copy of Point as it was
+// before it used LineProtocolWriter, and of dtostrf() from the ESP32 Arduino core, which its
+// String(double, decimalPlaces) used for float fields. The host Arduino.h formats doubles with
+// printf, which rounds ties differently, so output must be compared with this copy instead.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BaselinePoint_h
+#define BaselinePoint_h
+
+#include <Arduino.h>
+#include <math.h>
+#include <vector>
+#include "util/helpers.h"
+
+//! dtostrf() of the ESP32 Arduino core (cores/esp32/stdlib_noniso.c)
+inline char *dtostrf(double number, signed int width, unsigned int prec, char *s)
+{
+    bool negative = false;
+    if (isnan(number))
+    {
+        strcpy(s, "nan");
+        return s;
+    }
+    if (isinf(number))
+    {
+        strcpy(s, "inf");
+        return s;
+    }
+    char *out = s;
+    int fillme = width;
+    if (prec > 0)
+        fillme -= (prec + 1);
+    if (number < 0.0)
+    {
+        negative = true;
+        fillme--;
+        number = -number;
+    }
+    double rounding = 2.0;
+    for (unsigned int i = 0; i < prec; ++i)
+        rounding *= 10.0;
+    rounding = 1.0 / rounding;
+    number += rounding;
+    double tenpow = 1.0;
+    int digitcount = 1;
+    while (number >= 10.0 * tenpow)
+    {
+        tenpow *= 10.0;
+        digitcount++;
+    }
+    number /= tenpow;
+    fillme -= digitcount;
+    while (fillme-- > 0)
+        *out++ = ' ';
+    if (negative)
+        *out++ = '-';
+    digitcount += prec;
+    int8_t digit = 0;
+    while (digitcount-- > 0)
+    {
+        digit = (int8_t)number;
+        if (digit > 9)
+            digit = 9;
+        *out++ = (char)('0' | digit);
+        if ((digitcount == (int)prec) && (prec > 0))
+            *out++ = '.';
+        number -= digit;
+        number *= 10.0;
+    }
+    *out = 0;
+    return s;
+}
+
+//! String(value, decimalPlaces) of the ESP32 Arduino core
+inline String baselineDoubleString(double value, unsigned int decimalPlaces)
+{
+    std::vector<char> buf(decimalPlaces + 312);
+    return String(dtostrf(value, decimalPlaces + 2, decimalPlaces, buf.data()));
+}
+
+//! Point before LineProtocolWriter: every part is escaped and appended to a String as it is added
+class BaselinePoint
+{
+public:
+    BaselinePoint(const String &measurement)
+    {
+        char *s = escapeKey(measurement, false);
+        _measurement = s;
+        delete[] s;
+    }
+
+    void addTag(const String &name, String value)
+    {
+        if (_tags.length() > 0)
+            _tags += ',';
+        char *s = escapeKey(name);
+        _tags += s;
+        delete[] s;
+        _tags += '=';
+        s = escapeKey(value);
+        _tags += s;
+        delete[] s;
+    }
+
+    void addField(const String &name, double value, int decimalPlaces = 2)
+    {
+        if (!isnan(value))
+            putField(name, baselineDoubleString(value, decimalPlaces));
+    }
+    void addField(const String &name, int value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, bool value) { putField(name, bool2string(value)); }
+    void addField(const String &name, const char *value) { putField(name, escapeValue(value)); }
+
+    void setTime(unsigned long long timestamp)
+    {
+        char *s = timeStampToString(timestamp);
+        _timestamp = s;
+        delete[] s;
+    }
+
+    String toLineProtocol() const
+    {
+        String line;
+        line.reserve(_measurement.length() + 1 + _tags.length() + 1 + _fields.length() + 1 + _timestamp.length());
+        line += _measurement;
+        if (_tags.length() > 0)
+        {
+            line += ",";
+            line += _tags;
+        }
+        if (_fields.length() > 0)
+        {
+            line += " ";
+            line += _fields;
+        }
+        if (_timestamp.length() > 0)
+        {
+            line += " ";
+            line += _timestamp;
+        }
+        return line;
+    }
+
+private:
+    String _measurement;
+    String _tags;
+    String _fields;
+    String _timestamp;
+
+    void putField(const String &name, const String &value)
+    {
+        if (_fields.length() > 0)
+            _fields += ',';
+        char *s = escapeKey(name);
+        _fields += s;
+        delete[] s;
+        _fields += '=';
+        _fields += value;
+    }
+};
+
+#endif
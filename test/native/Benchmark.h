@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark.h
+//
+// Timing helpers for the host benchmarks in test/test_bench_*. They run in their own environment,
+// with optimization, and print their results:
+//
+//   pio test -e native_bench -v
+//
+// Each benchmark also checks that the compared implementations give the same result, so a
+// benchmark that measures the wrong thing fails instead of printing a number.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef Benchmark_h
+#define Benchmark_h
+
+#include <chrono>
+#include <stdio.h>
+
+//! Returns best wall time of repeat runs of f, in nanoseconds
+template <class F>
+double benchBestNs(F f, int repeat = 5)
+{
+    double best = 0;
+    for (int i = 0; i < repeat; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+//! Keeps value from being optimized away
+template <class T>
+inline void benchKeep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+//! Prints one result line, e.g. "sensor lookup, 1k advertisements   old 120.5   new 8.2   ns/adv"
+inline void benchReport(const char *name, double before, double after, const char *unit)
+{
+    printf("%-44s old %10.2f   new %10.2f   %s   (%.1fx)\n", name, before, after, unit, after > 0 ? before / after : 0);
+}
+
+#endif
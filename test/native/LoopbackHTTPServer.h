@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LoopbackHTTPServer.h
+//
+// Minimal HTTP/1.1 server on 127.0.0.1 for native tests and benchmarks that run the client over
+// real sockets (PosixHTTPTransport). It serves one connection at a time in its own thread,
+// reads request bodies sent with Content-Length or chunked encoding and answers every request
+// with the configured status and body. Connections are kept open unless keepAlive is cleared.
+// With dropRequests set, the connection is closed as soon as a request head is read, so the
+// client gets a reset while it is still sending the body.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LoopbackHTTPServer_h
+#define LoopbackHTTPServer_h
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+class LoopbackHTTPServer
+{
+public:
+    //! Request as received by the server
+    struct Request
+    {
+        std::string method;
+        std::string path;
+        std::string headers;  // header lines as received, each ending with \r\n
+        std::string body;
+    };
+
+    LoopbackHTTPServer() {}
+    ~LoopbackHTTPServer() { stop(); }
+
+    //! Listens on an ephemeral port, false if the socket cannot be opened
+    bool start()
+    {
+        _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (_listenFd < 0)
+            return false;
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (bind(_listenFd, (sockaddr *)&addr, sizeof(addr)) || listen(_listenFd, 4) ||
+            getsockname(_listenFd, (sockaddr *)&addr, &len))
+        {
+            close(_listenFd);
+            _listenFd = -1;
+            return false;
+        }
+        _port = ntohs(addr.sin_port);
+        _running = true;
+        _thread = std::thread(&LoopbackHTTPServer::serve, this);
+        return true;
+    }
+
+    void stop()
+    {
+        if (!_running)
+            return;
+        _running = false;
+        _thread.join();
+        close(_listenFd);
+        _listenFd = -1;
+    }
+
+    //! Base url of the server, e.g. "http://127.0.0.1:40123"
+    String url() const { return String("http://127.0.0.1:") + String(_port); }
+
+    //! Sets the answer to all following requests
+    void respond(int status, const std::string &body = std::string(), const std::string &contentType = "text/plain")
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _status = status;
+        _responseBody = body;
+        _contentType = contentType;
+    }
+
+    //! Last request received
+    Request lastRequest()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _last;
+    }
+
+    std::atomic<bool> keepAlive{true};
+    std::atomic<bool> dropRequests{false};
+    std::atomic<uint32_t> connections{0};
+    std::atomic<uint32_t> requests{0};
+    std::atomic<uint64_t> bodyBytes{0};
+
+private:
+    int _listenFd = -1;
+    uint16_t _port = 0;
+    std::atomic<bool> _running{false};
+    std::thread _thread;
+    std::mutex _mutex;
+    int _status = 204;
+    std::string _responseBody;
+    std::string _contentType = "text/plain";
+    Request _last;
+    // received bytes not consumed yet
+    std::string _in;
+
+    // Waits for fd to be readable, false when the server stops
+    bool waitReadable(int fd)
+    {
+        pollfd p = {fd, POLLIN, 0};
+        while (_running)
+            if (poll(&p, 1, 20) > 0)
+                return true;
+        return false;
+    }
+
+    bool receive(int fd)
+    {
+        char buffer[16384];
+        if (!waitReadable(fd))
+            return false;
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+            return false;
+        _in.append(buffer, n);
+        return true;
+    }
+
+    bool readLine(int fd, std::string &line)
+    {
+        size_t end;
+        while ((end = _in.find("\r\n")) == std::string::npos)
+            if (!receive(fd))
+                return false;
+        line = _in.substr(0, end);
+        _in.erase(0, end + 2);
+        return true;
+    }
+
+    bool readBytes(int fd, size_t length, std::string &out)
+    {
+        while (_in.size() < length)
+            if (!receive(fd))
+                return false;
+        out.append(_in, 0, length);
+        _in.erase(0, length);
+        return true;
+    }
+
+    bool readRequest(int fd, Request &request)
+    {
+        std::string line;
+        if (!readLine(fd, line))
+            return false;
+        size_t sp = line.find(' ');
+        request.method = line.substr(0, sp);
+        request.path = line.substr(sp + 1, line.rfind(' ') - sp - 1);
+        size_t contentLength = 0;
+        bool chunked = false;
+        while (readLine(fd, line) && !line.empty())
+        {
+            request.headers += line + "\r\n";
+            if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0)
+                contentLength = strtoul(line.c_str() + 15, nullptr, 10);
+            else if (strncasecmp(line.c_str(), "Transfer-Encoding:", 18) == 0 && line.find("chunked") != std::string::npos)
+                chunked = true;
+        }
+        if (dropRequests)
+            return false;
+        if (!chunked)
+            return readBytes(fd, contentLength, request.body);
+        for (;;)
+        {
+            if (!readLine(fd, line))
+                return false;
+            size_t size = strtoul(line.c_str(), nullptr, 16);
+            if (!readBytes(fd, size, request.body) || !readLine(fd, line))
+                return false;
+            if (!size)
+                return true;
+        }
+    }
+
+    bool writeAll(int fd, const std::string &data)
+    {
+        size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    void serveConnection(int fd)
+    {
+        _in.clear();
+        for (;;)
+        {
+            Request request;
+            if (!readRequest(fd, request))
+                return;
+            std::string response;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                bodyBytes += request.body.size();
+                _last = request;
+                char head[160];
+                snprintf(head, sizeof(head), "HTTP/1.1 %d Status\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: %s\r\n\r\n",
+                         _status, _contentType.c_str(), (unsigned)_responseBody.size(), keepAlive ? "keep-alive" : "close");
+                response = head + _responseBody;
+            }
+            requests++;
+            if (!writeAll(fd, response) || !keepAlive)
+                return;
+        }
+    }
+
+    void serve()
+    {
+        while (waitReadable(_listenFd))
+        {
+            int fd = accept(_listenFd, nullptr, nullptr);
+            if (fd < 0)
+                continue;
+            connections++;
+#ifdef SO_NOSIGPIPE
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            serveConnection(fd);
+            close(fd);
+        }
+    }
+};
+
+#endif
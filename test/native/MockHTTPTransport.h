@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MockHTTPTransport.h
+//
+// HTTPTransport for native tests: records requests and answers them with queued responses.
+//
+// Response bodies are handed out at most readChunk bytes per available(), so tests can
+// exercise partial reads the way a socket delivers them. Connection is simulated: it is opened
+// by a request, kept open by the server if keepAlive is set, and can be closed by either side.
+//
+// MIT License
+//
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MockHTTPTransport_h
+#define MockHTTPTransport_h
+
+#include <Arduino.h>
+#include <HTTPTransport.h>
+#include <deque>
+#include <vector>
+
+class MockHTTPTransport : public HTTPTransport
+{
+public:
+    //! Request as sent by the client
+    struct Request
+    {
+        String method;
+        String url;
+        std::vector<std::pair<String, String>> headers;
+        String body;
+
+        String header(const char *name) const
+        {
+            for (const auto &h : headers)
+                if (h.first.equalsIgnoreCase(name))
+                    return h.second;
+            return String();
+        }
+    };
+
+    //! Response to the next request
+    struct Response
+    {
+        int status;
+        String body;
+        //! Value of Retry-After header, empty for none
+        String retryAfter;
+        //! Body length reported by getSize(), -1 for unknown (e.g. chunked)
+        int size;
+    };
+
+    //! Queues response, requests without a queued response get defaultStatus
+    void respond(int status, const String &body = String(), int size = -2, const String &retryAfter = String())
+    {
+        _responses.push_back({status, body, retryAfter, size == -2 ? (int)body.length() : size});
+    }
+
+    std::vector<Request> requests;
+    //! Status of requests without a queued response, e.g. HTTPC_ERROR_CONNECTION_REFUSED for an outage
+    int defaultStatus = 204;
+    //! Maximum bytes available() reports at once, 0 for whole rest of the body
+    size_t readChunk = 0;
+    //! Server keeps connection open after response
+    bool keepAlive = false;
+    //! Requests that opened a new connection
+    int connects = 0;
+
+    //! Server closes kept open connection, client notices on next request
+    void serverClose() { _closedByServer = true; }
+
+    void setOptions(bool, int timeout) override { _stream.setTimeout(timeout); }
+    void setUserAgent(const String &) override {}
+    bool begin(const String &url) override
+    {
+        requests.push_back(Request());
+        requests.back().url = url;
+        return true;
+    }
+    void addHeader(const String &name, const String &value) override { requests.back().headers.push_back({name, value}); }
+    void collectHeaders(const char *[], size_t) override {}
+    int sendRequest(const char *method, const uint8_t *data, size_t length) override
+    {
+        requests.back().method = method;
+        if (!connect())
+            return HTTPC_ERROR_SEND_HEADER_FAILED;
+        if (data)
+            requests.back().body.assign(reinterpret_cast<const char *>(data), length);
+        return nextResponse();
+    }
+    int sendRequest(const char *method, Stream *stream, size_t length) override
+    {
+        requests.back().method = method;
+        if (!connect())
+            return HTTPC_ERROR_SEND_HEADER_FAILED;
+        // pulled in blocks like the real transports
+        char buffer[100];
+        while (requests.back().body.length() < length)
+        {
+            size_t n = stream->readBytes(buffer, std::min(sizeof(buffer), length - requests.back().body.length()));
+            if (n == 0)
+                return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+            requests.back().body.append(buffer, n);
+        }
+        return nextResponse();
+    }
+    using HTTPTransport::sendRequest;
+    bool hasHeader(const char *name) override { return strcasecmp(name, "Retry-After") == 0 && _current.retryAfter.length(); }
+    String header(const char *name) override { return hasHeader(name) ? _current.retryAfter : String(); }
+    int getSize() override { return _current.size; }
+    String getString() override
+    {
+        String s = _current.body.substring(_stream.position);
+        _stream.position = _current.body.length();
+        return s;
+    }
+    int writeToStream(Stream *stream) override
+    {
+        String s = getString();
+        return stream->write(reinterpret_cast<const uint8_t *>(s.c_str()), s.length());
+    }
+    Stream *getStreamPtr() override { return &_stream; }
+    bool connected() override { return _open || _stream.position < _current.body.length(); }
+    void end() override {}
+    void stop() override { _open = false; }
+
+private:
+    class ResponseStream : public Stream
+    {
+    public:
+        ResponseStream(MockHTTPTransport *owner) : _owner(owner) {}
+        int available() override
+        {
+            size_t rest = _owner->_current.body.length() - position;
+            return (int)(_owner->readChunk && rest > _owner->readChunk ? _owner->readChunk : rest);
+        }
+        int read() override { return available() ? (uint8_t)_owner->_current.body[position++] : -1; }
+        int peek() override { return available() ? (uint8_t)_owner->_current.body[position] : -1; }
+        size_t readBytes(char *buffer, size_t length) override
+        {
+            size_t n = std::min(length, (size_t)available());
+            memcpy(buffer, _owner->_current.body.c_str() + position, n);
+            position += n;
+            return n;
+        }
+        size_t write(uint8_t) override { return 0; }
+        using Stream::readBytes;
+        size_t position = 0;
+
+    private:
+        MockHTTPTransport *_owner;
+    };
+
+    // Opens connection if needed. Returns false if kept open connection was closed by server
+    bool connect()
+    {
+        if (_open && _closedByServer)
+        {
+            _open = _closedByServer = false;
+            return false;
+        }
+        if (!_open)
+            connects++;
+        _open = true;
+        _closedByServer = false;
+        return true;
+    }
+
+    int nextResponse()
+    {
+        if (_responses.empty())
+        {
+            _current = {defaultStatus, String(), String(), 0};
+        }
+        else
+        {
+            _current = _responses.front();
+            _responses.pop_front();
+        }
+        _stream.position = 0;
+        _open = keepAlive && _current.status > 0;
+        return _current.status;
+    }
+
+    std::deque<Response> _responses;
+    Response _current = {0, String(), String(), 0};
+    ResponseStream _stream{this};
+    bool _open = false;
+    bool _closedByServer = false;
+};
+
+#endif
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AdaptiveFlushPolicy: batch size decisions on a simulated clock
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "AdaptiveFlushPolicy.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static const uint32_t HeapOk = 100000;
+static const uint32_t HeapLow = 10000;
+
+// Grows batch to size with slow writes and no staleness limit
+static void growTo(AdaptiveFlushPolicy &policy, uint16_t size)
+{
+    while (policy.getBatchSize() < size)
+        policy.onWrite(1000, true, HeapOk);
+}
+
+static void test_grows_on_slow_writes(void)
+{
+    AdaptiveFlushPolicy policy;
+    policy.setLimits(5, 0);
+    TEST_ASSERT_EQUAL(1, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::None, policy.getLastDecision());
+    policy.onWrite(1000, true, HeapOk);
+    TEST_ASSERT_EQUAL(2, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::Grow, policy.getLastDecision());
+    TEST_ASSERT_EQUAL(1000, policy.getLatency());
+    growTo(policy, 5);
+    // limited by maximum
+    policy.onWrite(1000, true, HeapOk);
+    TEST_ASSERT_EQUAL(5, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::Hold, policy.getLastDecision());
+    TEST_ASSERT_EQUAL(4, policy.getGrows());
+}
+
+static void test_holds_on_fast_writes(void)
+{
+    AdaptiveFlushPolicy policy;
+    policy.setLimits(5, 0);
+    for (int i = 0; i < 10; i++)
+        policy.onWrite(50, true, HeapOk);
+    TEST_ASSERT_EQUAL(1, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::Hold, policy.getLastDecision());
+    TEST_ASSERT_EQUAL(50, policy.getLatency());
+}
+
+static void test_halves_on_failure(void)
+{
+    AdaptiveFlushPolicy policy;
+    policy.setLimits(20, 0);
+    growTo(policy, 16);
+    policy.onWrite(1000, false, HeapOk);
+    TEST_ASSERT_EQUAL(8, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::ShrinkFailure, policy.getLastDecision());
+    policy.onWrite(1000, false, HeapOk);
+    policy.onWrite(1000, false, HeapOk);
+    policy.onWrite(1000, false, HeapOk);
+    policy.onWrite(1000, false, HeapOk);
+    TEST_ASSERT_EQUAL(1, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(4, policy.getShrinks());
+}
+
+static void test_shrinks_once_per_write_on_low_heap(void)
+{
+    AdaptiveFlushPolicy policy;
+    policy.setLimits(20, 0);
+    growTo(policy, 16);
+    policy.onRecord(0, HeapLow);
+    policy.onRecord(10, HeapLow);
+    policy.onRecord(20, HeapLow);
+    TEST_ASSERT_EQUAL(8, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::ShrinkMemory, policy.getLastDecision());
+    // still low after write
+    policy.onWrite(1000, true, HeapLow);
+    TEST_ASSERT_EQUAL(4, policy.getBatchSize());
+    policy.onRecord(30, HeapLow);
+    TEST_ASSERT_EQUAL(2, policy.getBatchSize());
+}
+
+static void test_limited_by_staleness(void)
+{
+    AdaptiveFlushPolicy policy;
+    policy.setLimits(20, 60);
+    growTo(policy, 20);
+    // a reading every 10 s, at most 6 fit in 60 s
+    for (uint32_t t = 0; t <= 50000; t += 10000)
+        policy.onRecord(t, HeapOk);
+    TEST_ASSERT_EQUAL(10000, policy.getInterval());
+    TEST_ASSERT_EQUAL(6, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::LimitStaleness, policy.getLastDecision());
+    policy.onWrite(1000, true, HeapOk);
+    TEST_ASSERT_EQUAL(6, policy.getBatchSize());
+}
+
+static void test_set_limits_keeps_learned_size(void)
+{
+    AdaptiveFlushPolicy policy;
+    policy.setLimits(20, 0);
+    growTo(policy, 12);
+    // same limits, e.g. write options set again
+    policy.setLimits(20, 0);
+    TEST_ASSERT_EQUAL(12, policy.getBatchSize());
+    TEST_ASSERT_EQUAL(AdaptiveFlushPolicy::Decision::Grow, policy.getLastDecision());
+    // higher maximum keeps size
+    policy.setLimits(30, 0);
+    TEST_ASSERT_EQUAL(12, policy.getBatchSize());
+    // lower maximum limits size
+    policy.setLimits(8, 0);
+    TEST_ASSERT_EQUAL(8, policy.getBatchSize());
+    policy.setLimits(0, 0);
+    TEST_ASSERT_EQUAL(1, policy.getBatchSize());
+}
+
+static void test_decision_names(void)
+{
+    TEST_ASSERT_EQUAL_STRING("grow", AdaptiveFlushPolicy::decisionToString(AdaptiveFlushPolicy::Decision::Grow));
+    TEST_ASSERT_EQUAL_STRING("limit_staleness", AdaptiveFlushPolicy::decisionToString(AdaptiveFlushPolicy::Decision::LimitStaleness));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_grows_on_slow_writes);
+    RUN_TEST(test_holds_on_fast_writes);
+    RUN_TEST(test_halves_on_failure);
+    RUN_TEST(test_shrinks_once_per_write_on_low_heap);
+    RUN_TEST(test_limited_by_staleness);
+    RUN_TEST(test_set_limits_keeps_learned_size);
+    RUN_TEST(test_decision_names);
+    return UNITY_END();
+}
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncWriter: writing through the sender task, events and status snapshots
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "AsyncWriter.h"
+
+static MockHTTPTransport *transport;
+static InfluxDBClient *client;
+
+void setUp(void)
+{
+    transport = new MockHTTPTransport();
+    client = new InfluxDBClient("http://localhost:8086", "org", "bucket", "token");
+    client->setHTTPTransport(transport);
+    client->setWriteOptions(WriteOptions().batchSize(2).bufferSize(10).flushInterval(0));
+}
+
+void tearDown(void)
+{
+    delete client;
+    delete transport;
+}
+
+static void test_writes_in_sender_task(void)
+{
+    AsyncWriter writer(*client);
+    // not running
+    TEST_ASSERT_FALSE(writer.write("m v=0i"));
+    TEST_ASSERT_EQUAL(1, writer.getRejected());
+
+    TEST_ASSERT_TRUE(writer.begin());
+    TEST_ASSERT_TRUE(writer.isRunning());
+    TEST_ASSERT_TRUE(writer.write("m v=1i"));
+    TEST_ASSERT_TRUE(writer.write("m v=2i"));
+    TEST_ASSERT_TRUE(writer.write("m v=3i"));
+    // rest of the buffer is flushed when stopping
+    writer.end();
+    TEST_ASSERT_FALSE(writer.isRunning());
+
+    TEST_ASSERT_EQUAL(2, transport->requests.size());
+    TEST_ASSERT_EQUAL_STRING("m v=1i\nm v=2i\n", transport->requests[0].body.c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=3i\n", transport->requests[1].body.c_str());
+
+    WriteEvent event;
+    uint32_t written = 0;
+    while (writer.pollEvent(event))
+    {
+        TEST_ASSERT_EQUAL(WriteEvent::Type::Written, event.type);
+        TEST_ASSERT_EQUAL(204, event.statusCode);
+        written += event.count;
+    }
+    TEST_ASSERT_EQUAL(2, written);
+}
+
+static void test_failed_writes_are_reported(void)
+{
+    transport->defaultStatus = 400;
+    AsyncWriter writer(*client);
+    TEST_ASSERT_TRUE(writer.begin());
+    TEST_ASSERT_TRUE(writer.write("m v=1i"));
+    TEST_ASSERT_TRUE(writer.write("m v=2i"));
+    writer.end();
+
+    WriteEvent event;
+    TEST_ASSERT_TRUE(writer.pollEvent(event));
+    TEST_ASSERT_EQUAL(WriteEvent::Type::Failed, event.type);
+    TEST_ASSERT_EQUAL(1, event.count);
+    TEST_ASSERT_EQUAL(400, event.statusCode);
+    // rejected batch is not retried
+    TEST_ASSERT_TRUE(writer.pollEvent(event));
+    TEST_ASSERT_EQUAL(WriteEvent::Type::Dropped, event.type);
+    TEST_ASSERT_EQUAL(2, event.count);
+    TEST_ASSERT_FALSE(writer.pollEvent(event));
+}
+
+static std::thread::id callbackThread;
+static WriteStats published;
+static int callbacks;
+
+static void onStatus(const InfluxDBClient &client)
+{
+    callbackThread = std::this_thread::get_id();
+    published = client.getWriteStats();
+    callbacks++;
+}
+
+static void test_status_callback_runs_in_sender_task(void)
+{
+    callbacks = 0;
+    AsyncWriter writer(*client);
+    writer.setStatusCallback(onStatus);
+    TEST_ASSERT_TRUE(writer.begin());
+    // initial state is published by begin()
+    TEST_ASSERT_TRUE(callbacks >= 1);
+    TEST_ASSERT_TRUE(writer.write("m v=1i"));
+    TEST_ASSERT_TRUE(writer.write("m v=2i"));
+    writer.end();
+    TEST_ASSERT_TRUE(callbackThread != std::this_thread::get_id());
+    TEST_ASSERT_EQUAL(2, published.pointsEnqueued);
+    TEST_ASSERT_EQUAL(1, published.batchesPosted);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_writes_in_sender_task);
+    RUN_TEST(test_failed_writes_are_reported);
+    RUN_TEST(test_status_callback_runs_in_sender_task);
+    return UNITY_END();
+}
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// InfluxDBClient with BatchStore: spilling and restoring batches across an outage
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <deque>
+#include "MockHTTPTransport.h"
+#include "InfluxDbClient.h"
+
+// Keeps batches in RAM, like FlashLog without the flash
+class MemoryBatchStore : public BatchStore
+{
+public:
+    bool push(const char *data, size_t length, uint16_t) override
+    {
+        batches.push_back(std::string(data, length));
+        return true;
+    }
+    bool isEmpty() override { return batches.empty(); }
+    size_t frontLength() override { return batches.empty() ? 0 : batches.front().size(); }
+    bool readFront(char *buffer) override
+    {
+        memcpy(buffer, batches.front().data(), batches.front().size());
+        return true;
+    }
+    void pop() override
+    {
+        if (!batches.empty())
+            batches.pop_front();
+    }
+    std::deque<std::string> batches;
+};
+
+static MockHTTPTransport *transport;
+static MemoryBatchStore *store;
+static InfluxDBClient *client;
+
+void setUp(void)
+{
+    transport = new MockHTTPTransport();
+    store = new MemoryBatchStore();
+    client = new InfluxDBClient("http://localhost:8086", "org", "bucket", "token");
+    client->setHTTPTransport(transport);
+    // write buffer of 2 batches
+    client->setWriteOptions(WriteOptions().batchSize(2).bufferSize(4).flushInterval(0));
+    client->setBatchStore(store);
+}
+
+void tearDown(void)
+{
+    delete client;
+    delete transport;
+    delete store;
+}
+
+static void writeRecords(int first, int last)
+{
+    char record[20];
+    for (int i = first; i <= last; i++)
+    {
+        snprintf(record, sizeof(record), "m v=%di", i);
+        client->writeRecord(record);
+    }
+}
+
+// Returns bodies of write requests sent since request index from
+static String writtenSince(size_t from)
+{
+    String written;
+    for (size_t i = from; i < transport->requests.size(); i++)
+        if (transport->requests[i].method == "POST")
+            written += transport->requests[i].body;
+    return written;
+}
+
+static void test_outage_keeps_order(void)
+{
+    transport->defaultStatus = HTTPC_ERROR_CONNECTION_REFUSED;
+    writeRecords(1, 1);
+    // partial batch is sent and waits for retry
+    TEST_ASSERT_FALSE(client->flushBuffer());
+    writeRecords(2, 9);
+    TEST_ASSERT_FALSE(store->isEmpty());
+    TEST_ASSERT_EQUAL(0, client->getWriteStats().pointsDropped);
+
+    // server is back, connection is validated first
+    transport->defaultStatus = 204;
+    transport->respond(200);
+    size_t from = transport->requests.size();
+    for (int i = 0; i < 10 && !(client->flushBuffer() && client->isBufferEmpty() && store->isEmpty()); i++)
+        ;
+    TEST_ASSERT_TRUE(store->isEmpty());
+    TEST_ASSERT_TRUE(client->isBufferEmpty());
+    String expected;
+    for (int i = 1; i <= 9; i++)
+        expected += "m v=" + String(i) + "i\n";
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), writtenSince(from).c_str());
+    TEST_ASSERT_EQUAL(0, client->getWriteStats().pointsDropped);
+    TEST_ASSERT_EQUAL(client->getWriteStats().batchesStored, client->getWriteStats().batchesRestored);
+}
+
+static void test_stored_batch_backs_off(void)
+{
+    store->push("m v=1i\n", 7, 1);
+    // server overloaded, no Retry-After
+    transport->defaultStatus = 503;
+    TEST_ASSERT_FALSE(client->flushBuffer());
+    size_t sent = transport->requests.size();
+    TEST_ASSERT_EQUAL(5, client->getRemainingRetryTime());
+    TEST_ASSERT_FALSE(client->flushBuffer());
+    TEST_ASSERT_EQUAL(sent, transport->requests.size());
+
+    hostAdvanceMillis(5000);
+    TEST_ASSERT_FALSE(client->flushBuffer());
+    TEST_ASSERT_EQUAL(sent + 1, transport->requests.size());
+    // exponential, like batches in write buffer
+    TEST_ASSERT_EQUAL(25, client->getRemainingRetryTime());
+
+    hostAdvanceMillis(25000);
+    transport->defaultStatus = 204;
+    TEST_ASSERT_TRUE(client->flushBuffer());
+    TEST_ASSERT_TRUE(store->isEmpty());
+    TEST_ASSERT_EQUAL(1, client->getWriteStats().batchesRestored);
+    TEST_ASSERT_EQUAL(0, client->getWriteStats().pointsDropped);
+}
+
+static void test_stored_batch_larger_than_batch_size(void)
+{
+    // stored before batch size was lowered
+    const char *batch = "m v=1i\nm v=2i\nm v=3i\nm v=4i\nm v=5i\n";
+    store->push(batch, strlen(batch), 5);
+    size_t from = transport->requests.size();
+    TEST_ASSERT_TRUE(client->flushBuffer());
+    TEST_ASSERT_EQUAL_STRING(batch, writtenSince(from).c_str());
+    TEST_ASSERT_EQUAL(1, client->getWriteStats().batchesRestored);
+    TEST_ASSERT_EQUAL(0, client->getWriteStats().storedBatchesDropped);
+
+    // batches in buffer keep configured size
+    from = transport->requests.size();
+    writeRecords(6, 7);
+    TEST_ASSERT_EQUAL_STRING("m v=6i\nm v=7i\n", writtenSince(from).c_str());
+}
+
+static void test_invalid_stored_batch_is_counted(void)
+{
+    store->push("m v=1i", 6, 1);
+    store->push("m v=2i\n", 7, 1);
+    size_t from = transport->requests.size();
+    TEST_ASSERT_TRUE(client->flushBuffer());
+    TEST_ASSERT_EQUAL_STRING("m v=2i\n", writtenSince(from).c_str());
+    TEST_ASSERT_EQUAL(1, client->getWriteStats().storedBatchesDropped);
+    TEST_ASSERT_TRUE(store->isEmpty());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_outage_keeps_order);
+    RUN_TEST(test_stored_batch_backs_off);
+    RUN_TEST(test_stored_batch_larger_than_batch_size);
+    RUN_TEST(test_invalid_stored_batch_is_counted);
+    return UNITY_END();
+}
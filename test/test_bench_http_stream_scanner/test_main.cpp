@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark HttpStreamScanner: multi-megabyte Flux CSV responses read into the line buffer vs.
+// readStringUntil(), with Content-Length, chunked, and with lines longer than the fixed buffer
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "Benchmark.h"
+#include "MockHTTPTransport.h"
+#include "query/HttpStreamScanner.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Previous scanner: a String per line from readStringUntil(), chunks joined by concatenation
+class StringStreamScanner
+{
+public:
+    StringStreamScanner(HTTPTransport *client, bool chunked)
+        : _client(client), _stream(client->getStreamPtr()), _len(client->getSize()), _chunked(chunked), _chunkHeader(chunked) {}
+
+    bool next()
+    {
+        while (_client->connected() && (_len > 0 || _len == -1))
+        {
+            _line = _stream->readStringUntil('\n');
+            int lineLen = _line.length();
+            if (lineLen == 0)
+            {
+                _error = HTTPC_ERROR_READ_TIMEOUT;
+                return false;
+            }
+            int r = lineLen + 1;
+            _line.trim();
+            if (!_chunked || !_chunkHeader)
+            {
+                _read += r;
+                if (_lastChunkLine.length() > 0)
+                {
+                    _line = _lastChunkLine + _line;
+                    _lastChunkLine = "";
+                }
+            }
+            if (_chunkHeader && r == 2)
+            {
+                _line = _lastChunkLine;
+                _lastChunkLine = "";
+                return true;
+            }
+            if (_chunkHeader)
+            {
+                _chunkLen = (int)strtol(_line.c_str(), NULL, 16);
+                _chunkHeader = false;
+                _read = 0;
+                if (_chunkLen == 0)
+                {
+                    _line = "";
+                    return false;
+                }
+                continue;
+            }
+            else if (_chunked && _read >= _chunkLen)
+            {
+                _lastChunkLine = _line;
+                _chunkHeader = true;
+                continue;
+            }
+            if (_len > 0)
+                _len -= r;
+            return true;
+        }
+        return false;
+    }
+
+    const String &getLine() const { return _line; }
+    int getError() const { return _error; }
+
+private:
+    HTTPTransport *_client;
+    Stream *_stream;
+    int _len;
+    String _line;
+    int _read = 0;
+    bool _chunked;
+    bool _chunkHeader;
+    int _chunkLen = 0;
+    String _lastChunkLine;
+    int _error = 0;
+};
+
+// Flux CSV of about size bytes, every longEvery-th row has a note of noteLength characters
+static String fluxCsv(size_t size, int longEvery = 0, size_t noteLength = 0)
+{
+    std::string body = "#datatype,string,long,dateTime:RFC3339,double,string,string\r\n"
+                       "#group,false,false,false,false,true,true\r\n"
+                       "#default,_result,,,,,\r\n"
+                       ",result,table,_time,_value,_field,mac\r\n";
+    body.reserve(size + noteLength + 100);
+    srand(5);
+    char row[128];
+    for (int i = 0; body.size() < size; i++)
+    {
+        if (longEvery && i % longEvery == longEvery - 1)
+        {
+            body += ",,1,2024-03-25T18:07:17Z," + std::string(noteLength, 'n') + ",note,a4:c1:38:17:35:30\r\n";
+            continue;
+        }
+        snprintf(row, sizeof(row), ",,0,2024-03-25T%02d:%02d:%02dZ,%d.%02d,temperature,a4:c1:38:17:%02x:%02x\r\n",
+                 i / 3600 % 24, i / 60 % 60, i % 60, rand() % 40, rand() % 100, rand() % 256, rand() % 256);
+        body += row;
+    }
+    return String(body);
+}
+
+// Chunked transfer encoding of data, chunks of up to maxChunk bytes.
+// The previous scanner cannot join a line split between CR and LF, boundaries are moved off that spot.
+static String chunked(const String &data, size_t maxChunk)
+{
+    std::string out;
+    out.reserve(data.length() + data.length() / maxChunk * 8 + 16);
+    srand(7);
+    char head[16];
+    for (size_t i = 0; i < data.length();)
+    {
+        size_t n = std::min<size_t>(1 + rand() % maxChunk, data.length() - i);
+        if (data[i + n - 1] == '\r')
+            n++;
+        snprintf(head, sizeof(head), "%X\r\n", (unsigned)n);
+        out += head;
+        out.append(data.c_str() + i, n);
+        out += "\r\n";
+        i += n;
+    }
+    out += "0\r\n\r\n";
+    return String(out);
+}
+
+struct Scanned
+{
+    long lines;
+    size_t bytes;
+    uint32_t hash;
+};
+
+static void hashLine(Scanned &s, const char *line, size_t length)
+{
+    s.lines++;
+    s.bytes += length;
+    for (size_t i = 0; i < length; i++)
+        s.hash = (s.hash ^ (uint8_t)line[i]) * 16777619u;
+    s.hash = (s.hash ^ '\n') * 16777619u;
+}
+
+static Scanned scanNew(HTTPTransport *transport, bool isChunked)
+{
+    Scanned s = {0, 0, 2166136261u};
+    HttpStreamScanner scanner(transport, isChunked);
+    const char *line;
+    size_t length;
+    while (scanner.next())
+    {
+        line = scanner.getLine(length);
+        hashLine(s, line, length);
+    }
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+    return s;
+}
+
+static Scanned scanOld(HTTPTransport *transport, bool isChunked)
+{
+    Scanned s = {0, 0, 2166136261u};
+    StringStreamScanner scanner(transport, isChunked);
+    while (scanner.next())
+        hashLine(s, scanner.getLine().c_str(), scanner.getLine().length());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+    return s;
+}
+
+// Response is queued and taken by a request before the timed scan, so copying the body is not measured
+template <class F>
+static double timeScan(MockHTTPTransport &transport, const String &body, int size, F scan, Scanned &result)
+{
+    double best = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        transport.respond(200, body, size);
+        transport.begin("http://localhost:8086/api/v2/query");
+        TEST_ASSERT_EQUAL(200, transport.sendRequest("POST"));
+        double ns = benchBestNs([&]() { result = scan(&transport, size < 0); }, 1);
+        if (i == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+static void benchScan(const char *name, const String &data, bool isChunked)
+{
+    String body = isChunked ? chunked(data, 4096) : data;
+    int size = isChunked ? -1 : (int)body.length();
+    MockHTTPTransport transport;
+    // TCP segments
+    transport.readChunk = 1460;
+    Scanned before, after;
+    double old = timeScan(transport, body, size, scanOld, before);
+    double now = timeScan(transport, body, size, scanNew, after);
+    TEST_ASSERT_EQUAL(before.lines, after.lines);
+    TEST_ASSERT_EQUAL(before.bytes, after.bytes);
+    TEST_ASSERT_EQUAL_HEX32(before.hash, after.hash);
+    char title[64];
+    snprintf(title, sizeof(title), "%s, %.1f MB", name, data.length() / 1e6);
+    benchReport(title, old / before.lines, now / after.lines, "ns/line");
+    printf("%-44s old %10.1f   new %10.1f   MB/s\n", "  throughput", data.length() / old * 1e3, data.length() / now * 1e3);
+}
+
+static void test_bench_content_length(void)
+{
+    benchScan("Content-Length", fluxCsv(4000000), false);
+}
+
+static void test_bench_chunked(void)
+{
+    benchScan("chunked", fluxCsv(4000000), true);
+}
+
+// Every 200th line is 3 kB, read through the heap buffer
+static void test_bench_long_lines(void)
+{
+    benchScan("lines over buffer size", fluxCsv(4000000, 200, 3000), false);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_content_length);
+    RUN_TEST(test_bench_chunked);
+    RUN_TEST(test_bench_long_lines);
+    return UNITY_END();
+}
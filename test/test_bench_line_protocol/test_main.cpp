@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark LineProtocolWriter: formatting into a fixed buffer vs. Point, before and now
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "Benchmark.h"
+#include "BaselinePoint.h"
+#include "LineProtocolWriter.h"
+#include "Point.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+struct Reading
+{
+    double temperature;
+    double humidity;
+    double battVoltage;
+    int battLevel;
+    unsigned long long timestamp;
+};
+
+static const int Count = 1000;
+static Reading readings[Count];
+
+static void makeReadings()
+{
+    srand(3);
+    for (int i = 0; i < Count; i++)
+        readings[i] = {(rand() % 6000 - 1000) / 100.0, (rand() % 10000) / 100.0, (2500 + rand() % 700) / 1000.0, rand() % 101, 1711390037ULL + i};
+}
+
+template <class P>
+static String pointLine(const Reading &r)
+{
+    P point("environment");
+    point.addTag("device", "a4:c1:38:17:35:30");
+    point.addField("temperature", r.temperature, 2);
+    point.addField("humidity", r.humidity, 2);
+    point.addField("batt_voltage", r.battVoltage, 3);
+    point.addField("batt_level", r.battLevel);
+    point.setTime(r.timestamp);
+    return point.toLineProtocol();
+}
+
+static size_t writerLine(LineProtocolWriter &w, const Reading &r)
+{
+    w.reset();
+    w.measurement("environment").tag("device", "a4:c1:38:17:35:30");
+    w.field("temperature", r.temperature, 2).field("humidity", r.humidity, 2).field("batt_voltage", r.battVoltage, 3);
+    w.field("batt_level", r.battLevel).timestamp(r.timestamp);
+    return w.length();
+}
+
+static void test_bench_reading_line(void)
+{
+    makeReadings();
+    char buff[160];
+    LineProtocolWriter w(buff, sizeof(buff));
+    for (int i = 0; i < Count; i++)
+    {
+        writerLine(w, readings[i]);
+        TEST_ASSERT_EQUAL_STRING(pointLine<BaselinePoint>(readings[i]).c_str(), w.c_str());
+        TEST_ASSERT_EQUAL_STRING(pointLine<Point>(readings[i]).c_str(), w.c_str());
+    }
+
+    size_t sum = 0;
+    double baseline = benchBestNs([&]() {
+        for (int i = 0; i < Count; i++)
+            sum += pointLine<BaselinePoint>(readings[i]).length();
+    });
+    double point = benchBestNs([&]() {
+        for (int i = 0; i < Count; i++)
+            sum += pointLine<Point>(readings[i]).length();
+    });
+    double writer = benchBestNs([&]() {
+        for (int i = 0; i < Count; i++)
+            sum += writerLine(w, readings[i]);
+    });
+    benchKeep(sum);
+    benchReport("previous Point vs. LineProtocolWriter", baseline / Count, writer / Count, "ns/line");
+    benchReport("Point vs. LineProtocolWriter", point / Count, writer / Count, "ns/line");
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_reading_line);
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark MiThDecoder: decoding in place vs. copying the service data for every byte
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <string>
+#include "Benchmark.h"
+#include "MiThDecoder.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static const uint8_t FrameCustom[] = {0x30, 0x35, 0x17, 0x38, 0xc1, 0xa4, 0xbc, 0x07, 0xa8, 0x16, 0x71, 0x0b, 0x50, 0x2e, 0x04};
+static const uint8_t FrameATC1441[] = {0xa4, 0xc1, 0x38, 0x17, 0x35, 0x30, 0x00, 0xc6, 0x3a, 0x50, 0x0b, 0x71, 0x2e};
+
+// Like NimBLEAdvertisedDevice::getServiceData(): finds service data in the payload and returns a copy
+static std::string getServiceData(const uint8_t *payload, size_t len)
+{
+    const uint8_t *sd;
+    size_t sdLen;
+    if (!miThFindServiceData(payload, len, &sd, &sdLen))
+        return std::string();
+    return std::string(reinterpret_cast<const char *>(sd), sdLen);
+}
+
+// Previous getData(), one getServiceData() call for the length and for every byte.
+// Low bytes are masked, the previous code sign extended them (fixed by the decoder)
+static bool decodeOld(const uint8_t *payload, size_t size, MiThData_t &data)
+{
+    int len = getServiceData(payload, size).length();
+    if (len == 15)
+    {
+        int temp_msb = getServiceData(payload, size).c_str()[7];
+        int temp_lsb = getServiceData(payload, size).c_str()[6];
+        data.temperature = (temp_msb << 8) | (temp_lsb & 0xff);
+        int hum_msb = getServiceData(payload, size).c_str()[9];
+        int hum_lsb = getServiceData(payload, size).c_str()[8];
+        data.humidity = (hum_msb << 8) | (hum_lsb & 0xff);
+        int volt_msb = getServiceData(payload, size).c_str()[11];
+        int volt_lsb = getServiceData(payload, size).c_str()[10];
+        data.batt_voltage = (volt_msb << 8) | (volt_lsb & 0xff);
+        data.batt_level = getServiceData(payload, size).c_str()[12];
+        data.counter = getServiceData(payload, size).c_str()[13];
+        return true;
+    }
+    if (len == 13)
+    {
+        int temp_lsb = getServiceData(payload, size).c_str()[7];
+        int temp_msb = getServiceData(payload, size).c_str()[6];
+        data.temperature = ((temp_msb << 8) | (temp_lsb & 0xff)) * 10;
+        data.humidity = getServiceData(payload, size).c_str()[8];
+        data.humidity *= 100;
+        int volt_lsb = getServiceData(payload, size).c_str()[11];
+        int volt_msb = getServiceData(payload, size).c_str()[10];
+        data.batt_voltage = (volt_msb << 8) | (volt_lsb & 0xff);
+        data.batt_level = getServiceData(payload, size).c_str()[9];
+        data.counter = getServiceData(payload, size).c_str()[12];
+        return true;
+    }
+    return false;
+}
+
+static bool decodeNew(const uint8_t *payload, size_t size, MiThData_t &data)
+{
+    const uint8_t *sd;
+    size_t len;
+    return miThFindServiceData(payload, size, &sd, &len) && miThDecode(sd, len, data);
+}
+
+// Flags, service data and a complete local name, as sent by the sensors
+static size_t advertisement(uint8_t *payload, const uint8_t *frame, size_t frameLen)
+{
+    static const uint8_t flags[] = {0x02, 0x01, 0x06};
+    static const char name[] = "ATC_173530";
+    size_t n = 0;
+    memcpy(payload, flags, sizeof(flags));
+    n += sizeof(flags);
+    payload[n++] = 3 + frameLen;
+    payload[n++] = 0x16;
+    payload[n++] = 0x1a;
+    payload[n++] = 0x18;
+    memcpy(payload + n, frame, frameLen);
+    n += frameLen;
+    payload[n++] = sizeof(name);
+    payload[n++] = 0x09;
+    memcpy(payload + n, name, sizeof(name) - 1);
+    return n + sizeof(name) - 1;
+}
+
+static void benchDecode(const char *name, const uint8_t *frame, size_t frameLen)
+{
+    uint8_t payload[64];
+    size_t size = advertisement(payload, frame, frameLen);
+    MiThData_t before = {}, after = {};
+    TEST_ASSERT_TRUE(decodeOld(payload, size, before));
+    TEST_ASSERT_TRUE(decodeNew(payload, size, after));
+    TEST_ASSERT_EQUAL(before.temperature, after.temperature);
+    TEST_ASSERT_EQUAL(before.humidity, after.humidity);
+    TEST_ASSERT_EQUAL(before.batt_voltage, after.batt_voltage);
+    TEST_ASSERT_EQUAL(before.batt_level, after.batt_level);
+    TEST_ASSERT_EQUAL(before.counter, after.counter);
+
+    const int count = 100000;
+    MiThData_t data = {};
+    double old = benchBestNs([&]() {
+        for (int i = 0; i < count; i++)
+        {
+            benchKeep(payload);
+            decodeOld(payload, size, data);
+            benchKeep(data);
+        }
+    });
+    double now = benchBestNs([&]() {
+        for (int i = 0; i < count; i++)
+        {
+            benchKeep(payload);
+            decodeNew(payload, size, data);
+            benchKeep(data);
+        }
+    });
+    benchReport(name, old / count, now / count, "ns/frame");
+}
+
+static void test_bench_decode(void)
+{
+    benchDecode("custom format (15 bytes)", FrameCustom, sizeof(FrameCustom));
+    benchDecode("ATC1441 format (13 bytes)", FrameATC1441, sizeof(FrameATC1441));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_decode);
+    return UNITY_END();
+}
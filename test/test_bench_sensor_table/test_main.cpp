@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark SensorTable: hashed lookup vs. matching every known MAC string per scan result
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <stdlib.h>
+#include <vector>
+#include "Benchmark.h"
+#include "SensorTable.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Previous getData(): every scan result is compared with BLEAddress(known_sensors[n]),
+// which parses the MAC string each time
+static uint64_t parseAddress(const char *mac)
+{
+    unsigned char b[6];
+    if (sscanf(mac, "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6)
+        return 0;
+    uint64_t key = 0;
+    for (int i = 0; i < 6; i++)
+        key = key << 8 | b[i];
+    return key;
+}
+
+static int findLinear(const std::vector<const char *> &known, uint64_t address)
+{
+    int found = -1;
+    for (size_t n = 0; n < known.size(); n++)
+        if (address == parseAddress(known[n]))
+            found = n;
+    return found;
+}
+
+static void benchLookup(size_t sensors, size_t advertisements)
+{
+    static char macs[64][18];
+    SensorTable<64> table({});
+    std::vector<const char *> known;
+    srand(1);
+    for (size_t i = 0; i < sensors; i++)
+    {
+        SensorTableBase::formatMac(0xa4c138000000ull | (rand() & 0xffffff), macs[i]);
+        TEST_ASSERT_EQUAL(i, table.add(macs[i]));
+        known.push_back(macs[i]);
+    }
+    // every 4th advertisement is from a known sensor, the rest from other BLE devices around
+    std::vector<uint64_t> scan;
+    for (size_t i = 0; i < advertisements; i++)
+        scan.push_back(i % 4 ? ((uint64_t)rand() << 24 | rand()) & 0xffffffffffffull : table.mac(i / 4 % sensors));
+
+    for (uint64_t address : scan)
+        TEST_ASSERT_EQUAL(findLinear(known, address), table.find(address));
+
+    long sum = 0;
+    double before = benchBestNs([&]() {
+        for (uint64_t address : scan)
+            sum += findLinear(known, address);
+    });
+    double after = benchBestNs([&]() {
+        for (uint64_t address : scan)
+            sum += table.find(address);
+    });
+    benchKeep(sum);
+    char name[64];
+    snprintf(name, sizeof(name), "%u sensors, %uk advertisements", (unsigned)sensors, (unsigned)(advertisements / 1000));
+    benchReport(name, before / advertisements, after / advertisements, "ns/adv");
+}
+
+static void test_bench_lookup(void)
+{
+    benchLookup(3, 1000);
+    benchLookup(3, 10000);
+    benchLookup(16, 1000);
+    benchLookup(16, 10000);
+    benchLookup(64, 10000);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_lookup);
+    return UNITY_END();
+}
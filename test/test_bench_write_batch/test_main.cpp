@@ -0,0 +1,341 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark InfluxDBClient::Batch: line arena vs. one strdup() per line, building the request body
+// and streaming it to a loopback HTTP server
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "LoopbackHTTPServer.h"
+#include "InfluxDbClient.h"
+#include "PosixHTTPTransport.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Previous Batch: an array of separately allocated lines
+class StrdupBatch
+{
+public:
+    uint16_t pointer = 0;
+    char **buffer = nullptr;
+
+    StrdupBatch(uint16_t size) : _size(size)
+    {
+        buffer = new char *[size];
+        for (int i = 0; i < _size; i++)
+            buffer[i] = nullptr;
+    }
+
+    ~StrdupBatch()
+    {
+        clear();
+        delete[] buffer;
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < _size; i++)
+        {
+            free(buffer[i]);
+            buffer[i] = nullptr;
+        }
+    }
+
+    bool append(const char *line)
+    {
+        if (pointer == _size)
+        {
+            clear();
+            pointer = 0;
+        }
+        buffer[pointer] = strdup(line);
+        ++pointer;
+        return pointer == _size;
+    }
+
+    // Joins lines into a new buffer, strcat() scans the whole buffer for every line
+    char *createData()
+    {
+        int length = 0;
+        char *buff = nullptr;
+        for (int c = 0; c < pointer; c++)
+            length += strlen(buffer[c]);
+        if (length)
+        {
+            buff = new char[length + pointer + 1];
+            buff[0] = 0;
+            for (int c = 0; c < pointer; c++)
+            {
+                strcat(buff + strlen(buff), buffer[c]);
+                strcat(buff + strlen(buff), "\n");
+            }
+        }
+        return buff;
+    }
+
+private:
+    uint16_t _size;
+};
+
+// Previous BatchStreamer: walks the lines of a StrdupBatch, readBytes() calls read() for every byte
+class ByteBatchStreamer : public Stream
+{
+public:
+    ByteBatchStreamer(StrdupBatch *batch) : _batch(batch)
+    {
+        for (uint16_t i = 0; i < _batch->pointer; i++)
+            _length += strlen(_batch->buffer[i]) + 1;
+    }
+
+    int available() override { return _length - _read; }
+
+    size_t readBytes(char *buffer, size_t len) override
+    {
+        unsigned int r = 0;
+        for (unsigned int i = 0; i < len; i++)
+        {
+            if (available())
+            {
+                buffer[i] = read();
+                r++;
+            }
+            else
+                break;
+        }
+        return r;
+    }
+
+    int read() override
+    {
+        int r = peek();
+        if (r > 0)
+        {
+            ++_read;
+            ++_linePointer;
+            if (!_batch->buffer[_pointer][_linePointer - 1])
+            {
+                ++_pointer;
+                _linePointer = 0;
+            }
+        }
+        return r;
+    }
+
+    int peek() override
+    {
+        if (_pointer == _batch->pointer)
+            return -1;
+        if (!_batch->buffer[_pointer][_linePointer])
+            return '\n';
+        return _batch->buffer[_pointer][_linePointer];
+    }
+
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    StrdupBatch *_batch;
+    int _length = 0;
+    int _read = 0;
+    uint16_t _pointer = 0;
+    uint16_t _linePointer = 0;
+};
+
+// Readings of a few sensors, as written by the firmware
+static std::vector<std::string> makeLines(size_t count)
+{
+    std::vector<std::string> lines;
+    char line[160];
+    for (size_t i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "sensor,mac=a4:c1:38:%02x:35:30 temperature=%d.%02d,humidity=%d.%02d,batt_voltage=2.9%d,batt_level=%ui %llu",
+                 (unsigned)(i % 16), 18 + (int)(i % 7), (int)(i * 37 % 100), 40 + (int)(i % 13), (int)(i * 11 % 100),
+                 (int)(i % 10), (unsigned)(80 + i % 20), 1700000000ull + i * 60);
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Batch is private to the client, Test is its friend
+class Test
+{
+public:
+    typedef InfluxDBClient::Batch Batch;
+
+    static void benchFill(uint16_t batchSize)
+    {
+        std::vector<std::string> lines = makeLines(batchSize);
+        {
+            StrdupBatch before(batchSize);
+            Batch after(batchSize, batchSize);
+            for (const std::string &line : lines)
+            {
+                before.append(line.c_str());
+                TEST_ASSERT_TRUE(after.append(line.c_str(), line.size()));
+            }
+            for (uint16_t i = 0; i < batchSize; i++)
+            {
+                size_t length;
+                const char *line = after.getLine(i, length);
+                TEST_ASSERT_EQUAL(strlen(before.buffer[i]), length);
+                TEST_ASSERT_EQUAL_STRING_LEN(before.buffer[i], line, length);
+            }
+        }
+
+        // a batch is created, filled and deleted once it is written
+        const int rounds = 20000 / batchSize + 1;
+        double old = benchBestNs([&]() {
+            for (int r = 0; r < rounds; r++)
+            {
+                StrdupBatch *batch = new StrdupBatch(batchSize);
+                for (const std::string &line : lines)
+                    batch->append(line.c_str());
+                benchKeep(batch->buffer[batchSize - 1]);
+                delete batch;
+            }
+        });
+        double now = benchBestNs([&]() {
+            for (int r = 0; r < rounds; r++)
+            {
+                Batch *batch = new Batch(batchSize, batchSize);
+                for (const std::string &line : lines)
+                    batch->append(line.c_str(), line.size());
+                benchKeep(batch->_data);
+                delete batch;
+            }
+        });
+        char name[64];
+        snprintf(name, sizeof(name), "fill batch of %u lines", (unsigned)batchSize);
+        benchReport(name, old / rounds / batchSize, now / rounds / batchSize, "ns/line");
+    }
+
+    // Request body: previously joined into a new buffer and measured with strlen() before posting,
+    // now the arena is posted as is with its running length
+    static void benchBody(uint16_t batchSize)
+    {
+        std::vector<std::string> lines = makeLines(batchSize);
+        StrdupBatch before(batchSize);
+        Batch after(batchSize, batchSize);
+        for (const std::string &line : lines)
+        {
+            before.append(line.c_str());
+            after.append(line.c_str(), line.size());
+        }
+        char *data = before.createData();
+        TEST_ASSERT_EQUAL(strlen(data), after.getLength());
+        TEST_ASSERT_EQUAL_STRING(data, after.getData());
+        delete[] data;
+
+        const int rounds = 20000 / batchSize + 1;
+        size_t sent = 0;
+        double old = benchBestNs([&]() {
+            for (int r = 0; r < rounds; r++)
+            {
+                char *data = before.createData();
+                sent += strlen(data);
+                benchKeep(data);
+                delete[] data;
+            }
+        });
+        double now = benchBestNs([&]() {
+            for (int r = 0; r < rounds; r++)
+            {
+                benchKeep(after);
+                const char *data = after.getData();
+                sent += after.getLength();
+                benchKeep(data);
+            }
+        });
+        benchKeep(sent);
+        char name[64];
+        snprintf(name, sizeof(name), "request body of %u lines", (unsigned)batchSize);
+        benchReport(name, old / rounds, now / rounds, "ns/batch");
+    }
+
+    // Stream write mode: the body is pulled from the streamer in transfer-buffer sized chunks
+    // and posted over a kept-alive loopback connection
+    static void benchStream(uint16_t batchSize)
+    {
+        LoopbackHTTPServer server;
+        TEST_ASSERT_TRUE(server.start());
+        PosixHTTPTransport transport;
+        transport.setOptions(true, 5000);
+        String url = server.url() + "/api/v2/write?org=org&bucket=bucket";
+
+        std::vector<std::string> lines = makeLines(batchSize);
+        StrdupBatch before(batchSize);
+        Batch after(batchSize, batchSize);
+        for (const std::string &line : lines)
+        {
+            before.append(line.c_str());
+            after.append(line.c_str(), line.size());
+        }
+        auto postOld = [&]() {
+            ByteBatchStreamer stream(&before);
+            TEST_ASSERT_TRUE(transport.begin(url));
+            TEST_ASSERT_EQUAL(204, transport.sendRequest("POST", &stream, stream.available()));
+            transport.end();
+        };
+        auto postNew = [&]() {
+            InfluxDBClient::BatchStreamer stream(&after);
+            TEST_ASSERT_TRUE(transport.begin(url));
+            TEST_ASSERT_EQUAL(204, transport.sendRequest("POST", &stream, stream.available()));
+            transport.end();
+        };
+        postOld();
+        std::string body = server.lastRequest().body;
+        TEST_ASSERT_EQUAL(after.getLength(), body.size());
+        postNew();
+        TEST_ASSERT_TRUE(body == server.lastRequest().body);
+
+        const int rounds = 2000 / batchSize + 5;
+        double old = benchBestNs([&]() {
+            for (int r = 0; r < rounds; r++)
+                postOld();
+        });
+        double now = benchBestNs([&]() {
+            for (int r = 0; r < rounds; r++)
+                postNew();
+        });
+        TEST_ASSERT_EQUAL(1, server.connections);
+        char name[64];
+        snprintf(name, sizeof(name), "loopback POST of %u lines", (unsigned)batchSize);
+        benchReport(name, old / rounds / 1000, now / rounds / 1000, "us/batch");
+    }
+};
+
+static void test_bench_fill(void)
+{
+    Test::benchFill(10);
+    Test::benchFill(100);
+    Test::benchFill(1000);
+}
+
+static void test_bench_body(void)
+{
+    Test::benchBody(1);
+    Test::benchBody(100);
+    Test::benchBody(1000);
+}
+
+static void test_bench_stream(void)
+{
+    Test::benchStream(10);
+    Test::benchStream(100);
+    Test::benchStream(1000);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_fill);
+    RUN_TEST(test_bench_body);
+    RUN_TEST(test_bench_stream);
+    return UNITY_END();
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ChangeFilter: deadbands, heartbeat and commit of queued readings
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "ChangeFilter.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static const ChangeFilterBase::Config Config = {20, 100, 50, 5, 600};
+
+static MiThData_t reading(uint64_t timestamp, uint8_t counter, int16_t temperature)
+{
+    MiThData_t data = {};
+    data.valid = true;
+    data.timestamp = timestamp;
+    data.counter = counter;
+    data.temperature = temperature;
+    data.humidity = 5000;
+    data.batt_voltage = 2900;
+    data.batt_level = 80;
+    return data;
+}
+
+static void test_first_reading_passes(void)
+{
+    ChangeFilter<2> filter(Config);
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(100, 1, 2000)));
+    TEST_ASSERT_TRUE(filter.shouldSend(1, reading(100, 1, 2000)));
+}
+
+static void test_deadband_and_counter(void)
+{
+    ChangeFilter<1> filter(Config);
+    filter.commit(0, reading(100, 1, 2000));
+    // within deadband
+    TEST_ASSERT_FALSE(filter.shouldSend(0, reading(110, 2, 2020)));
+    // repeated advertisement of a measurement already seen
+    TEST_ASSERT_FALSE(filter.shouldSend(0, reading(110, 1, 2100)));
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(110, 2, 2021)));
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(110, 2, 1979)));
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getPassed());
+    TEST_ASSERT_EQUAL_UINT32(2, filter.getSuppressed());
+}
+
+static void test_heartbeat(void)
+{
+    ChangeFilter<1> filter(Config);
+    filter.commit(0, reading(100, 1, 2000));
+    TEST_ASSERT_FALSE(filter.shouldSend(0, reading(699, 1, 2000)));
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(700, 1, 2000)));
+}
+
+static void test_uncommitted_reading_keeps_baseline(void)
+{
+    ChangeFilter<1> filter(Config);
+    filter.commit(0, reading(100, 1, 2000));
+    // reading passes, but could not be queued and is not committed
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(110, 2, 2100)));
+    // next reading within the deadband of the skipped one still differs from what was sent
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(120, 3, 2110)));
+    filter.commit(0, reading(120, 3, 2110));
+    TEST_ASSERT_FALSE(filter.shouldSend(0, reading(130, 4, 2115)));
+}
+
+static void test_reset(void)
+{
+    ChangeFilter<1> filter(Config);
+    filter.commit(0, reading(100, 1, 2000));
+    TEST_ASSERT_FALSE(filter.shouldSend(0, reading(100, 1, 2000)));
+    filter.reset();
+    TEST_ASSERT_TRUE(filter.shouldSend(0, reading(100, 1, 2000)));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_reading_passes);
+    RUN_TEST(test_deadband_and_counter);
+    RUN_TEST(test_heartbeat);
+    RUN_TEST(test_uncommitted_reading_keeps_baseline);
+    RUN_TEST(test_reset);
+    return UNITY_END();
+}
@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HTTPService: kept open connections, idle timeout, reconnect and connection counters
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "InfluxDbClient.h"
+
+static MockHTTPTransport *transport;
+static InfluxDBClient *client;
+
+void setUp(void)
+{
+    transport = new MockHTTPTransport();
+    transport->keepAlive = true;
+    client = new InfluxDBClient("http://localhost:8086", "org", "bucket", "token");
+    client->setHTTPTransport(transport);
+}
+
+void tearDown(void)
+{
+    delete client;
+    delete transport;
+}
+
+static void test_without_reuse_every_request_connects(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(false));
+    transport->keepAlive = false;
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    ConnectionStats stats = client->getConnectionStats();
+    TEST_ASSERT_EQUAL(3, stats.connects);
+    TEST_ASSERT_EQUAL(0, stats.reuses);
+    TEST_ASSERT_EQUAL(3, transport->connects);
+}
+
+static void test_reuse_keeps_connection(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true));
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    ConnectionStats stats = client->getConnectionStats();
+    TEST_ASSERT_EQUAL(1, stats.connects);
+    TEST_ASSERT_EQUAL(2, stats.reuses);
+    TEST_ASSERT_EQUAL(1, transport->connects);
+    TEST_ASSERT_TRUE(client->isConnected());
+}
+
+static void test_idle_connection_is_closed(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true).idleTimeout(1000));
+    TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    hostAdvanceMillis(500);
+    TEST_ASSERT_TRUE(client->writeRecord("m v=2i"));
+    hostAdvanceMillis(1500);
+    TEST_ASSERT_TRUE(client->writeRecord("m v=3i"));
+    ConnectionStats stats = client->getConnectionStats();
+    TEST_ASSERT_EQUAL(2, stats.connects);
+    TEST_ASSERT_EQUAL(1, stats.reuses);
+    TEST_ASSERT_EQUAL(1, stats.idleCloses);
+    TEST_ASSERT_EQUAL(0, stats.reconnects);
+}
+
+static void test_closed_by_server_reconnects(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true));
+    TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    transport->serverClose();
+    // failed attempt is sent again over a new connection
+    TEST_ASSERT_TRUE(client->writeRecord("m v=2i"));
+    ConnectionStats stats = client->getConnectionStats();
+    TEST_ASSERT_EQUAL(1, stats.reconnects);
+    TEST_ASSERT_EQUAL(2, stats.connects);
+    TEST_ASSERT_EQUAL(0, client->getWriteStats().failures);
+    TEST_ASSERT_EQUAL_STRING("m v=2i\n", transport->requests.back().body.c_str());
+}
+
+static void test_closed_by_server_reconnects_stream(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true));
+    client->setStreamWrite(true);
+    TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    transport->serverClose();
+    TEST_ASSERT_TRUE(client->writeRecord("m v=2i"));
+    TEST_ASSERT_EQUAL(1, client->getConnectionStats().reconnects);
+    TEST_ASSERT_EQUAL_STRING("m v=2i\n", transport->requests.back().body.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_without_reuse_every_request_connects);
+    RUN_TEST(test_reuse_keeps_connection);
+    RUN_TEST(test_idle_connection_is_closed);
+    RUN_TEST(test_closed_by_server_reconnects);
+    RUN_TEST(test_closed_by_server_reconnects_stream);
+    return UNITY_END();
+}
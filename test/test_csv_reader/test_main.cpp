@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// CsvReader: splitting query response lines into fields
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "query/CsvReader.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static MockHTTPTransport transport;
+
+// Returns reader of body, served in chunks of readChunk bytes
+static CsvReader *reader(const char *body, size_t readChunk = 0)
+{
+    transport.respond(200, body);
+    transport.readChunk = readChunk;
+    transport.begin("http://localhost:8086/api/v2/query");
+    TEST_ASSERT_EQUAL(200, transport.sendRequest("POST"));
+    return new CsvReader(new HttpStreamScanner(&transport, false));
+}
+
+static void assertRow(CsvReader *csv, std::vector<const char *> expected)
+{
+    TEST_ASSERT_TRUE(csv->next());
+    const std::vector<String> &row = csv->getRow();
+    TEST_ASSERT_EQUAL(expected.size(), row.size());
+    for (size_t i = 0; i < expected.size(); i++)
+        TEST_ASSERT_EQUAL_STRING(expected[i], row[i].c_str());
+}
+
+static void test_plain_fields(void)
+{
+    CsvReader *csv = reader(",result,table,_value\r\n,_result,0,21.5\r\n");
+    assertRow(csv, {"", "result", "table", "_value"});
+    assertRow(csv, {"", "_result", "0", "21.5"});
+    TEST_ASSERT_FALSE(csv->next());
+    TEST_ASSERT_EQUAL(0, csv->getError());
+    TEST_ASSERT_EQUAL(0, csv->getRow().size());
+    delete csv;
+}
+
+static void test_quoted_fields(void)
+{
+    CsvReader *csv = reader("\"a,b\",\"say \"\"hi\"\"\",\"\",x\n\"\"\"\",end,\n");
+    assertRow(csv, {"a,b", "say \"hi\"", "", "x"});
+    assertRow(csv, {"\"", "end", ""});
+    TEST_ASSERT_FALSE(csv->next());
+    delete csv;
+}
+
+static void test_row_reuses_fields(void)
+{
+    // a shorter row must not keep fields of the longer one before it
+    CsvReader *csv = reader("a,b,c,d\ne\nf,g\n", 3);
+    assertRow(csv, {"a", "b", "c", "d"});
+    assertRow(csv, {"e"});
+    assertRow(csv, {"f", "g"});
+    TEST_ASSERT_FALSE(csv->next());
+    delete csv;
+}
+
+static void test_unterminated_last_row(void)
+{
+    CsvReader *csv = reader("#datatype,string,long\n,_result,\"last\"");
+    assertRow(csv, {"#datatype", "string", "long"});
+    assertRow(csv, {"", "_result", "last"});
+    TEST_ASSERT_FALSE(csv->next());
+    TEST_ASSERT_EQUAL(0, csv->getError());
+    delete csv;
+}
+
+static void test_error(void)
+{
+    // body shorter than announced length and connection closed
+    transport.respond(200, "a,b\nc", 100);
+    transport.readChunk = 0;
+    transport.begin("http://localhost:8086/api/v2/query");
+    transport.sendRequest("POST");
+    CsvReader csv(new HttpStreamScanner(&transport, false));
+    assertRow(&csv, {"a", "b"});
+    TEST_ASSERT_FALSE(csv.next());
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_LOST, csv.getError());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_plain_fields);
+    RUN_TEST(test_quoted_fields);
+    RUN_TEST(test_row_reuses_fields);
+    RUN_TEST(test_unterminated_last_row);
+    RUN_TEST(test_error);
+    return UNITY_END();
+}
@@ -0,0 +1,243 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// FlashLog: batch log on a file-backed NOR flash emulator
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <unistd.h>
+#include "util/FlashLog.h"
+
+// Flash image in a file, so a log can be reopened like after a restart.
+// Like NOR flash, erase sets all bits and write can only clear them.
+class FileFlashRegion : public FlashRegion
+{
+public:
+    FileFlashRegion(const char *path, uint32_t sectors) : _path(path), _size(sectors * SectorSize) {}
+    ~FileFlashRegion()
+    {
+        if (_file)
+            fclose(_file);
+    }
+    bool begin() override
+    {
+        if (_file)
+            return true;
+        _file = fopen(_path, "r+b");
+        if (!_file)
+        {
+            // new flash chip is erased
+            _file = fopen(_path, "w+b");
+            for (uint32_t i = 0; _file && i < _size; i++)
+                fputc(0xFF, _file);
+        }
+        return _file != nullptr;
+    }
+    uint32_t size() const override { return _size; }
+    bool read(uint32_t offset, void *buffer, size_t length) override
+    {
+        return offset + length <= _size && fseek(_file, offset, SEEK_SET) == 0 && fread(buffer, 1, length, _file) == length;
+    }
+    bool write(uint32_t offset, const void *data, size_t length) override
+    {
+        if (failWritesAfter == 0)
+            return false;
+        if (failWritesAfter > 0)
+            failWritesAfter--;
+        uint8_t current[SectorSize];
+        if (length > sizeof(current) || !read(offset, current, length))
+            return false;
+        for (size_t i = 0; i < length; i++)
+            current[i] &= static_cast<const uint8_t *>(data)[i];
+        return fseek(_file, offset, SEEK_SET) == 0 && fwrite(current, 1, length, _file) == length;
+    }
+    bool erase(uint32_t offset) override
+    {
+        uint8_t erased[SectorSize];
+        memset(erased, 0xFF, sizeof(erased));
+        erases[offset / SectorSize]++;
+        return fseek(_file, offset, SEEK_SET) == 0 && fwrite(erased, 1, sizeof(erased), _file) == sizeof(erased);
+    }
+
+    //! Number of writes that succeed before writes fail, like a power loss; -1 for no limit
+    int failWritesAfter = -1;
+    uint32_t erases[16] = {};
+
+private:
+    const char *_path;
+    uint32_t _size;
+    FILE *_file = nullptr;
+};
+
+static const char *FlashFile = "test_flash_log.bin";
+
+void setUp(void)
+{
+    unlink(FlashFile);
+}
+
+void tearDown(void)
+{
+    unlink(FlashFile);
+}
+
+static void pushBatch(FlashLog &log, int first, int count)
+{
+    char data[512];
+    size_t length = 0;
+    for (int i = 0; i < count; i++)
+        length += snprintf(data + length, sizeof(data) - length, "m v=%di\n", first + i);
+    TEST_ASSERT_TRUE(log.push(data, length, count));
+}
+
+static String front(FlashLog &log)
+{
+    size_t length = log.frontLength();
+    if (!length)
+        return String();
+    std::string data(length, 0);
+    TEST_ASSERT_TRUE(log.readFront(&data[0]));
+    return String(data);
+}
+
+static void test_begin_requires_two_sectors(void)
+{
+    FileFlashRegion small(FlashFile, 1);
+    FlashLog log(small);
+    TEST_ASSERT_FALSE(log.begin());
+    TEST_ASSERT_FALSE(log.push("m v=1i\n", 7, 1));
+}
+
+static void test_push_pop_in_order(void)
+{
+    FileFlashRegion flash(FlashFile, 4);
+    FlashLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_TRUE(log.isEmpty());
+    TEST_ASSERT_EQUAL(0, log.frontLength());
+    pushBatch(log, 1, 2);
+    pushBatch(log, 3, 1);
+    TEST_ASSERT_FALSE(log.isEmpty());
+    TEST_ASSERT_EQUAL_STRING("m v=1i\nm v=2i\n", front(log).c_str());
+    // front stays until popped
+    TEST_ASSERT_EQUAL_STRING("m v=1i\nm v=2i\n", front(log).c_str());
+    log.pop();
+    TEST_ASSERT_EQUAL_STRING("m v=3i\n", front(log).c_str());
+    log.pop();
+    TEST_ASSERT_TRUE(log.isEmpty());
+    // popping empty log does nothing
+    log.pop();
+    TEST_ASSERT_TRUE(log.isEmpty());
+}
+
+static void test_rejects_invalid_length(void)
+{
+    FileFlashRegion flash(FlashFile, 2);
+    FlashLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_FALSE(log.push("", 0, 0));
+    std::string big(FlashLog::maxLength() + 1, 'x');
+    TEST_ASSERT_FALSE(log.push(big.c_str(), big.size(), 1));
+    std::string max(FlashLog::maxLength(), 'x');
+    TEST_ASSERT_TRUE(log.push(max.c_str(), max.size(), 1));
+    TEST_ASSERT_EQUAL(FlashLog::maxLength(), log.frontLength());
+}
+
+static void test_survives_restart(void)
+{
+    {
+        FileFlashRegion flash(FlashFile, 4);
+        FlashLog log(flash);
+        TEST_ASSERT_TRUE(log.begin());
+        pushBatch(log, 1, 1);
+        pushBatch(log, 2, 1);
+        pushBatch(log, 3, 1);
+        log.pop();
+    }
+    FileFlashRegion flash(FlashFile, 4);
+    FlashLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    // consumed batch stays consumed
+    TEST_ASSERT_EQUAL_STRING("m v=2i\n", front(log).c_str());
+    pushBatch(log, 4, 1);
+    log.pop();
+    TEST_ASSERT_EQUAL_STRING("m v=3i\n", front(log).c_str());
+    log.pop();
+    TEST_ASSERT_EQUAL_STRING("m v=4i\n", front(log).c_str());
+    log.pop();
+    TEST_ASSERT_TRUE(log.isEmpty());
+}
+
+static void test_interrupted_write_is_skipped(void)
+{
+    {
+        FileFlashRegion flash(FlashFile, 4);
+        FlashLog log(flash);
+        TEST_ASSERT_TRUE(log.begin());
+        pushBatch(log, 1, 1);
+        // header and data written, power lost before commit
+        flash.failWritesAfter = 2;
+        TEST_ASSERT_FALSE(log.push("m v=2i\n", 7, 1));
+    }
+    FileFlashRegion flash(FlashFile, 4);
+    FlashLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL_STRING("m v=1i\n", front(log).c_str());
+    log.pop();
+    TEST_ASSERT_TRUE(log.isEmpty());
+    pushBatch(log, 3, 1);
+    TEST_ASSERT_EQUAL_STRING("m v=3i\n", front(log).c_str());
+}
+
+static void test_full_ring_drops_oldest_sector(void)
+{
+    FileFlashRegion flash(FlashFile, 3);
+    FlashLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    // 3 KB batches, one per sector
+    std::string batch(3000, 'x');
+    batch.back() = '\n';
+    for (int i = 0; i < 4; i++)
+    {
+        batch[0] = '0' + i;
+        TEST_ASSERT_TRUE(log.push(batch.c_str(), batch.size(), 10));
+    }
+    TEST_ASSERT_EQUAL(10, log.getDropped());
+    // oldest remaining batch
+    TEST_ASSERT_EQUAL('1', front(log)[0]);
+    log.pop();
+    TEST_ASSERT_EQUAL('2', front(log)[0]);
+    log.pop();
+    TEST_ASSERT_EQUAL('3', front(log)[0]);
+    log.pop();
+    TEST_ASSERT_TRUE(log.isEmpty());
+}
+
+static void test_wear_is_spread(void)
+{
+    FileFlashRegion flash(FlashFile, 4);
+    FlashLog log(flash);
+    TEST_ASSERT_TRUE(log.begin());
+    std::string batch(1000, 'x');
+    batch.back() = '\n';
+    // 4 batches per sector, ring passed 5 times
+    for (int i = 0; i < 80; i++)
+    {
+        TEST_ASSERT_TRUE(log.push(batch.c_str(), batch.size(), 1));
+        log.pop();
+    }
+    // each sector is erased once per pass
+    for (int i = 0; i < 4; i++)
+        TEST_ASSERT_EQUAL(5, flash.erases[i]);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_requires_two_sectors);
+    RUN_TEST(test_push_pop_in_order);
+    RUN_TEST(test_rejects_invalid_length);
+    RUN_TEST(test_survives_restart);
+    RUN_TEST(test_interrupted_write_is_skipped);
+    RUN_TEST(test_full_ring_drops_oldest_sector);
+    RUN_TEST(test_wear_is_spread);
+    return UNITY_END();
+}
@@ -0,0 +1,302 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GzipStream: round trip through an inflater, gzip framing and compressed writes
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "InfluxDbClient.h"
+#include "util/GzipStream.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Minimal RFC 1951 inflater for stored and fixed Huffman blocks, which is what GzipStream emits
+class Inflater
+{
+public:
+    Inflater(const std::string &data, size_t pos) : _data(data), _pos(pos) {}
+
+    // Returns false on invalid or unsupported data
+    bool inflate(std::string &out)
+    {
+        bool last;
+        do
+        {
+            last = bits(1);
+            int type = bits(2);
+            if (type == 0)
+            {
+                _bitCount = 0;
+                if (_pos + 4 > _data.size())
+                    return false;
+                size_t len = (uint8_t)_data[_pos] | (uint8_t)_data[_pos + 1] << 8;
+                _pos += 4;
+                if (_pos + len > _data.size())
+                    return false;
+                out.append(_data, _pos, len);
+                _pos += len;
+            }
+            else if (type == 1)
+            {
+                if (!fixedBlock(out))
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        } while (!last && !_error);
+        _bitCount = 0;
+        return !_error;
+    }
+    // Position after the deflate data
+    size_t position() const { return _pos; }
+
+private:
+    bool fixedBlock(std::string &out)
+    {
+        static const uint16_t lengthBase[] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t distBase[] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t distExtra[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        while (!_error)
+        {
+            int symbol = literalLength();
+            if (symbol < 256)
+            {
+                out += (char)symbol;
+            }
+            else if (symbol == 256)
+            {
+                return true;
+            }
+            else
+            {
+                symbol -= 257;
+                if (symbol >= 29)
+                    return false;
+                size_t length = lengthBase[symbol] + bits(lengthExtra[symbol]);
+                int code = reversed(5);
+                if (code >= 30)
+                    return false;
+                size_t distance = distBase[code] + bits(distExtra[code]);
+                if (distance > out.size())
+                    return false;
+                for (size_t i = 0; i < length; i++)
+                    out += out[out.size() - distance];
+            }
+        }
+        return false;
+    }
+
+    // Decodes fixed Huffman literal/length symbol
+    int literalLength()
+    {
+        int code = reversed(7);
+        if (code <= 0x17)
+            return 256 + code;
+        code = code << 1 | bits(1);
+        if (code >= 0x30 && code <= 0xBF)
+            return code - 0x30;
+        if (code >= 0xC0 && code <= 0xC7)
+            return 280 + code - 0xC0;
+        code = code << 1 | bits(1);
+        return 144 + code - 0x190;
+    }
+
+    // Reads Huffman code bits, MSB first
+    int reversed(int count)
+    {
+        int code = 0;
+        for (int i = 0; i < count; i++)
+            code = code << 1 | bits(1);
+        return code;
+    }
+
+    // Reads value bits, LSB first
+    int bits(int count)
+    {
+        int value = 0;
+        for (int i = 0; i < count; i++)
+        {
+            if (_bitCount == 0)
+            {
+                if (_pos >= _data.size())
+                {
+                    _error = true;
+                    return 0;
+                }
+                _byte = (uint8_t)_data[_pos++];
+                _bitCount = 8;
+            }
+            value |= (_byte & 1) << i;
+            _byte >>= 1;
+            _bitCount--;
+        }
+        return value;
+    }
+
+    const std::string &_data;
+    size_t _pos;
+    uint8_t _byte = 0;
+    int _bitCount = 0;
+    bool _error = false;
+};
+
+static uint32_t crc32(const std::string &data)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (unsigned char c : data)
+    {
+        crc ^= c;
+        for (int i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static uint32_t le32(const std::string &data, size_t pos)
+{
+    return (uint8_t)data[pos] | (uint8_t)data[pos + 1] << 8 | (uint8_t)data[pos + 2] << 16 | (uint32_t)(uint8_t)data[pos + 3] << 24;
+}
+
+// Reads whole stream in chunks of given size
+static std::string readAll(GzipStream &gz, size_t chunk)
+{
+    std::string out;
+    char buffer[256];
+    size_t n;
+    while ((n = gz.readBytes(buffer, chunk)) > 0)
+        out.append(buffer, n);
+    return out;
+}
+
+// Checks gzip framing and returns decompressed data
+static std::string gunzip(const std::string &gz)
+{
+    TEST_ASSERT_TRUE(gz.size() >= 18);
+    TEST_ASSERT_EQUAL(0x1F, (uint8_t)gz[0]);
+    TEST_ASSERT_EQUAL(0x8B, (uint8_t)gz[1]);
+    // deflate, no flags
+    TEST_ASSERT_EQUAL(8, gz[2]);
+    TEST_ASSERT_EQUAL(0, gz[3]);
+    std::string out;
+    Inflater inflater(gz, 10);
+    TEST_ASSERT_TRUE(inflater.inflate(out));
+    TEST_ASSERT_EQUAL(gz.size(), inflater.position() + 8);
+    TEST_ASSERT_EQUAL_HEX32(crc32(out), le32(gz, inflater.position()));
+    TEST_ASSERT_EQUAL(out.size(), le32(gz, inflater.position() + 4));
+    return out;
+}
+
+static std::string readings(int count)
+{
+    std::string data;
+    char line[160];
+    for (int i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "environment,device=a4:c1:38:%02x:%02x:%02x temperature=%d.%02d,humidity=%d.%02d,battery=%di %d000000000\n",
+                 i % 3, 0x10 + i % 3, 0x20 + i % 3, 20 + i % 5, i % 100, 40 + i % 7, (i * 7) % 100, 80 - i % 10, 1700000000 + i * 10);
+        data += line;
+    }
+    return data;
+}
+
+static void test_round_trip(void)
+{
+    std::string data = readings(50);
+    GzipStream gz(data.c_str(), data.size());
+    size_t length = gz.getLength();
+    TEST_ASSERT_EQUAL(length, gz.available());
+    std::string compressed = readAll(gz, 256);
+    TEST_ASSERT_EQUAL(length, compressed.size());
+    TEST_ASSERT_EQUAL(0, gz.available());
+    TEST_ASSERT_TRUE(compressed.size() < data.size() / 2);
+    TEST_ASSERT_TRUE(gunzip(compressed) == data);
+}
+
+static void test_chunk_size_does_not_change_output(void)
+{
+    std::string data = readings(20);
+    GzipStream gz(data.c_str(), data.size());
+    std::string whole = readAll(gz, 256);
+    gz.reset();
+    std::string small = readAll(gz, 7);
+    TEST_ASSERT_TRUE(whole == small);
+    gz.reset();
+    std::string bytes;
+    int c;
+    while (gz.peek() >= 0 && (c = gz.read()) >= 0)
+        bytes += (char)c;
+    TEST_ASSERT_TRUE(whole == bytes);
+}
+
+static void test_matches_beyond_window_and_long_runs(void)
+{
+    std::string data = readings(200) + std::string(1000, 'x') + readings(3);
+    TEST_ASSERT_TRUE(data.size() > 8192);
+    GzipStream gz(data.c_str(), data.size());
+    TEST_ASSERT_TRUE(gunzip(readAll(gz, 100)) == data);
+}
+
+static void test_small_and_binary_data(void)
+{
+    std::string empty;
+    GzipStream gz0(empty.c_str(), 0);
+    TEST_ASSERT_TRUE(gunzip(readAll(gz0, 10)).empty());
+
+    std::string one("m");
+    GzipStream gz1(one.c_str(), one.size());
+    TEST_ASSERT_TRUE(gunzip(readAll(gz1, 10)) == one);
+
+    std::string binary;
+    for (int i = 0; i < 1000; i++)
+        binary += (char)((i * 131) ^ (i >> 3));
+    GzipStream gz2(binary.c_str(), binary.size());
+    TEST_ASSERT_TRUE(gunzip(readAll(gz2, 64)) == binary);
+}
+
+static void test_client_sends_compressed_body(void)
+{
+    MockHTTPTransport transport;
+    InfluxDBClient client("http://localhost:8086", "org", "bucket", "token");
+    client.setHTTPTransport(&transport);
+    client.setWriteOptions(WriteOptions().batchSize(20).bufferSize(20).flushInterval(0).gzip(true));
+    std::string data = readings(20);
+    size_t start = 0, end;
+    while ((end = data.find('\n', start)) != std::string::npos)
+    {
+        TEST_ASSERT_TRUE(client.writeRecord(data.substr(start, end - start).c_str()));
+        start = end + 1;
+    }
+    TEST_ASSERT_EQUAL(1, transport.requests.size());
+    TEST_ASSERT_EQUAL_STRING("gzip", transport.requests[0].header("Content-Encoding").c_str());
+    std::string body = transport.requests[0].body;
+    TEST_ASSERT_TRUE(gunzip(body) == data);
+    WriteStats stats = client.getWriteStats();
+    TEST_ASSERT_EQUAL(body.size(), stats.bytesSent);
+    TEST_ASSERT_EQUAL(data.size(), stats.bytesUncompressed);
+
+    // too small to compress, sent as is
+    client.setWriteOptions(WriteOptions().batchSize(1).gzip(true));
+    TEST_ASSERT_TRUE(client.writeRecord("m v=1i"));
+    TEST_ASSERT_EQUAL(2, transport.requests.size());
+    TEST_ASSERT_EQUAL_STRING("", transport.requests[1].header("Content-Encoding").c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=1i\n", transport.requests[1].body.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_chunk_size_does_not_change_output);
+    RUN_TEST(test_matches_beyond_window_and_long_runs);
+    RUN_TEST(test_small_and_binary_data);
+    RUN_TEST(test_client_sends_compressed_body);
+    return UNITY_END();
+}
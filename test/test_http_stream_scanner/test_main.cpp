@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// HttpStreamScanner: splitting response bodies into lines across buffer refills
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "query/HttpStreamScanner.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static String repeat(char c, size_t count)
+{
+    String s;
+    while (count--)
+        s += c;
+    return s;
+}
+
+// Sends request, so the transport serves the queued response
+static void query(MockHTTPTransport &transport)
+{
+    transport.begin("http://localhost:8086/api/v2/query");
+    TEST_ASSERT_EQUAL(200, transport.sendRequest("POST"));
+}
+
+static String nextLine(HttpStreamScanner &scanner)
+{
+    size_t length;
+    if (!scanner.next())
+        return "<end>";
+    const char *line = scanner.getLine(length);
+    TEST_ASSERT_EQUAL(strlen(line), length);
+    return String(std::string(line, length));
+}
+
+static void test_lines(void)
+{
+    MockHTTPTransport transport;
+    transport.respond(200, "a,b\r\n\nc\n");
+    query(transport);
+    HttpStreamScanner scanner(&transport, false);
+    TEST_ASSERT_EQUAL_STRING("a,b", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("c", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+    TEST_ASSERT_EQUAL(3, scanner.getLinesNum());
+}
+
+static void test_unterminated_last_line(void)
+{
+    // last line is shorter than the one before, it is moved to the buffer start by the final refill
+    MockHTTPTransport transport;
+    transport.respond(200, "first line\nab");
+    query(transport);
+    HttpStreamScanner scanner(&transport, false);
+    TEST_ASSERT_EQUAL_STRING("first line", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("ab", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+}
+
+static void test_unterminated_last_line_unknown_length(void)
+{
+    MockHTTPTransport transport;
+    transport.respond(200, "first line\r\nab\r", -1);
+    transport.readChunk = 4;
+    query(transport);
+    HttpStreamScanner scanner(&transport, false);
+    TEST_ASSERT_EQUAL_STRING("first line", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("ab", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+}
+
+static void test_line_straddles_refill(void)
+{
+    // first read fills the buffer and ends inside the second line
+    String first = repeat('x', HttpStreamScanner::BufferSize - 10);
+    String second = repeat('y', 100);
+    MockHTTPTransport transport;
+    transport.respond(200, first + "\n" + second + "\nz\n");
+    query(transport);
+    HttpStreamScanner scanner(&transport, false);
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING(second.c_str(), nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("z", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+}
+
+static void test_small_reads(void)
+{
+    MockHTTPTransport transport;
+    transport.respond(200, "#datatype,string\r\n,result,table\r\n,_result,0");
+    transport.readChunk = 3;
+    query(transport);
+    HttpStreamScanner scanner(&transport, false);
+    TEST_ASSERT_EQUAL_STRING("#datatype,string", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING(",result,table", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING(",_result,0", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+}
+
+static void test_chunked(void)
+{
+    MockHTTPTransport transport;
+    transport.respond(200, "4\r\nab\nc\r\n3;ext=1\r\nde\n\r\n2\r\nfg\r\n0\r\nTrailer: x\r\n\r\n", -1);
+    transport.readChunk = 3;
+    query(transport);
+    HttpStreamScanner scanner(&transport, true);
+    TEST_ASSERT_EQUAL_STRING("ab", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("cde", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("fg", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+}
+
+static void test_chunked_connection_lost(void)
+{
+    MockHTTPTransport transport;
+    transport.respond(200, "8\r\nab\ncd", -1);
+    query(transport);
+    HttpStreamScanner scanner(&transport, true);
+    TEST_ASSERT_EQUAL_STRING("ab", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_LOST, scanner.getError());
+}
+
+// Line longer than the fixed buffer is read into heap, the following lines are read as before
+static void test_long_line(void)
+{
+    String first = repeat('x', 5000);
+    String second = repeat('y', HttpStreamScanner::BufferSize + 1);
+    MockHTTPTransport transport;
+    transport.respond(200, "a\n" + first + "\nb\n" + second + "\r\nc");
+    transport.readChunk = 700;
+    query(transport);
+    HttpStreamScanner scanner(&transport, false);
+    TEST_ASSERT_EQUAL_STRING("a", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING(first.c_str(), nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("b", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING(second.c_str(), nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("c", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+}
+
+static void test_long_line_chunked(void)
+{
+    String line = repeat('x', 3000);
+    char size[8];
+    snprintf(size, sizeof(size), "%x", (unsigned)line.length() + 1);
+    MockHTTPTransport transport;
+    transport.respond(200, "2\r\na\n\r\n" + String(size) + "\r\n" + line + "\n\r\n2\r\nb\n\r\n0\r\n\r\n", -1);
+    transport.readChunk = 512;
+    query(transport);
+    HttpStreamScanner scanner(&transport, true);
+    TEST_ASSERT_EQUAL_STRING("a", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING(line.c_str(), nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("b", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(0, scanner.getError());
+}
+
+static void test_line_too_long(void)
+{
+    MockHTTPTransport transport;
+    transport.respond(200, repeat('x', 4000) + "\n");
+    query(transport);
+    HttpStreamScanner scanner(&transport, false, 3000);
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(scanner).c_str());
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_TOO_LESS_RAM, scanner.getError());
+    // exactly at the limit
+    transport.respond(200, repeat('x', 2999) + "\n");
+    query(transport);
+    HttpStreamScanner limit(&transport, false, 3000);
+    TEST_ASSERT_EQUAL(2999, nextLine(limit).length());
+    TEST_ASSERT_EQUAL(0, limit.getError());
+    // fixed buffer only
+    transport.respond(200, repeat('x', HttpStreamScanner::BufferSize + 1) + "\n");
+    query(transport);
+    HttpStreamScanner fixed(&transport, false, HttpStreamScanner::BufferSize);
+    TEST_ASSERT_EQUAL_STRING("<end>", nextLine(fixed).c_str());
+    TEST_ASSERT_EQUAL(HTTPC_ERROR_TOO_LESS_RAM, fixed.getError());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lines);
+    RUN_TEST(test_unterminated_last_line);
+    RUN_TEST(test_unterminated_last_line_unknown_length);
+    RUN_TEST(test_line_straddles_refill);
+    RUN_TEST(test_small_reads);
+    RUN_TEST(test_chunked);
+    RUN_TEST(test_chunked_connection_lost);
+    RUN_TEST(test_long_line);
+    RUN_TEST(test_long_line_chunked);
+    RUN_TEST(test_line_too_long);
+    return UNITY_END();
+}
@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// LineProtocolWriter: escaping round trip, number formatting and overflow
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <stdlib.h>
+#include <math.h>
+#include <map>
+#include "BaselinePoint.h"
+#include "LineProtocolWriter.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Parsed line, as InfluxDB reads it
+struct Line
+{
+    std::string measurement;
+    std::map<std::string, std::string> tags;
+    // string field values unescaped, without quotes
+    std::map<std::string, std::string> fields;
+    std::string timestamp;
+};
+
+// Reads until one of stops, not escaped. Like InfluxDB, backslash escapes only special characters
+static std::string unescapeUntil(const char *&p, const char *stops, const char *special = "=, \t\n\r")
+{
+    std::string s;
+    while (*p && !strchr(stops, *p))
+    {
+        if (*p == '\\' && p[1] && strchr(special, p[1]))
+            p++;
+        s += *p++;
+    }
+    return s;
+}
+
+static bool parse(const char *p, Line &line)
+{
+    // equal sign is not special in measurement
+    line.measurement = unescapeUntil(p, ", ", ", \t\n\r");
+    while (*p == ',')
+    {
+        p++;
+        std::string key = unescapeUntil(p, "=");
+        if (*p++ != '=')
+            return false;
+        line.tags[key] = unescapeUntil(p, ", ");
+    }
+    if (*p++ != ' ')
+        return false;
+    do
+    {
+        std::string key = unescapeUntil(p, "=");
+        if (*p++ != '=')
+            return false;
+        std::string value;
+        if (*p == '"')
+        {
+            p++;
+            while (*p && *p != '"')
+            {
+                if (*p == '\\')
+                    p++;
+                value += *p++;
+            }
+            if (*p++ != '"')
+                return false;
+        }
+        else
+        {
+            while (*p && *p != ',' && *p != ' ')
+                value += *p++;
+        }
+        line.fields[key] = value;
+    } while (*p == ',' && *p++);
+    if (*p == ' ')
+        line.timestamp = ++p;
+    else if (*p)
+        return false;
+    return true;
+}
+
+static std::string randomText(int maxLength)
+{
+    static const char alphabet[] = "ab =,\\\"\t\n\r0";
+    std::string s;
+    int length = 1 + rand() % maxLength;
+    for (int i = 0; i < length; i++)
+        s += alphabet[rand() % (sizeof(alphabet) - 1)];
+    // trailing backslash would escape the following separator, line protocol cannot express it
+    if (s.back() == '\\')
+        s.back() = 'b';
+    return s;
+}
+
+static void test_line_parts(void)
+{
+    char buff[128];
+    LineProtocolWriter w(buff, sizeof(buff));
+    w.measurement("environment").tag("device", "a4:c1:38").tag("room", "kitchen");
+    TEST_ASSERT_FALSE(w.hasFields());
+    w.field("temperature", 21.456, 1).field("battery", 87).field("ok", true).field("fw", "1.2").timestamp(1711390037ULL);
+    TEST_ASSERT_TRUE(w.hasFields());
+    TEST_ASSERT_FALSE(w.overflow());
+    TEST_ASSERT_EQUAL_STRING("environment,device=a4:c1:38,room=kitchen temperature=21.5,battery=87i,ok=true,fw=\"1.2\" 1711390037", w.c_str());
+    TEST_ASSERT_EQUAL(strlen(w.c_str()), w.length());
+
+    w.reset();
+    w.measurement("m").field("v", 1U).field("nan", NAN).field("u", 18446744073709551615ULL);
+    // unsigned as integer, like Point
+    TEST_ASSERT_EQUAL_STRING("m v=1i,u=18446744073709551615i", w.c_str());
+}
+
+static void test_escaping(void)
+{
+    char buff[128];
+    LineProtocolWriter w(buff, sizeof(buff));
+    w.measurement("my meas,x=1").tag("t k=", "v,a l").field("f\"k", "say \"hi\" \\o/");
+    TEST_ASSERT_EQUAL_STRING("my\\ meas\\,x=1,t\\ k\\==v\\,a\\ l f\"k=\"say \\\"hi\\\" \\\\o/\"", w.c_str());
+    // sizes match escaped text
+    TEST_ASSERT_EQUAL(13, LineProtocolWriter::escapeKey(nullptr, "my meas,x=1", false));
+    TEST_ASSERT_EQUAL(6, LineProtocolWriter::escapeKey(nullptr, "t k="));
+    TEST_ASSERT_EQUAL(17, LineProtocolWriter::escapeValue(nullptr, "say \"hi\" \\o/"));
+}
+
+static void test_escaping_round_trip(void)
+{
+    srand(42);
+    char buff[512];
+    for (int i = 0; i < 2000; i++)
+    {
+        std::string measurement = randomText(8), tagKey = randomText(6), tagValue = randomText(6);
+        std::string fieldKey = randomText(6), fieldValue = randomText(10);
+        LineProtocolWriter w(buff, sizeof(buff));
+        w.measurement(measurement.c_str()).tag(tagKey.c_str(), tagValue.c_str()).field(fieldKey.c_str(), fieldValue.c_str()).timestamp(i);
+        TEST_ASSERT_FALSE(w.overflow());
+        Line line;
+        TEST_ASSERT_TRUE(parse(w.c_str(), line));
+        TEST_ASSERT_TRUE(line.measurement == measurement);
+        TEST_ASSERT_EQUAL(1, line.tags.size());
+        TEST_ASSERT_TRUE(line.tags[tagKey] == tagValue);
+        TEST_ASSERT_EQUAL(1, line.fields.size());
+        TEST_ASSERT_TRUE(line.fields[fieldKey] == fieldValue);
+        TEST_ASSERT_TRUE(line.timestamp == std::to_string(i));
+    }
+}
+
+// Same line as Point produced before it was formatted by LineProtocolWriter
+static void test_same_as_baseline_point(void)
+{
+    BaselinePoint point("env ,m");
+    point.addTag("device", "a4:c1 38");
+    point.addTag("k=", "v,1");
+    point.addField("temperature", 21.456, 1);
+    point.addField("battery", 87);
+    point.addField("fw", "1.2 \"beta\"");
+    point.addField("ok", false);
+    point.setTime(1711390037ULL);
+
+    char buff[128];
+    LineProtocolWriter w(buff, sizeof(buff));
+    w.measurement("env ,m").tag("device", "a4:c1 38").tag("k=", "v,1");
+    w.field("temperature", 21.456, 1).field("battery", 87).field("fw", "1.2 \"beta\"").field("ok", false).timestamp(1711390037ULL);
+    TEST_ASSERT_EQUAL_STRING(point.toLineProtocol().c_str(), w.c_str());
+}
+
+static String format(size_t (*f)(char *, long long), long long value)
+{
+    char out[LineProtocolWriter::MaxNumberLength];
+    return String(std::string(out, f(out, value)));
+}
+
+static void test_integers(void)
+{
+    TEST_ASSERT_EQUAL_STRING("0", format(LineProtocolWriter::formatInteger, 0).c_str());
+    TEST_ASSERT_EQUAL_STRING("-42", format(LineProtocolWriter::formatInteger, -42).c_str());
+    TEST_ASSERT_EQUAL_STRING("9223372036854775807", format(LineProtocolWriter::formatInteger, INT64_MAX).c_str());
+    TEST_ASSERT_EQUAL_STRING("-9223372036854775808", format(LineProtocolWriter::formatInteger, INT64_MIN).c_str());
+}
+
+static String fixed(double value, int decimalPlaces)
+{
+    char out[LineProtocolWriter::MaxNumberLength];
+    return String(std::string(out, LineProtocolWriter::formatFixed(out, value, decimalPlaces)));
+}
+
+static void test_fixed_rounding(void)
+{
+    TEST_ASSERT_EQUAL_STRING("21.46", fixed(21.456, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("-0.50", fixed(-0.5, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("3", fixed(2.5, 0).c_str());
+    TEST_ASSERT_EQUAL_STRING("-3", fixed(-2.5, 0).c_str());
+    // sign of any negative value is kept, like dtostrf()
+    TEST_ASSERT_EQUAL_STRING("-0.00", fixed(-0.001, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.000000001000", fixed(1e-9, 12).c_str());
+    TEST_ASSERT_EQUAL_STRING("100000000000000000000.00", fixed(1e20, 2).c_str());
+    // dtostrf() pads single digit to width 2, a space is not valid in a field value
+    TEST_ASSERT_EQUAL_STRING(" 7", baselineDoubleString(7.0, 0).c_str());
+    TEST_ASSERT_EQUAL_STRING("7", fixed(7.0, 0).c_str());
+    // longer than MaxNumberLength
+    TEST_ASSERT_EQUAL_STRING("1e+40", fixed(1e40, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("-1.2345678901234567e+30", fixed(-1.2345678901234567e30, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING(baselineDoubleString(0.1, 30).c_str(), fixed(0.1, 30).c_str());
+    TEST_ASSERT_EQUAL_STRING("0.10000000000000001", fixed(0.1, 31).c_str());
+}
+
+// Same digits as String(value, decimalPlaces) of the ESP32 core, which formatted fields before, ties included
+static void test_fixed_same_as_dtostrf(void)
+{
+    srand(7);
+    for (int i = 0; i < 100000; i++)
+    {
+        double value = (rand() - RAND_MAX / 2) / (double)(1 + rand() % 100000);
+        // every other value is a tie of its last digit
+        if (i % 2)
+            value = (long)(value * 1000) / 1000.0 + 0.0005;
+        int decimalPlaces = rand() % 12;
+        String expected = baselineDoubleString(value, decimalPlaces);
+        expected.trim();
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), fixed(value, decimalPlaces).c_str());
+    }
+}
+
+static String scaled(long long value, int scale, int decimalPlaces)
+{
+    char out[LineProtocolWriter::MaxNumberLength];
+    return String(std::string(out, LineProtocolWriter::formatScaled(out, value, scale, decimalPlaces)));
+}
+
+static void test_scaled(void)
+{
+    TEST_ASSERT_EQUAL_STRING("12.34", scaled(1234, 2, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("-0.05", scaled(-5, 2, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("12.3400", scaled(1234, 2, 4).c_str());
+    TEST_ASSERT_EQUAL_STRING("12.4", scaled(1236, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("-12.4", scaled(-1236, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("-0", scaled(-4, 1, 0).c_str());
+    TEST_ASSERT_EQUAL_STRING("3", scaled(3271, 3, 0).c_str());
+    // ties and numbers of more than 15 digits are formatted from the double, same as formatFixed()
+    TEST_ASSERT_EQUAL_STRING(fixed(12.35, 1).c_str(), scaled(1235, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING(fixed(-12.35, 1).c_str(), scaled(-1235, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING(fixed(1234567890123.45, 4).c_str(), scaled(123456789012345LL, 2, 4).c_str());
+    TEST_ASSERT_EQUAL_STRING(fixed(-9223372036854775.807, 3).c_str(), scaled(INT64_MIN + 1, 3, 3).c_str());
+
+    srand(11);
+    for (int i = 0; i < 100000; i++)
+    {
+        long long value = ((long long)rand() << 20 ^ rand()) % 100000000000LL - 50000000000LL;
+        int scale = rand() % 10, decimalPlaces = rand() % 10;
+        TEST_ASSERT_EQUAL_STRING(fixed(value / pow(10, scale), decimalPlaces).c_str(), scaled(value, scale, decimalPlaces).c_str());
+    }
+}
+
+static void test_overflow(void)
+{
+    char buff[16];
+    LineProtocolWriter w(buff, sizeof(buff));
+    w.measurement("m").field("v", 1);
+    TEST_ASSERT_FALSE(w.overflow());
+    w.field("long", "value that does not fit");
+    TEST_ASSERT_TRUE(w.overflow());
+    TEST_ASSERT_TRUE(w.length() >= sizeof(buff));
+    // truncated but terminated
+    TEST_ASSERT_EQUAL(sizeof(buff) - 1, strlen(w.c_str()));
+    w.reset();
+    TEST_ASSERT_FALSE(w.overflow());
+    TEST_ASSERT_EQUAL(0, w.length());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_line_parts);
+    RUN_TEST(test_escaping);
+    RUN_TEST(test_escaping_round_trip);
+    RUN_TEST(test_same_as_baseline_point);
+    RUN_TEST(test_integers);
+    RUN_TEST(test_fixed_rounding);
+    RUN_TEST(test_fixed_same_as_dtostrf);
+    RUN_TEST(test_scaled);
+    RUN_TEST(test_overflow);
+    return UNITY_END();
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MiThDecoder: service data layouts and advertisement parsing
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MiThDecoder.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Captured service data of the same measurement in both formats
+static const uint8_t FrameCustom[] = {0x30, 0x35, 0x17, 0x38, 0xc1, 0xa4, 0xbc, 0x07, 0xa8, 0x16, 0x71, 0x0b, 0x50, 0x2e, 0x04};
+static const uint8_t FrameATC1441[] = {0xa4, 0xc1, 0x38, 0x17, 0x35, 0x30, 0x00, 0xc6, 0x3a, 0x50, 0x0b, 0x71, 0x2e};
+
+static void test_decode_custom(void)
+{
+    MiThData_t data = {};
+    data.rssi = -70;
+    TEST_ASSERT_TRUE(miThDecode(FrameCustom, sizeof(FrameCustom), data));
+    TEST_ASSERT_EQUAL(1980, data.temperature);
+    TEST_ASSERT_EQUAL(5800, data.humidity);
+    TEST_ASSERT_EQUAL(2929, data.batt_voltage);
+    TEST_ASSERT_EQUAL(80, data.batt_level);
+    TEST_ASSERT_EQUAL(0x2e, data.counter);
+    // not part of the service data
+    TEST_ASSERT_EQUAL(-70, data.rssi);
+}
+
+static void test_decode_atc1441(void)
+{
+    MiThData_t data = {};
+    TEST_ASSERT_TRUE(miThDecode(FrameATC1441, sizeof(FrameATC1441), data));
+    TEST_ASSERT_EQUAL(1980, data.temperature);
+    TEST_ASSERT_EQUAL(5800, data.humidity);
+    TEST_ASSERT_EQUAL(2929, data.batt_voltage);
+    TEST_ASSERT_EQUAL(80, data.batt_level);
+    TEST_ASSERT_EQUAL(0x2e, data.counter);
+}
+
+static void test_decode_negative_temperature(void)
+{
+    uint8_t custom[sizeof(FrameCustom)];
+    memcpy(custom, FrameCustom, sizeof(custom));
+    // -5.25°C, little endian x 100
+    custom[6] = 0xf3;
+    custom[7] = 0xfd;
+    uint8_t atc[sizeof(FrameATC1441)];
+    memcpy(atc, FrameATC1441, sizeof(atc));
+    // -5.2°C, big endian x 10
+    atc[6] = 0xff;
+    atc[7] = 0xcc;
+
+    MiThData_t data = {};
+    TEST_ASSERT_TRUE(miThDecode(custom, sizeof(custom), data));
+    TEST_ASSERT_EQUAL(-525, data.temperature);
+    TEST_ASSERT_TRUE(miThDecode(atc, sizeof(atc), data));
+    TEST_ASSERT_EQUAL(-520, data.temperature);
+}
+
+static void test_unknown_length(void)
+{
+    MiThData_t data = {};
+    data.temperature = 1234;
+    TEST_ASSERT_NULL(miThFindLayout(14));
+    TEST_ASSERT_FALSE(miThDecode(FrameCustom, 14, data));
+    TEST_ASSERT_EQUAL(1234, data.temperature);
+}
+
+static void test_find_service_data(void)
+{
+    // flags, service data 0x181A, complete local name
+    uint8_t payload[3 + 4 + sizeof(FrameCustom) + 5];
+    size_t n = 0;
+    const uint8_t flags[] = {0x02, 0x01, 0x06};
+    memcpy(payload, flags, sizeof(flags));
+    n += sizeof(flags);
+    payload[n++] = 3 + sizeof(FrameCustom);
+    payload[n++] = 0x16;
+    payload[n++] = 0x1a;
+    payload[n++] = 0x18;
+    memcpy(payload + n, FrameCustom, sizeof(FrameCustom));
+    n += sizeof(FrameCustom);
+    const uint8_t name[] = {0x04, 0x09, 'A', 'T', 'C'};
+    memcpy(payload + n, name, sizeof(name));
+    n += sizeof(name);
+
+    const uint8_t *sd = nullptr;
+    size_t len = 0;
+    TEST_ASSERT_TRUE(miThFindServiceData(payload, n, &sd, &len));
+    TEST_ASSERT_EQUAL(sizeof(FrameCustom), len);
+    TEST_ASSERT_TRUE(sd == payload + 7);
+
+    // other service UUID
+    payload[5] = 0x1b;
+    TEST_ASSERT_FALSE(miThFindServiceData(payload, n, &sd, &len));
+}
+
+static void test_find_service_data_malformed(void)
+{
+    const uint8_t *sd;
+    size_t len;
+    // AD length beyond the payload
+    const uint8_t truncated[] = {0x02, 0x01, 0x06, 0x12, 0x16, 0x1a, 0x18, 0x30};
+    TEST_ASSERT_FALSE(miThFindServiceData(truncated, sizeof(truncated), &sd, &len));
+    // zero AD length ends the payload
+    const uint8_t zero[] = {0x00, 0x04, 0x16, 0x1a, 0x18, 0x30};
+    TEST_ASSERT_FALSE(miThFindServiceData(zero, sizeof(zero), &sd, &len));
+    // service data too short to hold the UUID
+    const uint8_t shortAd[] = {0x02, 0x16, 0x1a};
+    TEST_ASSERT_FALSE(miThFindServiceData(shortAd, sizeof(shortAd), &sd, &len));
+    TEST_ASSERT_FALSE(miThFindServiceData(truncated, 0, &sd, &len));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_decode_custom);
+    RUN_TEST(test_decode_atc1441);
+    RUN_TEST(test_decode_negative_temperature);
+    RUN_TEST(test_unknown_length);
+    RUN_TEST(test_find_service_data);
+    RUN_TEST(test_find_service_data_malformed);
+    return UNITY_END();
+}
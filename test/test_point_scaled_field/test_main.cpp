@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Point::addScaledField: exhaustive comparison with the previous float fields over the int16 range
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "BaselinePoint.h"
+#include "Point.h"
+#include "PointSchema.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static const long Pow10[] = {1, 10, 100, 1000, 10000};
+
+static String scaledField(long value, uint8_t scale, int decimalPlaces)
+{
+    Point point("m");
+    point.addScaledField("v", value, scale, decimalPlaces);
+    return point.toLineProtocol();
+}
+
+// String(value / 10^scale, decimalPlaces) of the ESP32 core, as the sketch wrote readings before.
+// Without its padding of a single digit to width 2, which addField(double) leaves out too.
+static String baselineField(long value, uint8_t scale, int decimalPlaces)
+{
+    String number = baselineDoubleString(value / (double)Pow10[scale], decimalPlaces);
+    number.trim();
+    return "m v=" + number;
+}
+
+static void test_examples(void)
+{
+    // centi-degrees and millivolts from the sensor
+    TEST_ASSERT_EQUAL_STRING("m v=21.37", scaledField(2137, 2, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=-5.20", scaledField(-520, 2, 2).c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=2.947", scaledField(2947, 3, 3).c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=2.95", scaledField(2947, 3, 2).c_str());
+    // sign is kept when value rounds to zero, like dtostrf()
+    TEST_ASSERT_EQUAL_STRING("m v=-0.0", scaledField(-4, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=12", scaledField(12, 0, 0).c_str());
+    // ties round the way dtostrf() does in double arithmetic, not always away from zero
+    TEST_ASSERT_EQUAL_STRING("m v=29.5", scaledField(2945, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=-327.4", scaledField(-32745, 2, 1).c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=-32", scaledField(-32500, 3, 0).c_str());
+}
+
+static void test_same_as_baseline(void)
+{
+    for (uint8_t scale = 0; scale <= 4; scale++)
+        for (int decimalPlaces = 0; decimalPlaces <= 5; decimalPlaces++)
+            for (long value = INT16_MIN; value <= INT16_MAX; value++)
+            {
+                String expected = baselineField(value, scale, decimalPlaces);
+                String actual = scaledField(value, scale, decimalPlaces);
+                if (actual != expected)
+                {
+                    char message[80];
+                    snprintf(message, sizeof(message), "value %ld, scale %d, decimal places %d", value, scale, decimalPlaces);
+                    TEST_ASSERT_EQUAL_STRING_MESSAGE(expected.c_str(), actual.c_str(), message);
+                }
+            }
+}
+
+// Readings of the sketch: previously written as Point fields of value / 100.0 and batt_voltage / 1000.0,
+// with the default 2 decimal places, now by PointSchema
+static void test_schema_same_as_baseline_point(void)
+{
+    const char *const tagKeys[] = {"device"};
+    const SchemaField fields[] = {
+        SchemaField::scaled("temperature", 2),
+        SchemaField::scaled("humidity", 2),
+        SchemaField::scaled("batt_voltage", 3),
+        SchemaField::integer("batt_level"),
+    };
+    PointSchema<1, 4> schema("thermometer-v2", tagKeys, fields);
+    TEST_ASSERT_TRUE(schema.isValid());
+    const char *tags[] = {"a4:c1:38:17:35:30"};
+    char line[192];
+    for (long value = INT16_MIN; value <= INT16_MAX; value++)
+    {
+        long humidity = (value * 7) & 0x7fff;
+        long battVoltage = (value * 13) & 0xfff;
+        size_t length = schema.toLineProtocol(line, sizeof(line), tags, {value, humidity, battVoltage, value & 0x7f}, 1711390037ULL);
+        TEST_ASSERT_TRUE(length < sizeof(line));
+
+        BaselinePoint point("thermometer-v2");
+        point.addTag("device", tags[0]);
+        point.addField("temperature", value / 100.0);
+        point.addField("humidity", humidity / 100.0);
+        point.addField("batt_voltage", battVoltage / 1000.0);
+        point.addField("batt_level", (int)(value & 0x7f));
+        point.setTime(1711390037ULL);
+        if (point.toLineProtocol() != line)
+            TEST_ASSERT_EQUAL_STRING(point.toLineProtocol().c_str(), line);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_examples);
+    RUN_TEST(test_same_as_baseline);
+    RUN_TEST(test_schema_same_as_baseline_point);
+    return UNITY_END();
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PointSchema: cached names, omitted tags, field types, truncation and allocation failure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include "PointSchema.h"
+#include "Point.h"
+
+// Makes the next nothrow array allocations fail, PointSchema allocates its text that way
+static bool failAllocation = false;
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return failAllocation ? nullptr : malloc(size);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void *operator new[](size_t size)
+{
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void setUp(void)
+{
+    failAllocation = false;
+}
+
+void tearDown(void)
+{
+}
+
+static const char *const TagKeys[] = {"device", "room"};
+static const SchemaField Fields[] = {
+    SchemaField::scaled("temperature", 2),
+    SchemaField::scaled("batt_voltage", 3, 3),
+    SchemaField::integer("rssi"),
+};
+
+static void test_line(void)
+{
+    PointSchema<2, 3> schema("environment", TagKeys, Fields);
+    TEST_ASSERT_TRUE(schema.isValid());
+    const char *tags[] = {"a4:c1:38", "kitchen"};
+    char buff[128];
+    size_t length = schema.toLineProtocol(buff, sizeof(buff), tags, {2150, 2947, -70}, 1711390037ULL);
+    TEST_ASSERT_EQUAL_STRING("environment,device=a4:c1:38,room=kitchen temperature=21.50,batt_voltage=2.947,rssi=-70i 1711390037", buff);
+    TEST_ASSERT_EQUAL(strlen(buff), length);
+    // no timestamp
+    schema.toLineProtocol(buff, sizeof(buff), tags, {-5, 0, 0});
+    TEST_ASSERT_EQUAL_STRING("environment,device=a4:c1:38,room=kitchen temperature=-0.05,batt_voltage=0.000,rssi=0i", buff);
+}
+
+static void test_empty_tags_are_omitted(void)
+{
+    PointSchema<2, 3> schema("environment", TagKeys, Fields);
+    char buff[128];
+    const char *first[] = {"", "kitchen"};
+    schema.toLineProtocol(buff, sizeof(buff), first, {1, 2, 3});
+    TEST_ASSERT_EQUAL_STRING("environment,room=kitchen temperature=0.01,batt_voltage=0.002,rssi=3i", buff);
+    const char *none[] = {nullptr, nullptr};
+    schema.toLineProtocol(buff, sizeof(buff), none, {1, 2, 3});
+    TEST_ASSERT_EQUAL_STRING("environment temperature=0.01,batt_voltage=0.002,rssi=3i", buff);
+
+    PointSchema<0, 3> untagged("environment", nullptr, Fields);
+    untagged.toLineProtocol(buff, sizeof(buff), nullptr, {1, 2, 3});
+    TEST_ASSERT_EQUAL_STRING("environment temperature=0.01,batt_voltage=0.002,rssi=3i", buff);
+}
+
+// Names and tag values are escaped like Point does
+static void test_same_as_point(void)
+{
+    const char *const tagKeys[] = {"k=ey"};
+    const SchemaField fields[] = {SchemaField::scaled("my field", 1, 1), SchemaField::integer("n,1")};
+    PointSchema<1, 2> schema("my meas,x", tagKeys, fields);
+    const char *tags[] = {"a b,c=d"};
+    char buff[128];
+    schema.toLineProtocol(buff, sizeof(buff), tags, {-215, 42}, 99);
+
+    Point point("my meas,x");
+    point.addTag("k=ey", tags[0]);
+    point.addScaledField("my field", -215, 1, 1);
+    point.addField("n,1", 42LL);
+    point.setTime(99ULL);
+    TEST_ASSERT_EQUAL_STRING(point.toLineProtocol().c_str(), buff);
+}
+
+static void test_truncated(void)
+{
+    PointSchema<2, 3> schema("environment", TagKeys, Fields);
+    const char *tags[] = {"a4:c1:38", "kitchen"};
+    char full[128];
+    size_t length = schema.toLineProtocol(full, sizeof(full), tags, {2150, 2947, -70}, 1711390037ULL);
+    char buff[32];
+    // length of the whole line, buffer holds its beginning
+    TEST_ASSERT_EQUAL(length, schema.toLineProtocol(buff, sizeof(buff), tags, {2150, 2947, -70}, 1711390037ULL));
+    TEST_ASSERT_EQUAL(sizeof(buff) - 1, strlen(buff));
+    TEST_ASSERT_EQUAL_STRING_LEN(full, buff, sizeof(buff) - 1);
+}
+
+static void test_allocation_failure(void)
+{
+    failAllocation = true;
+    PointSchema<2, 3> schema("environment", TagKeys, Fields);
+    failAllocation = false;
+    TEST_ASSERT_FALSE(schema.isValid());
+    const char *tags[] = {"a4:c1:38", "kitchen"};
+    char buff[128];
+    TEST_ASSERT_EQUAL(0, schema.toLineProtocol(buff, sizeof(buff), tags, {2150, 2947, -70}, 1711390037ULL));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_line);
+    RUN_TEST(test_empty_tags_are_omitted);
+    RUN_TEST(test_same_as_point);
+    RUN_TEST(test_truncated);
+    RUN_TEST(test_allocation_failure);
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Point timestamps: string parsing, precision rescaling when written and writing a point twice
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "InfluxDbClient.h"
+
+static MockHTTPTransport *transport;
+static InfluxDBClient *client;
+
+void setUp(void)
+{
+    transport = new MockHTTPTransport();
+    client = new InfluxDBClient("http://localhost:8086", "org", "bucket", "token");
+    client->setHTTPTransport(transport);
+}
+
+void tearDown(void)
+{
+    delete client;
+    delete transport;
+}
+
+static String written()
+{
+    return transport->requests.back().body;
+}
+
+static void test_string_timestamp(void)
+{
+    Point point("m");
+    point.addField("v", 1);
+    point.setTime("1711390037");
+    TEST_ASSERT_TRUE(point.hasTime());
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037", point.toLineProtocol().c_str());
+    point.setTime("18446744073709551615");
+    TEST_ASSERT_EQUAL_STRING("18446744073709551615", point.getTime().c_str());
+    // invalid strings keep the current timestamp
+    const char *invalid[] = {"now", "-1", "12a", " 12", "+12", "18446744073709551616"};
+    for (const char *timestamp : invalid)
+    {
+        point.setTime("1711390037");
+        point.setTime(timestamp);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE("1711390037", point.getTime().c_str(), timestamp);
+    }
+    point.setTime(String("42"));
+    TEST_ASSERT_EQUAL_STRING("42", point.getTime().c_str());
+    // empty string removes it
+    point.setTime("");
+    TEST_ASSERT_FALSE(point.hasTime());
+    TEST_ASSERT_EQUAL_STRING("m v=1i", point.toLineProtocol().c_str());
+}
+
+static void test_rescaled_to_write_precision(void)
+{
+    client->setWriteOptions(WriteOptions().writePrecision(WritePrecision::S));
+    Point point("m");
+    point.addField("v", 1);
+    // lower precision is cut
+    point.setTime(1711390037123ULL, WritePrecision::MS);
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037\n", written().c_str());
+    TEST_ASSERT_EQUAL_STRING("1711390037", point.getTime().c_str());
+
+    client->setWriteOptions(WriteOptions().writePrecision(WritePrecision::US));
+    // higher precision gets zeroes
+    point.setTime(1711390037ULL, WritePrecision::S);
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037000000\n", written().c_str());
+}
+
+static void test_rescaled_to_nanoseconds_without_write_precision(void)
+{
+    Point point("m");
+    point.addField("v", 1);
+    point.setTime(1711390037ULL, WritePrecision::S);
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    // server default is nanoseconds
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037000000000\n", written().c_str());
+}
+
+static void test_unknown_precision_is_not_rescaled(void)
+{
+    client->setWriteOptions(WriteOptions().writePrecision(WritePrecision::MS));
+    Point point("m");
+    point.addField("v", 1);
+    point.setTime(1711390037ULL);
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037\n", written().c_str());
+}
+
+// Point keeps the precision it was rescaled to, a second write does not rescale again
+static void test_point_written_twice(void)
+{
+    client->setWriteOptions(WriteOptions().writePrecision(WritePrecision::MS));
+    Point point("m");
+    point.addField("v", 1);
+    point.setTime(1711390037ULL, WritePrecision::S);
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_EQUAL(2, transport->requests.size());
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037000\n", transport->requests[0].body.c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037000\n", transport->requests[1].body.c_str());
+
+    // and neither does a copy, which shares the data
+    Point copy = point;
+    client->setWriteOptions(WriteOptions().writePrecision(WritePrecision::S));
+    TEST_ASSERT_TRUE(client->writePoint(copy));
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037\n", transport->requests[2].body.c_str());
+    TEST_ASSERT_EQUAL_STRING("m v=1i 1711390037\n", transport->requests[3].body.c_str());
+}
+
+static void test_current_time_in_write_precision(void)
+{
+    client->setWriteOptions(WriteOptions().writePrecision(WritePrecision::S));
+    Point point("m");
+    point.addField("v", 1);
+    TEST_ASSERT_TRUE(client->writePoint(point));
+    TEST_ASSERT_TRUE(point.hasTime());
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    unsigned long long written = strtoull(point.getTime().c_str(), nullptr, 10);
+    TEST_ASSERT_TRUE(written <= (unsigned long long)tv.tv_sec && written + 2 >= (unsigned long long)tv.tv_sec);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_string_timestamp);
+    RUN_TEST(test_rescaled_to_write_precision);
+    RUN_TEST(test_rescaled_to_nanoseconds_without_write_precision);
+    RUN_TEST(test_unknown_precision_is_not_rescaled);
+    RUN_TEST(test_point_written_twice);
+    RUN_TEST(test_current_time_in_write_precision);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PosixHTTPTransport: client writes and queries over real sockets against a loopback server
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "LoopbackHTTPServer.h"
+#include "PosixHTTPTransport.h"
+#include "InfluxDbClient.h"
+
+static LoopbackHTTPServer *server;
+static PosixHTTPTransport *transport;
+static InfluxDBClient *client;
+
+void setUp(void)
+{
+    server = new LoopbackHTTPServer();
+    TEST_ASSERT_TRUE(server->start());
+    transport = new PosixHTTPTransport();
+    client = new InfluxDBClient(server->url(), "org", "bucket", "token");
+    client->setHTTPTransport(transport);
+}
+
+void tearDown(void)
+{
+    delete client;
+    delete transport;
+    delete server;
+}
+
+static void test_write(void)
+{
+    TEST_ASSERT_TRUE(client->writeRecord("m,t=a v=1i"));
+    TEST_ASSERT_EQUAL(204, client->getLastStatusCode());
+    LoopbackHTTPServer::Request request = server->lastRequest();
+    TEST_ASSERT_EQUAL_STRING("POST", request.method.c_str());
+    TEST_ASSERT_TRUE(request.path.find("/api/v2/write?org=org&bucket=bucket") == 0);
+    TEST_ASSERT_TRUE(request.headers.find("Authorization: Token token\r\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_STRING("m,t=a v=1i\n", request.body.c_str());
+}
+
+static void test_batch_write(void)
+{
+    client->setWriteOptions(WriteOptions().batchSize(100).bufferSize(200));
+    std::string expected;
+    for (int i = 0; i < 100; i++)
+    {
+        String line = "m v=" + String(i) + "i";
+        expected += std::string(line.c_str()) + "\n";
+        TEST_ASSERT_TRUE(client->writeRecord(line));
+    }
+    TEST_ASSERT_EQUAL(1, server->requests.load());
+    TEST_ASSERT_TRUE(expected == server->lastRequest().body);
+}
+
+static void test_connection_reused(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true));
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    TEST_ASSERT_EQUAL(3, server->requests.load());
+    TEST_ASSERT_EQUAL(1, server->connections.load());
+    ConnectionStats stats = client->getConnectionStats();
+    TEST_ASSERT_EQUAL(1, stats.connects);
+    TEST_ASSERT_EQUAL(2, stats.reuses);
+}
+
+static void test_server_closes_connection(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true));
+    server->keepAlive = false;
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    TEST_ASSERT_EQUAL(3, server->requests.load());
+    TEST_ASSERT_EQUAL(3, server->connections.load());
+}
+
+// Server resets the connection while the body is being sent: the write fails instead of raising SIGPIPE
+static void test_connection_reset_while_sending(void)
+{
+    client->setHTTPOptions(HTTPOptions().connectionReuse(true));
+    TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+    server->dropRequests = true;
+    String large = "m s=\"" + String(std::string(1024 * 1024, 'x')) + "\"";
+    TEST_ASSERT_FALSE(client->writeRecord(large));
+    TEST_ASSERT_TRUE(client->getLastStatusCode() <= 0);
+    // next write connects again
+    server->dropRequests = false;
+    TEST_ASSERT_TRUE(client->writeRecord("m v=2i"));
+    TEST_ASSERT_EQUAL_STRING("m v=2i\n", server->lastRequest().body.c_str());
+}
+
+static void test_error_body(void)
+{
+    server->respond(400, "{\"code\":\"invalid\",\"message\":\"unable to parse 'm v=': missing field value\"}", "application/json");
+    TEST_ASSERT_FALSE(client->writeRecord("m v="));
+    TEST_ASSERT_EQUAL(400, client->getLastStatusCode());
+    TEST_ASSERT_TRUE(client->getLastErrorMessage().indexOf("unable to parse 'm v=': missing field value") >= 0);
+    // connection stays usable
+    server->respond(204);
+    TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+}
+
+static void test_query(void)
+{
+    server->respond(200,
+                    "#datatype,string,long,dateTime:RFC3339,double,string\r\n"
+                    "#group,false,false,false,false,true\r\n"
+                    "#default,_result,,,,\r\n"
+                    ",result,table,_time,_value,_field\r\n"
+                    ",,0,2024-03-25T18:07:17Z,21.5,temperature\r\n"
+                    ",,0,2024-03-25T18:08:17Z,21.25,temperature\r\n"
+                    "\r\n",
+                    "text/csv");
+    FluxQueryResult result = client->query("from(bucket: \"bucket\") |> range(start: -1h)");
+    TEST_ASSERT_TRUE(result.next());
+    TEST_ASSERT_EQUAL_STRING("temperature", result.getValueByName("_field").getString().c_str());
+    TEST_ASSERT_TRUE(result.getValueByName("_value").getDouble() == 21.5);
+    TEST_ASSERT_TRUE(result.next());
+    TEST_ASSERT_TRUE(result.getValueByName("_value").getDouble() == 21.25);
+    TEST_ASSERT_FALSE(result.next());
+    TEST_ASSERT_EQUAL_STRING("", result.getError().c_str());
+    result.close();
+    LoopbackHTTPServer::Request request = server->lastRequest();
+    TEST_ASSERT_TRUE(request.path.find("/api/v2/query?org=org") == 0);
+    TEST_ASSERT_TRUE(request.body.find("range(start: -1h)") != std::string::npos);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_write);
+    RUN_TEST(test_batch_write);
+    RUN_TEST(test_connection_reused);
+    RUN_TEST(test_server_closes_connection);
+    RUN_TEST(test_connection_reset_while_sending);
+    RUN_TEST(test_error_body);
+    RUN_TEST(test_query);
+    return UNITY_END();
+}
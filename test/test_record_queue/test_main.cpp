@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// RecordQueue: variable length records, wrap around, capacity and concurrent use
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "util/RecordQueue.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static bool pushString(RecordQueue &queue, const std::string &s)
+{
+    return queue.push(s.data(), s.size());
+}
+
+static std::string frontString(RecordQueue &queue)
+{
+    size_t length;
+    const uint8_t *data = queue.front(length);
+    TEST_ASSERT_NOT_NULL(data);
+    return std::string(reinterpret_cast<const char *>(data), length);
+}
+
+static void test_fifo_order(void)
+{
+    RecordQueue queue(256);
+    size_t length;
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_NULL(queue.front(length));
+    TEST_ASSERT_TRUE(pushString(queue, "m v=1i"));
+    TEST_ASSERT_TRUE(pushString(queue, ""));
+    TEST_ASSERT_TRUE(pushString(queue, "m,t=a v=22i"));
+    // length prefix, rounded up to even
+    TEST_ASSERT_EQUAL(8 + 2 + 14, queue.used());
+    TEST_ASSERT_TRUE(frontString(queue) == "m v=1i");
+    // front stays until popped
+    TEST_ASSERT_TRUE(frontString(queue) == "m v=1i");
+    queue.pop();
+    TEST_ASSERT_TRUE(frontString(queue) == "");
+    queue.pop();
+    TEST_ASSERT_TRUE(frontString(queue) == "m,t=a v=22i");
+    queue.pop();
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    TEST_ASSERT_EQUAL(0, queue.used());
+    // popping empty queue does nothing
+    queue.pop();
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+static void test_capacity(void)
+{
+    RecordQueue queue(300);
+    TEST_ASSERT_EQUAL(256, queue.capacity());
+    TEST_ASSERT_EQUAL(126, queue.maxLength());
+    std::string max(queue.maxLength(), 'x');
+    TEST_ASSERT_FALSE(pushString(queue, max + "x"));
+    TEST_ASSERT_TRUE(pushString(queue, max));
+    TEST_ASSERT_TRUE(pushString(queue, max));
+    TEST_ASSERT_EQUAL(256, queue.used());
+    // full
+    TEST_ASSERT_FALSE(pushString(queue, ""));
+    queue.pop();
+    TEST_ASSERT_TRUE(pushString(queue, "m v=1i"));
+}
+
+static void test_wrap_around_keeps_records_whole(void)
+{
+    RecordQueue queue(64);
+    // records of different sizes never line up with the ring end
+    int next = 0, expected = 0;
+    for (int round = 0; round < 1000; round++)
+    {
+        std::string record(next % 29, 'a' + next % 26);
+        if (pushString(queue, record))
+            next++;
+        if (round % 3 == 0 && !queue.isEmpty())
+        {
+            std::string front = frontString(queue);
+            TEST_ASSERT_EQUAL(expected % 29, front.size());
+            TEST_ASSERT_TRUE(front == std::string(expected % 29, 'a' + expected % 26));
+            queue.pop();
+            expected++;
+        }
+    }
+    TEST_ASSERT_TRUE(next > 300);
+    while (!queue.isEmpty())
+    {
+        TEST_ASSERT_TRUE(frontString(queue) == std::string(expected % 29, 'a' + expected % 26));
+        queue.pop();
+        expected++;
+    }
+    TEST_ASSERT_EQUAL(next, expected);
+}
+
+static void test_concurrent_producer_and_consumer(void)
+{
+    RecordQueue queue(1024);
+    const uint32_t count = 200000;
+    std::thread producer([&queue, count]() {
+        char record[64] = {};
+        for (uint32_t i = 0; i < count;)
+        {
+            int length = snprintf(record, sizeof(record), "m,t=%u v=%ui", i % 7, i);
+            if (queue.push(record, length + i % 20))
+                i++;
+            else
+                std::this_thread::yield();
+        }
+    });
+    char expected[64];
+    uint32_t received = 0;
+    bool ordered = true;
+    while (received < count)
+    {
+        size_t length;
+        const uint8_t *data = queue.front(length);
+        if (!data)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        int n = snprintf(expected, sizeof(expected), "m,t=%u v=%ui", received % 7, received);
+        ordered = ordered && length == (size_t)n + received % 20 && memcmp(data, expected, n) == 0;
+        queue.pop();
+        received++;
+    }
+    producer.join();
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+
+// used() is read by other tasks, e.g. a web server reporting metrics, while both ends move
+static void test_used_from_other_task(void)
+{
+    RecordQueue queue(256);
+    std::atomic<bool> done(false);
+    std::thread producer([&queue, &done]() {
+        while (!done)
+            queue.push("m v=1i", 6);
+    });
+    std::thread consumer([&queue, &done]() {
+        while (!done)
+            queue.pop();
+    });
+    size_t max = 0;
+    for (int i = 0; i < 2000000; i++)
+    {
+        size_t used = queue.used();
+        if (used > max)
+            max = used;
+    }
+    done = true;
+    producer.join();
+    consumer.join();
+    TEST_ASSERT_TRUE(max <= queue.capacity());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_capacity);
+    RUN_TEST(test_wrap_around_keeps_records_whole);
+    RUN_TEST(test_concurrent_producer_and_consumer);
+    RUN_TEST(test_used_from_other_task);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorHistory: delta encoding, clamping and ring overwrite
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "SensorHistory.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static size_t readAll(const SensorHistoryBase &history, size_t index, SensorHistoryBase::Sample *samples, size_t max)
+{
+    SensorHistoryBase::Cursor cursor;
+    history.begin(index, cursor);
+    size_t n = 0;
+    while (n < max && history.next(index, cursor, samples[n]))
+        n++;
+    return n;
+}
+
+static void test_empty(void)
+{
+    SensorHistory<2, 4> history;
+    SensorHistoryBase::Sample samples[4];
+    TEST_ASSERT_EQUAL(0, readAll(history, 0, samples, 4));
+    TEST_ASSERT_EQUAL_UINT32(0, history.lastTime(0));
+}
+
+static void test_append_and_read(void)
+{
+    SensorHistory<2, 8> history;
+    history.append(1, 1000, 1980, 5800);
+    history.append(1, 1060, 1994, 5815);
+    history.append(1, 1120, 1966, 6000);
+    history.append(0, 1000, -25, 0);
+
+    SensorHistoryBase::Sample s[8];
+    TEST_ASSERT_EQUAL(3, readAll(history, 1, s, 8));
+    TEST_ASSERT_EQUAL(1, readAll(history, 0, s, 8));
+    TEST_ASSERT_EQUAL(-30, s[0].temperature);
+    readAll(history, 1, s, 8);
+    TEST_ASSERT_EQUAL_UINT32(1000, s[0].timestamp);
+    TEST_ASSERT_EQUAL(1980, s[0].temperature);
+    TEST_ASSERT_EQUAL(5800, s[0].humidity);
+    // values are kept in 0.1 resolution, rounded half away from zero
+    TEST_ASSERT_EQUAL_UINT32(1060, s[1].timestamp);
+    TEST_ASSERT_EQUAL(1990, s[1].temperature);
+    TEST_ASSERT_EQUAL(5820, s[1].humidity);
+    TEST_ASSERT_EQUAL(1970, s[2].temperature);
+    TEST_ASSERT_EQUAL(6000, s[2].humidity);
+    TEST_ASSERT_EQUAL_UINT32(1120, history.lastTime(1));
+}
+
+static void test_large_change_catches_up(void)
+{
+    SensorHistory<1, 8> history;
+    history.append(0, 0, 0, 0);
+    // +30°C does not fit into one int8 delta of 0.1°C
+    history.append(0, 60, 3000, 0);
+    history.append(0, 120, 3000, 0);
+    history.append(0, 180, 3000, 0);
+
+    SensorHistoryBase::Sample s[8];
+    TEST_ASSERT_EQUAL(4, readAll(history, 0, s, 8));
+    TEST_ASSERT_EQUAL(1270, s[1].temperature);
+    TEST_ASSERT_EQUAL(2540, s[2].temperature);
+    TEST_ASSERT_EQUAL(3000, s[3].temperature);
+}
+
+static void test_long_gap_saturates(void)
+{
+    SensorHistory<1, 4> history;
+    history.append(0, 0, 100, 100);
+    history.append(0, 100000, 100, 100);
+    SensorHistoryBase::Sample s[4];
+    TEST_ASSERT_EQUAL(2, readAll(history, 0, s, 4));
+    TEST_ASSERT_EQUAL_UINT32(UINT16_MAX, s[1].timestamp);
+}
+
+static void test_ring_overwrite_keeps_values(void)
+{
+    SensorHistory<1, 4> history;
+    for (int i = 0; i < 10; i++)
+        history.append(0, 1000 + i * 60, 2000 + i * 10, 5000 - i * 10);
+
+    SensorHistoryBase::Sample s[4];
+    TEST_ASSERT_EQUAL(4, readAll(history, 0, s, 4));
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32(1000 + (6 + i) * 60, s[i].timestamp);
+        TEST_ASSERT_EQUAL(2000 + (6 + i) * 10, s[i].temperature);
+        TEST_ASSERT_EQUAL(5000 - (6 + i) * 10, s[i].humidity);
+    }
+}
+
+static void test_cursor_detects_overwrite(void)
+{
+    SensorHistory<1, 4> history;
+    for (int i = 0; i < 4; i++)
+        history.append(0, i * 60, 2000, 5000);
+
+    SensorHistoryBase::Cursor cursor;
+    SensorHistoryBase::Sample s;
+    history.begin(0, cursor);
+    TEST_ASSERT_TRUE(history.next(0, cursor, s));
+    // writer overwrites the samples the reader has not reached yet
+    for (int i = 4; i < 8; i++)
+        history.append(0, i * 60, 2000, 5000);
+    TEST_ASSERT_FALSE(history.next(0, cursor, s));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty);
+    RUN_TEST(test_append_and_read);
+    RUN_TEST(test_large_change_catches_up);
+    RUN_TEST(test_long_gap_saturates);
+    RUN_TEST(test_ring_overwrite_keeps_values);
+    RUN_TEST(test_cursor_detects_overwrite);
+    return UNITY_END();
+}
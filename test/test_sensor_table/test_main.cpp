@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SensorTable: MAC address parsing and hashed lookup
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "SensorTable.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_parse_mac(void)
+{
+    TEST_ASSERT_EQUAL_HEX64(0xa4c138173530ull, SensorTableBase::parseMac("a4:c1:38:17:35:30"));
+    TEST_ASSERT_EQUAL_HEX64(0xa4c138173530ull, SensorTableBase::parseMac("A4:C1:38:17:35:30"));
+    TEST_ASSERT_EQUAL_HEX64(0, SensorTableBase::parseMac(""));
+    TEST_ASSERT_EQUAL_HEX64(0, SensorTableBase::parseMac("a4:c1:38:17:35"));
+    TEST_ASSERT_EQUAL_HEX64(0, SensorTableBase::parseMac("a4:c1:38:17:35:30:"));
+    TEST_ASSERT_EQUAL_HEX64(0, SensorTableBase::parseMac("a4-c1-38-17-35-30"));
+    TEST_ASSERT_EQUAL_HEX64(0, SensorTableBase::parseMac("a4:c1:38:17:35:3g"));
+}
+
+static void test_format_mac(void)
+{
+    char buf[18];
+    TEST_ASSERT_EQUAL_STRING("a4:c1:38:17:35:30", SensorTableBase::formatMac(0xa4c138173530ull, buf));
+    TEST_ASSERT_EQUAL_STRING("00:00:00:00:00:01", SensorTableBase::formatMac(1, buf));
+}
+
+static void test_add_and_find(void)
+{
+    SensorTable<4> table({"a4:c1:38:17:35:30", "A4:C1:38:47:00:1C"});
+    TEST_ASSERT_EQUAL(2, table.size());
+    TEST_ASSERT_EQUAL(0, table.find(0xa4c138173530ull));
+    TEST_ASSERT_EQUAL(1, table.find(0xa4c13847001cull));
+    TEST_ASSERT_EQUAL(-1, table.find(0xa4c1385231ffull));
+    char buf[18];
+    TEST_ASSERT_EQUAL_STRING("a4:c1:38:47:00:1c", table.macString(1, buf));
+}
+
+static void test_add_rejects_invalid_duplicate_and_overflow(void)
+{
+    SensorTable<2> table({});
+    TEST_ASSERT_EQUAL(-1, table.add("not a mac"));
+    TEST_ASSERT_EQUAL(0, table.add("a4:c1:38:17:35:30"));
+    TEST_ASSERT_EQUAL(-1, table.add("A4:C1:38:17:35:30"));
+    TEST_ASSERT_EQUAL(1, table.add("a4:c1:38:17:35:31"));
+    TEST_ASSERT_EQUAL(-1, table.add("a4:c1:38:17:35:32"));
+    TEST_ASSERT_EQUAL(2, table.size());
+}
+
+static void test_full_table_lookup(void)
+{
+    // Addresses of the same vendor differ only in the low bytes, all must be found
+    static SensorTable<200> table({});
+    char mac[18];
+    for (int i = 0; i < 200; i++) {
+        snprintf(mac, sizeof(mac), "a4:c1:38:%02x:%02x:%02x", i * 7 & 0xff, i >> 3, i & 0xff);
+        TEST_ASSERT_EQUAL(i, table.add(mac));
+    }
+    for (int i = 0; i < 200; i++) {
+        snprintf(mac, sizeof(mac), "a4:c1:38:%02x:%02x:%02x", i * 7 & 0xff, i >> 3, i & 0xff);
+        TEST_ASSERT_EQUAL(i, table.find(SensorTableBase::parseMac(mac)));
+    }
+    TEST_ASSERT_EQUAL(-1, table.find(0x112233445566ull));
+}
+
+static void test_publish_snapshot(void)
+{
+    SensorTable<2> table({"a4:c1:38:17:35:30"});
+    uint32_t version = table.getVersion();
+    table.data(0).valid = true;
+    table.data(0).temperature = 1980;
+    table.data(0).humidity = 5800;
+
+    MiThData_t reading;
+    table.getSnapshot(0, reading);
+    TEST_ASSERT_FALSE(reading.valid);
+
+    table.publish(0);
+    table.getSnapshot(0, reading);
+    TEST_ASSERT_TRUE(reading.valid);
+    TEST_ASSERT_EQUAL(1980, reading.temperature);
+    TEST_ASSERT_EQUAL(5800, reading.humidity);
+    TEST_ASSERT_EQUAL(version + 1, table.getVersion());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_mac);
+    RUN_TEST(test_format_mac);
+    RUN_TEST(test_add_and_find);
+    RUN_TEST(test_add_rejects_invalid_duplicate_and_overflow);
+    RUN_TEST(test_full_table_lookup);
+    RUN_TEST(test_publish_snapshot);
+    return UNITY_END();
+}
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SeqLock: versions and untorn reads while the writer is running
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "SeqLock.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// Large enough not to be copied atomically
+struct Value
+{
+    uint32_t words[16];
+};
+
+static void test_read_after_write(void)
+{
+    SeqLock<Value> lock;
+    Value v;
+    lock.read(v);
+    TEST_ASSERT_EQUAL_UINT32(0, v.words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, lock.version());
+
+    for (uint32_t &w : v.words)
+        w = 7;
+    lock.write(v);
+    Value r;
+    TEST_ASSERT_TRUE(lock.tryRead(r));
+    TEST_ASSERT_EQUAL_MEMORY(&v, &r, sizeof(v));
+    TEST_ASSERT_EQUAL_UINT32(1, lock.version());
+    lock.write(v);
+    TEST_ASSERT_EQUAL_UINT32(2, lock.version());
+}
+
+static void test_no_torn_reads(void)
+{
+    static SeqLock<Value> lock;
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+        Value v;
+        for (uint32_t i = 1; i <= 200000; i++) {
+            for (uint32_t &w : v.words)
+                w = i;
+            lock.write(v);
+        }
+        done = true;
+    });
+    uint32_t torn = 0;
+    uint32_t reads = 0;
+    uint32_t last = 0;
+    uint32_t backwards = 0;
+    while (!done) {
+        Value v;
+        lock.read(v);
+        reads++;
+        for (uint32_t w : v.words) {
+            if (w != v.words[0]) {
+                torn++;
+                break;
+            }
+        }
+        if (v.words[0] < last)
+            backwards++;
+        last = v.words[0];
+    }
+    writer.join();
+    TEST_ASSERT_GREATER_THAN(0, reads);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, backwards);
+    TEST_ASSERT_EQUAL_UINT32(200000, lock.version());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_read_after_write);
+    RUN_TEST(test_no_torn_reads);
+    return UNITY_END();
+}
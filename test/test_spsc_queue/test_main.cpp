@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// SpscQueue: ordering, capacity and concurrent use
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include <thread>
+#include "SpscQueue.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_fifo_order(void)
+{
+    SpscQueue<int, 8> queue;
+    int item;
+    TEST_ASSERT_FALSE(queue.pop(item));
+    for (int i = 0; i < 5; i++)
+        TEST_ASSERT_TRUE(queue.push(i));
+    TEST_ASSERT_EQUAL(5, queue.size());
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(queue.pop(item));
+        TEST_ASSERT_EQUAL(i, item);
+    }
+    TEST_ASSERT_FALSE(queue.pop(item));
+    TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+static void test_full(void)
+{
+    SpscQueue<int, 4> queue;
+    for (int i = 0; i < 4; i++)
+        TEST_ASSERT_TRUE(queue.push(i));
+    TEST_ASSERT_FALSE(queue.push(4));
+    int item;
+    TEST_ASSERT_TRUE(queue.pop(item));
+    TEST_ASSERT_EQUAL(0, item);
+    TEST_ASSERT_TRUE(queue.push(4));
+    TEST_ASSERT_EQUAL(4, queue.size());
+}
+
+static void test_wrap_around(void)
+{
+    SpscQueue<uint32_t, 4> queue;
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(queue.push(i));
+        if (i % 3 != 0) {
+            uint32_t item;
+            TEST_ASSERT_TRUE(queue.pop(item));
+            TEST_ASSERT_EQUAL_UINT32(next++, item);
+        }
+        if (queue.size() == 4) {
+            uint32_t item;
+            while (queue.pop(item))
+                TEST_ASSERT_EQUAL_UINT32(next++, item);
+        }
+    }
+}
+
+struct Reading
+{
+    uint32_t seq;
+    uint32_t check;
+};
+
+static void test_concurrent_producer_consumer(void)
+{
+    static SpscQueue<Reading, 64> queue;
+    const uint32_t count = 200000;
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count;) {
+            if (queue.push({i, ~i}))
+                i++;
+            else
+                std::this_thread::yield();
+        }
+    });
+    uint32_t next = 0;
+    uint32_t errors = 0;
+    while (next < count) {
+        Reading r;
+        if (!queue.pop(r)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (r.seq != next || r.check != ~next)
+            errors++;
+        next++;
+    }
+    producer.join();
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL(0, queue.size());
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full);
+    RUN_TEST(test_wrap_around);
+    RUN_TEST(test_concurrent_producer_consumer);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// InfluxDBClient::Batch: line arena, write request body, batch reuse and streaming
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <unity.h>
+#include "MockHTTPTransport.h"
+#include "InfluxDbClient.h"
+
+static MockHTTPTransport *transport;
+static InfluxDBClient *client;
+
+void setUp(void)
+{
+    transport = new MockHTTPTransport();
+    client = new InfluxDBClient("http://localhost:8086", "org", "bucket", "token");
+    client->setHTTPTransport(transport);
+    client->setWriteOptions(WriteOptions().batchSize(2).bufferSize(4).flushInterval(0));
+}
+
+void tearDown(void)
+{
+    delete client;
+    delete transport;
+}
+
+static String repeat(char c, size_t count)
+{
+    return String(std::string(count, c));
+}
+
+// Batch is private to the client, Test is its friend
+class Test
+{
+public:
+    typedef InfluxDBClient::Batch Batch;
+
+    static void test_lines_are_contiguous(void)
+    {
+        Batch batch(3, 3);
+        TEST_ASSERT_TRUE(batch.isEmpty());
+        TEST_ASSERT_NULL(batch.getData());
+        TEST_ASSERT_TRUE(batch.append("m v=1i", 6));
+        TEST_ASSERT_TRUE(batch.append("m,t=a v=22i", 11));
+        TEST_ASSERT_EQUAL_STRING("m v=1i\nm,t=a v=22i\n", batch.getData());
+        TEST_ASSERT_EQUAL(19, batch.getLength());
+        TEST_ASSERT_EQUAL(2, batch.pointer);
+
+        size_t length;
+        const char *line = batch.getLine(1, length);
+        TEST_ASSERT_EQUAL(11, length);
+        TEST_ASSERT_EQUAL_STRING_LEN("m,t=a v=22i", line, length);
+        line = batch.getLine(0, length);
+        TEST_ASSERT_EQUAL(6, length);
+        TEST_ASSERT_EQUAL_STRING_LEN("m v=1i", line, length);
+    }
+
+    static void test_full_batch_is_overwritten(void)
+    {
+        Batch batch(2, 2);
+        batch.append("m v=1i", 6);
+        batch.append("m v=2i", 6);
+        TEST_ASSERT_TRUE(batch.isFull());
+        TEST_ASSERT_TRUE(batch.append("m v=3i", 6));
+        TEST_ASSERT_EQUAL(1, batch.pointer);
+        TEST_ASSERT_EQUAL_STRING("m v=3i\n", batch.getData());
+    }
+
+    static void test_arena_grows_for_long_lines(void)
+    {
+        Batch batch(4, 1);
+        uint32_t initial = batch._capacity;
+        String expected;
+        for (char c = 'a'; c < 'e'; c++)
+        {
+            String line = repeat(c, 300);
+            TEST_ASSERT_TRUE(batch.append(line.c_str(), line.length()));
+            expected += line + "\n";
+        }
+        TEST_ASSERT_TRUE(batch._capacity > initial);
+        TEST_ASSERT_EQUAL(expected.length(), batch.getLength());
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), batch.getData());
+        size_t length;
+        const char *line = batch.getLine(3, length);
+        TEST_ASSERT_EQUAL(300, length);
+        TEST_ASSERT_EQUAL('d', line[0]);
+    }
+
+    static void test_clear_keeps_arena(void)
+    {
+        Batch batch(2, 2);
+        batch.append("m v=1i", 6);
+        const char *data = batch._data;
+        uint32_t capacity = batch._capacity;
+        batch.clear();
+        TEST_ASSERT_TRUE(batch.isEmpty());
+        TEST_ASSERT_EQUAL(0, batch.getLength());
+        TEST_ASSERT_NULL(batch.getData());
+        batch.append("m v=2i", 6);
+        TEST_ASSERT_EQUAL_PTR(data, batch._data);
+        TEST_ASSERT_EQUAL(capacity, batch._capacity);
+    }
+
+    static void test_body_is_batch_data(void)
+    {
+        TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+        TEST_ASSERT_TRUE(client->writeRecord("m,t=a v=2i"));
+        TEST_ASSERT_TRUE(client->writeRecord("m v=3i"));
+        TEST_ASSERT_TRUE(client->flushBuffer());
+        TEST_ASSERT_EQUAL(2, transport->requests.size());
+        TEST_ASSERT_EQUAL_STRING("m v=1i\nm,t=a v=2i\n", transport->requests[0].body.c_str());
+        TEST_ASSERT_EQUAL_STRING("m v=3i\n", transport->requests[1].body.c_str());
+        WriteStats stats = client->getWriteStats();
+        TEST_ASSERT_EQUAL(2, stats.batchesPosted);
+        TEST_ASSERT_EQUAL(25, stats.bytesSent);
+        TEST_ASSERT_EQUAL(25, stats.bytesUncompressed);
+    }
+
+    static void test_written_batch_is_reused(void)
+    {
+        client->writeRecord("m v=1i");
+        client->writeRecord("m v=2i");
+        Batch *spare = client->_spareBatch;
+        TEST_ASSERT_NOT_NULL(spare);
+        client->writeRecord("m v=3i");
+        TEST_ASSERT_NULL(client->_spareBatch);
+        TEST_ASSERT_TRUE(client->flushBuffer());
+        TEST_ASSERT_EQUAL_PTR(spare, client->_spareBatch);
+        TEST_ASSERT_TRUE(spare->isEmpty());
+        TEST_ASSERT_EQUAL_STRING("m v=3i\n", transport->requests.back().body.c_str());
+    }
+
+    static void test_long_body(void)
+    {
+        client->setWriteOptions(WriteOptions().batchSize(1000).bufferSize(1000).flushInterval(0));
+        String expected;
+        char record[30];
+        for (int i = 0; i < 1000; i++)
+        {
+            snprintf(record, sizeof(record), "m,t=a v=%di", i);
+            TEST_ASSERT_TRUE(client->writeRecord(record));
+            expected += record;
+            expected += "\n";
+        }
+        TEST_ASSERT_EQUAL(1, transport->requests.size());
+        TEST_ASSERT_EQUAL(expected.length(), transport->requests[0].body.length());
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), transport->requests[0].body.c_str());
+    }
+
+    static void test_streamer_reads_in_bulk(void)
+    {
+        Batch batch(10, 10);
+        String expected;
+        for (char c = 'a'; c < 'k'; c++)
+        {
+            String line = repeat(c, 30);
+            batch.append(line.c_str(), line.length());
+            expected += line + "\n";
+        }
+        InfluxDBClient::BatchStreamer streamer(&batch);
+        TEST_ASSERT_EQUAL(310, streamer.available());
+        String read;
+        char buffer[64];
+        size_t n;
+        while ((n = streamer.readBytes(buffer, sizeof(buffer))) > 0)
+        {
+            // whole chunks, across line ends
+            TEST_ASSERT_TRUE(n == sizeof(buffer) || streamer.available() == 0);
+            read += std::string(buffer, n);
+        }
+        TEST_ASSERT_EQUAL_STRING(expected.c_str(), read.c_str());
+        TEST_ASSERT_EQUAL(0, streamer.available());
+        TEST_ASSERT_EQUAL(-1, streamer.read());
+
+        streamer.reset();
+        TEST_ASSERT_EQUAL(310, streamer.available());
+        TEST_ASSERT_EQUAL('a', streamer.peek());
+        TEST_ASSERT_EQUAL('a', streamer.read());
+        TEST_ASSERT_EQUAL(309, streamer.available());
+    }
+
+    static void test_stream_write_sends_same_body(void)
+    {
+        client->setStreamWrite(true);
+        TEST_ASSERT_TRUE(client->writeRecord("m v=1i"));
+        TEST_ASSERT_TRUE(client->writeRecord("m,t=a v=2i"));
+        TEST_ASSERT_EQUAL(1, transport->requests.size());
+        TEST_ASSERT_EQUAL_STRING("m v=1i\nm,t=a v=2i\n", transport->requests[0].body.c_str());
+        TEST_ASSERT_EQUAL(18, client->getWriteStats().bytesSent);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(Test::test_lines_are_contiguous);
+    RUN_TEST(Test::test_full_batch_is_overwritten);
+    RUN_TEST(Test::test_arena_grows_for_long_lines);
+    RUN_TEST(Test::test_clear_keeps_arena);
+    RUN_TEST(Test::test_body_is_batch_data);
+    RUN_TEST(Test::test_written_batch_is_reused);
+    RUN_TEST(Test::test_long_body);
+    RUN_TEST(Test::test_streamer_reads_in_bulk);
+    RUN_TEST(Test::test_stream_write_sends_same_body);
+    return UNITY_END();
+}